@@ -42,6 +42,8 @@ SharedObjects::SharedObjects(bool testMaxThreadCount) {
   settings.init(this);
   out.init(this);
   globalServiceMessages.init(this);
+  udpReactor.init(this);
+  dbWriteBehind.init(this);
 
   if (pthread_sigmask(SIG_BLOCK, nullptr, &defaultSignalMask) < 0) {
     out.printCritical("SIG_BLOCK error. Exiting Homegear.");
@@ -50,6 +52,13 @@ SharedObjects::SharedObjects(bool testMaxThreadCount) {
 }
 
 SharedObjects::~SharedObjects() {
+  //Write pending rows while the database controller is still available.
+  dbWriteBehind.stop();
+  udpReactor.stop();
+  serialDeviceManager.dispose();
+  //Writes all queued messages.
+  if (settings.asyncLogging()) Output::disableAsyncOutput();
+  Output::stopRateLimiterThread(threadManager);
 }
 
 std::string SharedObjects::version() {
@@ -34,6 +34,7 @@
 #include <cstdint>
 
 #include "Database/IDatabaseController.h"
+#include "Database/WriteBehindQueue.h"
 #include "Encoding/Ansi.h"
 #include "Encoding/XmlrpcDecoder.h"
 #include "Encoding/XmlrpcEncoder.h"
@@ -83,8 +84,11 @@
 #include "IQueue.h"
 #include "ITimedQueue.h"
 #include "Sockets/HttpClient.h"
+#include "Sockets/HttpClientPool.h"
 #include "Sockets/HttpServer.h"
 #include "Sockets/Modbus.h"
+#include "Sockets/ModbusReadPlanner.h"
+#include "Sockets/UdpReactor.h"
 #include "Sockets/UdpSocket.h"
 
 namespace BaseLib {
@@ -207,6 +211,17 @@ class SharedObjects {
    */
   std::shared_ptr<Hgdc> hgdc;
 
+  /**
+   * Event loop servicing all datagram sockets registered with it. Declared after the thread manager so it is destroyed first.
+   */
+  UdpReactor udpReactor;
+
+  /**
+   * Coalesces updates of peer parameters and peer variables before they are written to the database. Declared after all objects it uses so it is
+   * destroyed (and flushed) first. Pending rows are also written when a device family is disposed. Call "dbWriteBehind.stop()" before closing "db".
+   */
+  Database::WriteBehindQueue dbWriteBehind;
+
   /**
    * Default signal mask
    */
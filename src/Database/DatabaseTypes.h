@@ -36,6 +36,7 @@
 #include <deque>
 #include <map>
 #include <memory>
+#include <atomic>
 #include <cstdint>
 
 namespace BaseLib
@@ -43,6 +44,46 @@ namespace BaseLib
 namespace Database
 {
 
+/**
+ * Pointer to the binary value of a DataColumn. It behaves like "std::shared_ptr<std::vector<char>>", but only allocates the (empty) vector when it is
+ * accessed for the first time. So columns of other types don't need a heap allocation for it. The allocation is thread safe.
+ */
+class BinaryValuePointer
+{
+    public:
+        BinaryValuePointer() = default;
+        BinaryValuePointer(std::shared_ptr<std::vector<char>> value) : _value(std::move(value)) {}
+        BinaryValuePointer(const BinaryValuePointer& other) : _value(std::atomic_load(&other._value)) {}
+        BinaryValuePointer& operator=(const BinaryValuePointer& other) { std::atomic_store(&_value, std::atomic_load(&other._value)); return *this; }
+        BinaryValuePointer& operator=(std::shared_ptr<std::vector<char>> value) { std::atomic_store(&_value, std::move(value)); return *this; }
+
+        std::vector<char>* operator->() const { return get(); }
+        std::vector<char>& operator*() const { return *get(); }
+        std::vector<char>* get() const { return value().get(); }
+        operator std::shared_ptr<std::vector<char>>() const { return value(); }
+        explicit operator bool() const { return true; }
+
+        void reset() { std::atomic_store(&_value, std::shared_ptr<std::vector<char>>()); }
+        void reset(std::vector<char>* value) { std::atomic_store(&_value, std::shared_ptr<std::vector<char>>(value)); }
+
+        /**
+         * Returns "true" when the vector was allocated already.
+         */
+        bool allocated() const { return (bool)std::atomic_load(&_value); }
+    private:
+        mutable std::shared_ptr<std::vector<char>> _value;
+
+        std::shared_ptr<std::vector<char>> value() const
+        {
+            std::shared_ptr<std::vector<char>> value = std::atomic_load(&_value);
+            if(value) return value;
+            auto newValue = std::make_shared<std::vector<char>>();
+            //Another thread might have allocated the vector in the meantime. In that case "value" is set to its vector.
+            if(std::atomic_compare_exchange_strong(&_value, &value, newValue)) return newValue;
+            return value;
+        }
+};
+
 /**
  * Class to store data of a database column in.
  */
@@ -83,14 +124,14 @@ class DataColumn
         std::string textValue;
 
         /**
-         * The binary value.
+         * The binary value. The vector is allocated on first access.
          */
-        std::shared_ptr<std::vector<char>> binaryValue;
+        BinaryValuePointer binaryValue;
 
         /**
          * Default constructor.
          */
-        DataColumn() { binaryValue.reset(new std::vector<char>()); }
+        DataColumn() = default;
 
         /**
          * Constructor to create a data column of type INTEGER.
@@ -125,7 +166,7 @@ class DataColumn
          *
          * @param value The column data.
          */
-        DataColumn(std::string value) : DataColumn() { dataType = DataType::Enum::TEXT; textValue = value; }
+        DataColumn(std::string value) : DataColumn() { dataType = DataType::Enum::TEXT; textValue = std::move(value); }
 
         /**
          * Constructor to create a data column of type FLOAT.
@@ -139,18 +180,17 @@ class DataColumn
          *
          * @param value The column data. It is not copied! So make sure to not modify it as long as the DataColumn object exists.
          */
-        DataColumn(std::shared_ptr<std::vector<char>> value) : DataColumn() { dataType = DataType::Enum::BLOB; if(value) binaryValue = value; }
+        DataColumn(std::shared_ptr<std::vector<char>> value) { dataType = DataType::Enum::BLOB; binaryValue = std::move(value); }
 
         /**
          * Constructor to create a data column of type BLOB.
          *
          * @param value The column data. The data is copied.
          */
-        DataColumn(const std::vector<char>& value) : DataColumn()
+        DataColumn(const std::vector<char>& value)
         {
         	dataType = DataType::Enum::BLOB;
-        	binaryValue.reset(new std::vector<char>());
-        	binaryValue->insert(binaryValue->begin(), value.begin(), value.end());
+        	binaryValue = std::make_shared<std::vector<char>>(value.begin(), value.end());
         }
 
         /**
@@ -158,11 +198,10 @@ class DataColumn
          *
          * @param value The column data. The data is copied.
          */
-        DataColumn(const std::vector<uint8_t>& value) : DataColumn()
+        DataColumn(const std::vector<uint8_t>& value)
         {
         	dataType = DataType::Enum::BLOB;
-        	binaryValue.reset(new std::vector<char>());
-        	binaryValue->insert(binaryValue->begin(), value.begin(), value.end());
+        	binaryValue = std::make_shared<std::vector<char>>(value.begin(), value.end());
         }
 
         /**
@@ -37,6 +37,7 @@
 #include "../Variable.h"
 #include "../Sockets/RpcClientInfo.h"
 #include "../Systems/Peer.h"
+#include <functional>
 #include <set>
 
 namespace BaseLib {
@@ -269,8 +270,52 @@ class IDatabaseController {
   virtual void savePeerParameterCategoriesAsynchronous(BaseLib::Database::DataRow &data) = 0;
   virtual void savePeerParameterRolesAsynchronous(BaseLib::Database::DataRow &data) = 0;
   virtual void savePeerVariableAsynchronous(DataRow &data) = 0;
+
+  /**
+   * Saves multiple peer parameters at once. Each row has the same format as the rows passed to "savePeerParameterAsynchronous()". Controllers
+   * should override this method to write all rows in one statement or transaction. The default implementation calls
+   * "savePeerParameterAsynchronous()" for each row.
+   *
+   * @param rows The rows to save.
+   */
+  virtual void savePeerParametersAsynchronous(std::vector<DataRow> &rows) { for (auto &row : rows) savePeerParameterAsynchronous(row); }
+
+  /**
+   * Saves multiple peer variables at once. Each row has the same format as the rows passed to "savePeerVariableAsynchronous()". The default
+   * implementation calls "savePeerVariableAsynchronous()" for each row.
+   *
+   * @param rows The rows to save.
+   */
+  virtual void savePeerVariablesAsynchronous(std::vector<DataRow> &rows) { for (auto &row : rows) savePeerVariableAsynchronous(row); }
+
   virtual std::shared_ptr<DataTable> getPeerParameters(uint64_t peerID) = 0;
   virtual std::shared_ptr<DataTable> getPeerVariables(uint64_t peerID) = 0;
+
+  /**
+   * Callback for "getPeerDataBulk()". "peerRow" has the same format as the rows returned by "getPeers()", "variables" and "parameters" have the same
+   * format as the tables returned by "getPeerVariables()" and "getPeerParameters()".
+   */
+  typedef std::function<void(const std::map<uint32_t, std::shared_ptr<DataColumn>> &peerRow, std::shared_ptr<DataTable> &variables, std::shared_ptr<DataTable> &parameters)> PeerDataCallback;
+
+  /**
+   * Streams all peers of a central together with their variables and parameters ordered by peer ID. "callback" is called once per peer on the calling
+   * thread. Controllers should override this to read everything in one ordered pass instead of running two queries per peer. The default
+   * implementation calls "getPeers()", "getPeerVariables()" and "getPeerParameters()".
+   *
+   * @param deviceID The database ID of the central.
+   * @param callback The callback to call for each peer.
+   */
+  virtual void getPeerDataBulk(uint64_t deviceID, const PeerDataCallback &callback) {
+    auto peers = getPeers(deviceID);
+    if (!peers) return;
+    for (auto &peer : *peers) {
+      uint64_t peerID = (uint64_t)peer.second.at(0)->intValue;
+      auto variables = getPeerVariables(peerID);
+      auto parameters = getPeerParameters(peerID);
+      callback(peer.second, variables, parameters);
+    }
+  }
+
   virtual void deletePeerParameter(uint64_t peerID, DataRow &data) = 0;
 
   virtual bool peerExists(uint64_t peerId) = 0;
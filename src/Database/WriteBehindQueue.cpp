@@ -0,0 +1,164 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "WriteBehindQueue.h"
+#include "../BaseLib.h"
+
+namespace BaseLib {
+namespace Database {
+
+WriteBehindQueue::~WriteBehindQueue() {
+  stop();
+}
+
+void WriteBehindQueue::init(SharedObjects *baseLib) {
+  _bl = baseLib;
+}
+
+bool WriteBehindQueue::writeBehindEnabled() {
+  return !_stopped && _bl->settings.databaseWriteBehindWindow() > 0;
+}
+
+void WriteBehindQueue::stop() {
+  if (!_bl) return;
+  {
+    std::lock_guard<std::mutex> flushThreadGuard(_flushThreadMutex);
+    _stopped = true;
+  }
+  _flushConditionVariable.notify_all();
+  _bl->threadManager.join(_flushThread);
+  flush();
+}
+
+bool WriteBehindQueue::scheduleFlush() {
+  {
+    std::lock_guard<std::mutex> flushThreadGuard(_flushThreadMutex);
+    if (_stopped) return false;
+    if (!_flushThreadRunning) {
+      _flushThreadRunning = _bl->threadManager.start(_flushThread, false, &WriteBehindQueue::flushThread, this);
+      if (!_flushThreadRunning) return false;
+    }
+    if (_flushPending) return true;
+    _flushPending = true;
+  }
+  _flushConditionVariable.notify_one();
+  return true;
+}
+
+void WriteBehindQueue::flushThread() {
+  while (!_stopped) {
+    {
+      std::unique_lock<std::mutex> flushThreadGuard(_flushThreadMutex);
+      //Sleep until there is something to write.
+      _flushConditionVariable.wait(flushThreadGuard, [&] { return _flushPending || _stopped; });
+      if (_stopped) break; //stop() writes the remaining rows.
+      //Collect further updates until the end of the window.
+      _flushConditionVariable.wait_for(flushThreadGuard, std::chrono::milliseconds(_bl->settings.databaseWriteBehindWindow()), [&] { return (bool)_stopped; });
+      _flushPending = false;
+    }
+    flush();
+  }
+}
+
+void WriteBehindQueue::flush() {
+  try {
+    if (!_bl || !_bl->db) return;
+    std::lock_guard<std::mutex> flushGuard(_flushMutex);
+    std::unordered_map<uint64_t, DataRow> peerParameters;
+    std::unordered_map<uint64_t, DataRow> peerVariables;
+    {
+      std::lock_guard<std::mutex> queueGuard(_queueMutex);
+      peerParameters.swap(_peerParameters);
+      peerVariables.swap(_peerVariables);
+    }
+    if (peerParameters.empty() && peerVariables.empty()) return;
+
+    std::vector<DataRow> parameterRows;
+    parameterRows.reserve(peerParameters.size());
+    for (auto &row : peerParameters) {
+      parameterRows.emplace_back(std::move(row.second));
+    }
+    std::vector<DataRow> variableRows;
+    variableRows.reserve(peerVariables.size());
+    for (auto &row : peerVariables) {
+      variableRows.emplace_back(std::move(row.second));
+    }
+
+    if (_bl->debugLevel >= 5) _bl->out.printDebug("Debug: Writing " + std::to_string(parameterRows.size()) + " peer parameters and " + std::to_string(variableRows.size()) + " peer variables to database.");
+
+    std::string savepointName("writeBehind");
+    _bl->db->createSavepointAsynchronous(savepointName);
+    if (!parameterRows.empty()) _bl->db->savePeerParametersAsynchronous(parameterRows);
+    if (!variableRows.empty()) _bl->db->savePeerVariablesAsynchronous(variableRows);
+    _bl->db->releaseSavepointAsynchronous(savepointName);
+  }
+  catch (const std::exception &ex) {
+    _bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void WriteBehindQueue::savePeerParameterAsynchronous(uint64_t parameterId, DataRow &data) {
+  try {
+    if (!_bl->db) return;
+    if (!writeBehindEnabled()) {
+      _bl->db->savePeerParameterAsynchronous(data);
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> queueGuard(_queueMutex);
+      _peerParameters[parameterId] = std::move(data);
+    }
+    if (!scheduleFlush()) flush();
+  }
+  catch (const std::exception &ex) {
+    _bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void WriteBehindQueue::savePeerVariableAsynchronous(uint64_t variableId, DataRow &data) {
+  try {
+    if (!_bl->db) return;
+    if (!writeBehindEnabled()) {
+      _bl->db->savePeerVariableAsynchronous(data);
+      return;
+    }
+    {
+      std::lock_guard<std::mutex> queueGuard(_queueMutex);
+      _peerVariables[variableId] = std::move(data);
+    }
+    if (!scheduleFlush()) flush();
+  }
+  catch (const std::exception &ex) {
+    _bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+}
+}
@@ -0,0 +1,116 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef LIBHOMEGEAR_BASE_WRITEBEHINDQUEUE_H_
+#define LIBHOMEGEAR_BASE_WRITEBEHINDQUEUE_H_
+
+#include "DatabaseTypes.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace BaseLib {
+
+class SharedObjects;
+
+namespace Database {
+
+/**
+ * Coalesces updates of existing peer parameter and peer variable rows. Within the window set by "databaseWriteBehindWindow" in main.conf only the
+ * last value written to a row is kept. At the end of the window all pending rows are written in one transaction using
+ * IDatabaseController::savePeerParametersAsynchronous() and IDatabaseController::savePeerVariablesAsynchronous(). When the window is "0", rows are
+ * passed to the database controller directly.
+ */
+class WriteBehindQueue {
+ public:
+  WriteBehindQueue() = default;
+  WriteBehindQueue(const WriteBehindQueue &) = delete;
+  WriteBehindQueue &operator=(const WriteBehindQueue &) = delete;
+  virtual ~WriteBehindQueue();
+
+  void init(SharedObjects *baseLib);
+
+  /**
+   * Stops the flush thread and writes all pending rows. Call this before the database is closed. Rows passed after calling this method are
+   * written directly.
+   */
+  void stop();
+
+  /**
+   * Writes all pending rows to the database.
+   */
+  void flush();
+
+  /**
+   * Queues an update of an existing peer parameter row. The row has the same format as the one passed to
+   * IDatabaseController::savePeerParameterAsynchronous().
+   *
+   * @param parameterId The database ID of the parameter.
+   * @param data The row. The content is moved out of the row.
+   */
+  void savePeerParameterAsynchronous(uint64_t parameterId, DataRow &data);
+
+  /**
+   * Queues an update of an existing peer variable row. The row has the same format as the one passed to
+   * IDatabaseController::savePeerVariableAsynchronous().
+   *
+   * @param variableId The database ID of the variable.
+   * @param data The row. The content is moved out of the row.
+   */
+  void savePeerVariableAsynchronous(uint64_t variableId, DataRow &data);
+ private:
+  SharedObjects *_bl = nullptr;
+  std::mutex _queueMutex;
+  std::unordered_map<uint64_t, DataRow> _peerParameters;
+  std::unordered_map<uint64_t, DataRow> _peerVariables;
+  std::mutex _flushMutex;
+  std::atomic_bool _stopped{false};
+  std::mutex _flushThreadMutex;
+  std::condition_variable _flushConditionVariable;
+  std::thread _flushThread;
+  bool _flushThreadRunning = false;
+  bool _flushPending = false;
+
+  bool writeBehindEnabled();
+
+  /**
+   * Starts the flush thread if necessary and wakes it up. Returns false when the thread couldn't be started.
+   */
+  bool scheduleFlush();
+  void flushThread();
+};
+
+}
+}
+
+#endif
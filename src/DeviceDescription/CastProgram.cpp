@@ -0,0 +1,288 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "CastProgram.h"
+#include "../BaseLib.h"
+
+#include <algorithm>
+
+namespace BaseLib {
+namespace DeviceDescription {
+namespace ParameterCast {
+
+PCastProgram CastProgram::compile(const Casts &casts, const std::shared_ptr<ILogical> &logical, bool toPacket) {
+  auto program = std::make_shared<CastProgram>();
+  if (toPacket) {
+    for (auto &cast : casts) {
+      if (!program->addCast(cast, logical, true)) return PCastProgram();
+    }
+  } else {
+    for (auto i = casts.rbegin(); i != casts.rend(); ++i) {
+      if (!program->addCast(*i, logical, false)) return PCastProgram();
+    }
+  }
+  program->_instructions.shrink_to_fit();
+  program->_mapEntries.shrink_to_fit();
+  return program;
+}
+
+void CastProgram::addIntegerAffine(int64_t sign, int64_t constant) {
+  //Offsets are exact integer operations, so consecutive ones can be merged without changing the result.
+  if (!_instructions.empty() && _instructions.back().opCode == OpCode::integerAffine) {
+    auto &previous = _instructions.back();
+    previous.integer1 = sign * previous.integer1;
+    previous.integer2 = (int32_t)(sign * previous.integer2 + constant);
+    return;
+  }
+  Instruction instruction;
+  instruction.opCode = OpCode::integerAffine;
+  instruction.integer1 = sign;
+  instruction.integer2 = constant;
+  _instructions.push_back(instruction);
+}
+
+void CastProgram::addMap(const std::map<int32_t, int32_t> &map) {
+  Instruction instruction;
+  instruction.opCode = OpCode::integerMap;
+  instruction.mapStart = _mapEntries.size();
+  instruction.mapSize = map.size();
+  //std::map is ordered by key, so the entries are already sorted.
+  _mapEntries.insert(_mapEntries.end(), map.begin(), map.end());
+  _instructions.push_back(instruction);
+}
+
+bool CastProgram::addCast(const PICast &cast, const std::shared_ptr<ILogical> &logical, bool toPacket) {
+  if (!cast) return false;
+  ICast *castPointer = cast.get();
+  Instruction instruction;
+
+  if (auto *decimalIntegerScale = dynamic_cast<DecimalIntegerScale *>(castPointer)) {
+    instruction.opCode = toPacket ? OpCode::decimalToInteger : OpCode::integerToDecimal;
+    instruction.decimal1 = decimalIntegerScale->factor;
+    instruction.decimal2 = decimalIntegerScale->offset;
+  } else if (auto *decimalIntegerInverseScale = dynamic_cast<DecimalIntegerInverseScale *>(castPointer)) {
+    instruction.opCode = toPacket ? OpCode::decimalToIntegerInverse : OpCode::integerToDecimalInverse;
+    instruction.decimal1 = decimalIntegerInverseScale->factor;
+  } else if (auto *integerIntegerScale = dynamic_cast<IntegerIntegerScale *>(castPointer)) {
+    //Operation "none" prints a warning on every conversion. Leave that to the cast object.
+    if (integerIntegerScale->operation == IntegerIntegerScale::Operation::none) return false;
+    bool multiply = (integerIntegerScale->operation == IntegerIntegerScale::Operation::division) != toPacket;
+    instruction.opCode = multiply ? OpCode::integerMultiply : OpCode::integerDivide;
+    instruction.decimal1 = integerIntegerScale->factor;
+    if (toPacket) instruction.integer1 = integerIntegerScale->offset;
+    else instruction.integer2 = integerIntegerScale->offset;
+  } else if (auto *integerOffset = dynamic_cast<IntegerOffset *>(castPointer)) {
+    if (!integerOffset->addOffset) addIntegerAffine(-1, integerOffset->offset);
+    else if (integerOffset->directionToPacket == toPacket) addIntegerAffine(1, integerOffset->offset);
+    else addIntegerAffine(1, -(int64_t)integerOffset->offset);
+    return true;
+  } else if (auto *decimalOffset = dynamic_cast<DecimalOffset *>(castPointer)) {
+    instruction.opCode = OpCode::decimalAffine;
+    if (!decimalOffset->addOffset) {
+      instruction.integer1 = -1;
+      instruction.decimal1 = decimalOffset->offset;
+    } else {
+      instruction.integer1 = 1;
+      instruction.decimal1 = decimalOffset->offset;
+      instruction.invert = decimalOffset->directionToPacket != toPacket; //Subtract instead of add
+    }
+  } else if (auto *integerIntegerMap = dynamic_cast<IntegerIntegerMap *>(castPointer)) {
+    auto direction = integerIntegerMap->direction;
+    bool mapValues = toPacket ? (direction == IntegerIntegerMap::Direction::toDevice || direction == IntegerIntegerMap::Direction::both)
+                              : (direction == IntegerIntegerMap::Direction::fromDevice || direction == IntegerIntegerMap::Direction::both);
+    if (mapValues) addMap(toPacket ? integerIntegerMap->integerValueMapToDevice : integerIntegerMap->integerValueMapFromDevice);
+    else {
+      //The cast only sets the type.
+      Instruction typeInstruction;
+      typeInstruction.opCode = OpCode::integerMap;
+      _instructions.push_back(typeInstruction);
+    }
+    return true;
+  } else if (auto *optionInteger = dynamic_cast<OptionInteger *>(castPointer)) {
+    addMap(toPacket ? optionInteger->valueMapToDevice : optionInteger->valueMapFromDevice);
+    return true;
+  } else if (auto *booleanInteger = dynamic_cast<BooleanInteger *>(castPointer)) {
+    instruction.opCode = toPacket ? OpCode::booleanToInteger : OpCode::integerToBoolean;
+    instruction.invert = booleanInteger->invert;
+    instruction.integer1 = booleanInteger->trueValue;
+    instruction.integer2 = booleanInteger->falseValue;
+    instruction.integer3 = booleanInteger->threshold;
+  } else if (auto *booleanDecimal = dynamic_cast<BooleanDecimal *>(castPointer)) {
+    instruction.opCode = toPacket ? OpCode::booleanToDecimal : OpCode::decimalToBoolean;
+    instruction.invert = booleanDecimal->invert;
+    instruction.decimal1 = booleanDecimal->trueValue;
+    instruction.decimal2 = booleanDecimal->falseValue;
+    instruction.decimal3 = booleanDecimal->threshold;
+  } else if (dynamic_cast<Invert *>(castPointer)) {
+    if (!logical) return false;
+    if (logical->type == ILogical::Type::Enum::tBoolean) instruction.opCode = OpCode::invertBoolean;
+    else if (logical->type == ILogical::Type::Enum::tInteger) {
+      auto *logicalInteger = (LogicalInteger *)logical.get();
+      instruction.opCode = OpCode::invertInteger;
+      instruction.integer1 = logicalInteger->minimumValue;
+      instruction.integer2 = logicalInteger->maximumValue;
+    } else if (logical->type == ILogical::Type::Enum::tInteger64) {
+      auto *logicalInteger64 = (LogicalInteger64 *)logical.get();
+      instruction.opCode = OpCode::invertInteger64;
+      instruction.integer1 = logicalInteger64->minimumValue;
+      instruction.integer2 = logicalInteger64->maximumValue;
+    } else if (logical->type == ILogical::Type::Enum::tFloat) {
+      auto *logicalDecimal = (LogicalDecimal *)logical.get();
+      instruction.opCode = OpCode::invertDecimal;
+      instruction.decimal1 = logicalDecimal->minimumValue;
+      instruction.decimal2 = logicalDecimal->maximumValue;
+    } else return true; //Invert doesn't do anything for other types.
+  } else if (auto *round = dynamic_cast<Round *>(castPointer)) {
+    instruction.opCode = OpCode::round;
+    instruction.decimal1 = round->roundToPoint5 ? 2.0 : Math::Pow10(round->decimalPlaces);
+  } else if (dynamic_cast<Toggle *>(castPointer) || dynamic_cast<Generic *>(castPointer)) {
+    //No conversion in both directions.
+    return true;
+  } else return false;
+
+  _instructions.push_back(instruction);
+  return true;
+}
+
+int32_t CastProgram::mapValue(const Instruction &instruction, int32_t value) const {
+  auto begin = _mapEntries.begin() + instruction.mapStart;
+  auto end = begin + instruction.mapSize;
+  auto element = std::lower_bound(begin, end, value, [](const std::pair<int32_t, int32_t> &entry, int32_t key) { return entry.first < key; });
+  if (element != end && element->first == value) return element->second;
+  return value;
+}
+
+void CastProgram::run(Variable &value) const {
+  for (auto &instruction : _instructions) {
+    switch (instruction.opCode) {
+      case OpCode::none:
+        break;
+      case OpCode::integerToDecimal:
+        if (value.type == VariableType::tFloat) value.floatValue = (value.floatValue / instruction.decimal1) - instruction.decimal2;
+        else if (value.type == VariableType::tInteger) value.floatValue = ((double)value.integerValue / instruction.decimal1) - instruction.decimal2;
+        else value.floatValue = ((double)value.integerValue64 / instruction.decimal1) - instruction.decimal2;
+        value.type = VariableType::tFloat;
+        value.integerValue = 0;
+        value.integerValue64 = 0;
+        break;
+      case OpCode::decimalToInteger:
+        value.integerValue64 = std::llround((value.floatValue + instruction.decimal2) * instruction.decimal1);
+        value.integerValue = (int32_t)value.integerValue64;
+        value.type = ((int64_t)value.integerValue != value.integerValue64) ? VariableType::tInteger64 : VariableType::tInteger;
+        value.floatValue = 0;
+        break;
+      case OpCode::integerToDecimalInverse:
+        value.type = VariableType::tFloat;
+        value.floatValue = instruction.decimal1 / value.integerValue;
+        value.integerValue = 0;
+        break;
+      case OpCode::decimalToIntegerInverse:
+        value.integerValue = std::lround(instruction.decimal1 / value.floatValue);
+        value.type = VariableType::tInteger;
+        value.floatValue = 0;
+        break;
+      case OpCode::integerMultiply:
+        value.type = VariableType::tInteger;
+        value.integerValue = std::lround((double)(value.integerValue + instruction.integer1) * instruction.decimal1) - instruction.integer2;
+        break;
+      case OpCode::integerDivide:
+        value.type = VariableType::tInteger;
+        value.integerValue = std::lround((double)(value.integerValue + instruction.integer1) / instruction.decimal1) - instruction.integer2;
+        break;
+      case OpCode::integerAffine:
+        value.type = VariableType::tInteger;
+        value.integerValue = (int32_t)(instruction.integer1 * value.integerValue + instruction.integer2);
+        break;
+      case OpCode::decimalAffine:
+        value.type = VariableType::tFloat;
+        if (instruction.integer1 == -1) value.floatValue = instruction.decimal1 - value.floatValue;
+        else if (instruction.invert) value.floatValue = value.floatValue - instruction.decimal1;
+        else value.floatValue = value.floatValue + instruction.decimal1;
+        break;
+      case OpCode::integerMap:
+        value.type = VariableType::tInteger;
+        if (instruction.mapSize > 0) value.integerValue = mapValue(instruction, value.integerValue);
+        break;
+      case OpCode::integerToBoolean:
+        value.type = VariableType::tBoolean;
+        if (instruction.integer1 == 0 && instruction.integer2 == 0) value.booleanValue = (value.integerValue >= instruction.integer3);
+        else {
+          if (value.integerValue == instruction.integer1 || value.integerValue >= instruction.integer3) value.booleanValue = true;
+          if (value.integerValue == instruction.integer2) value.booleanValue = false;
+        }
+        if (instruction.invert) value.booleanValue = !value.booleanValue;
+        value.integerValue = 0;
+        break;
+      case OpCode::booleanToInteger:
+        value.type = VariableType::tInteger;
+        if (instruction.invert) value.booleanValue = !value.booleanValue;
+        if (instruction.integer1 == 0 && instruction.integer2 == 0) value.integerValue = (int32_t)value.booleanValue;
+        else value.integerValue = (int32_t)(value.booleanValue ? instruction.integer1 : instruction.integer2);
+        value.booleanValue = false;
+        break;
+      case OpCode::decimalToBoolean:
+        value.type = VariableType::tBoolean;
+        if (instruction.decimal1 == 0 && instruction.decimal2 == 0) value.booleanValue = (value.floatValue >= instruction.decimal3);
+        else {
+          if (value.floatValue == instruction.decimal2) value.booleanValue = false;
+          if (value.floatValue == instruction.decimal1 || value.floatValue >= instruction.decimal3) value.booleanValue = true;
+        }
+        if (instruction.invert) value.booleanValue = !value.booleanValue;
+        value.integerValue = 0;
+        break;
+      case OpCode::booleanToDecimal:
+        value.type = VariableType::tFloat;
+        if (instruction.invert) value.booleanValue = !value.booleanValue;
+        if (instruction.decimal1 == 0 && instruction.decimal2 == 0) value.floatValue = (double)value.booleanValue;
+        else value.floatValue = value.booleanValue ? instruction.decimal1 : instruction.decimal2;
+        value.booleanValue = false;
+        break;
+      case OpCode::invertBoolean:
+        value.booleanValue = !value.booleanValue;
+        break;
+      case OpCode::invertInteger:
+        value.integerValue = (int32_t)instruction.integer2 - (value.integerValue - (int32_t)instruction.integer1);
+        break;
+      case OpCode::invertInteger64:
+        value.integerValue64 = instruction.integer2 - (value.integerValue64 - instruction.integer1);
+        break;
+      case OpCode::invertDecimal:
+        value.floatValue = instruction.decimal2 - (value.floatValue - instruction.decimal1);
+        break;
+      case OpCode::round:
+        value.floatValue = std::round(value.floatValue * instruction.decimal1) / instruction.decimal1;
+        break;
+    }
+  }
+}
+
+}
+}
+}
@@ -0,0 +1,133 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef LIBHOMEGEAR_BASE_CASTPROGRAM_H_
+#define LIBHOMEGEAR_BASE_CASTPROGRAM_H_
+
+#include "ParameterCast.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace BaseLib {
+
+class Variable;
+
+namespace DeviceDescription {
+
+class ILogical;
+
+namespace ParameterCast {
+
+class CastProgram;
+typedef std::shared_ptr<const CastProgram> PCastProgram;
+
+/**
+ * Flattened, precompiled version of the cast chain of a parameter for one conversion direction. Instead of calling "fromPacket()" or "toPacket()" of
+ * each ICast object, the program executes a plain array of instructions directly on the value. Consecutive integer offsets are fused into one
+ * instruction and value maps are stored as sorted arrays. The results are identical to the ones of the cast objects.
+ *
+ * Only casts with a pure arithmetic or mapping conversion can be compiled. For all other cast chains "compile()" returns nullptr and the cast
+ * objects need to be used.
+ */
+class CastProgram {
+ public:
+  struct OpCode {
+    enum Enum : uint8_t {
+      none,
+      integerToDecimal,
+      decimalToInteger,
+      integerToDecimalInverse,
+      decimalToIntegerInverse,
+      integerMultiply,
+      integerDivide,
+      integerAffine,
+      decimalAffine,
+      integerMap,
+      integerToBoolean,
+      booleanToInteger,
+      decimalToBoolean,
+      booleanToDecimal,
+      invertBoolean,
+      invertInteger,
+      invertInteger64,
+      invertDecimal,
+      round
+    };
+  };
+
+  struct Instruction {
+    OpCode::Enum opCode = OpCode::none;
+    bool invert = false;
+    int64_t integer1 = 0;
+    int64_t integer2 = 0;
+    int64_t integer3 = 0;
+    double decimal1 = 0;
+    double decimal2 = 0;
+    double decimal3 = 0;
+    uint32_t mapStart = 0;
+    uint32_t mapSize = 0;
+  };
+
+  CastProgram() = default;
+  virtual ~CastProgram() = default;
+
+  /**
+   * Compiles a cast chain.
+   *
+   * @param casts The casts of the parameter.
+   * @param logical The logical of the parameter. Needed by casts depending on the logical type like "Invert".
+   * @param toPacket Set to "true" to compile the chain for "convertToPacket()" and to "false" for "convertFromPacket()".
+   * @return Returns the compiled program or nullptr when the chain contains casts that can't be compiled.
+   */
+  static PCastProgram compile(const Casts &casts, const std::shared_ptr<ILogical> &logical, bool toPacket);
+
+  /**
+   * Executes the program on "value". The value is modified in place.
+   */
+  void run(Variable &value) const;
+
+  size_t size() const { return _instructions.size(); }
+ private:
+  std::vector<Instruction> _instructions;
+  std::vector<std::pair<int32_t, int32_t>> _mapEntries;
+
+  bool addCast(const PICast &cast, const std::shared_ptr<ILogical> &logical, bool toPacket);
+  void addIntegerAffine(int64_t sign, int64_t constant);
+  void addMap(const std::map<int32_t, int32_t> &map);
+  int32_t mapValue(const Instruction &instruction, int32_t value) const;
+};
+
+}
+}
+}
+
+#endif
@@ -34,6 +34,10 @@
 #include "../BaseLib.h"
 #include "HomeMatic/HmConverter.h"
 
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+
 namespace BaseLib {
 namespace DeviceDescription {
 
@@ -47,6 +51,7 @@ Devices::Devices(BaseLib::SharedObjects *baseLib, IDevicesEventSink *eventHandle
 void Devices::clear() {
   std::lock_guard<std::mutex> devicesGuard(_devicesMutex);
   _devices.clear();
+  createIndex();
 }
 
 void Devices::load() {
@@ -66,6 +71,7 @@ void Devices::load(std::string &xmlPath) {
   try {
     std::lock_guard<std::mutex> devicesGuard(_devicesMutex);
     _devices.clear();
+    createIndex();
     std::string deviceDir(xmlPath);
     if (deviceDir.back() != '/') deviceDir.push_back('/');
     std::vector<std::string> files;
@@ -80,12 +86,76 @@ void Devices::load(std::string &xmlPath) {
       _bl->out.printError("No xml files found in \"" + xmlPath + "\".");
       return;
     }
-    for (std::vector<std::string>::iterator i = files.begin(); i != files.end(); ++i) {
-      std::string filename(deviceDir + *i);
-      std::shared_ptr<HomegearDevice> device = loadFile(filename);
+
+    if (_bl->settings.deviceDescriptionCache() && !_bl->settings.dataPath().empty()) {
+      std::string cachePath = _bl->settings.dataPath() + "cache/";
+      if (!Io::directoryExists(cachePath)) Io::createDirectory(cachePath, S_IRWXU | S_IRWXG);
+      cachePath += "devices/";
+      if (!Io::directoryExists(cachePath)) Io::createDirectory(cachePath, S_IRWXU | S_IRWXG);
+      cachePath += std::to_string(_family) + '/';
+      if (!Io::directoryExists(cachePath)) Io::createDirectory(cachePath, S_IRWXU | S_IRWXG);
+      if (Io::directoryExists(cachePath)) {
+        std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+        if (_cachePath != cachePath) {
+          _cachePath = cachePath;
+          std::string cacheVersion = getCacheVersion();
+          _cacheVersionHash = getContentHash(cacheVersion.data(), cacheVersion.size());
+          loadCacheIndex();
+        }
+      }
+    }
+
+    //Encrypted files are decrypted by the event handler, which is not necessarily thread safe. So only unencrypted files are loaded in parallel.
+    FileLoadInfo loadInfo;
+    std::vector<size_t> encryptedFiles;
+    loadInfo.files.reserve(files.size());
+    loadInfo.encrypted.reserve(files.size());
+    for (auto &file : files) {
+      std::string extension = file.size() > 4 ? file.substr(file.size() - 4) : "";
+      bool encrypted = HelperFunctions::toLower(extension) == ".hgd";
+      if (encrypted) encryptedFiles.push_back(loadInfo.files.size());
+      loadInfo.files.push_back(deviceDir + file);
+      loadInfo.encrypted.push_back(encrypted);
+    }
+    loadInfo.devices.resize(loadInfo.files.size());
+
+    size_t threadCount = _bl->settings.deviceDescriptionLoadThreadCount();
+    if (threadCount == 0) threadCount = std::thread::hardware_concurrency();
+    if (threadCount > loadInfo.files.size()) threadCount = loadInfo.files.size();
+    std::vector<std::thread> threads(threadCount > 1 ? threadCount - 1 : 0);
+    for (auto &thread : threads) {
+      _bl->threadManager.start(thread, true, &Devices::loadFilesWorker, this, &loadInfo);
+    }
+    loadFilesWorker(&loadInfo); //Also work on this thread. This makes sure all files are loaded even if no thread could be started.
+    for (auto &thread : threads) {
+      _bl->threadManager.join(thread);
+    }
+
+    for (auto index : encryptedFiles) {
+      loadInfo.devices[index] = loadFile(loadInfo.files[index]);
+    }
+
+    //Keep the order of the file list, so the result doesn't depend on thread timing.
+    for (auto &device : loadInfo.devices) {
       if (device) _devices.push_back(device);
     }
 
+    bool cacheEnabled = false;
+    {
+      std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+      cacheEnabled = !_cachePath.empty();
+    }
+    if (cacheEnabled) {
+      std::vector<std::string> existingFiles;
+      existingFiles.reserve(files.size());
+      for (auto &file : files) {
+        existingFiles.push_back(deviceDir + file);
+      }
+      saveCacheIndex(existingFiles);
+    }
+
+    createIndex();
+
     if (_devices.empty()) _bl->out.printError("Could not load any devices from xml files in \"" + deviceDir + "\".");
   }
   catch (const std::exception &ex) {
@@ -96,6 +166,12 @@ void Devices::load(std::string &xmlPath) {
   }
 }
 
+void Devices::loadFilesWorker(FileLoadInfo *loadInfo) {
+  for (size_t i = loadInfo->nextIndex++; i < loadInfo->files.size(); i = loadInfo->nextIndex++) {
+    if (!loadInfo->encrypted[i]) loadInfo->devices[i] = loadFile(loadInfo->files[i]);
+  }
+}
+
 std::shared_ptr<HomegearDevice> Devices::loadFile(std::string &filepath) {
   try {
     if (!Io::fileExists(filepath)) {
@@ -109,6 +185,10 @@ std::shared_ptr<HomegearDevice> Devices::loadFile(std::string &filepath) {
     if (_bl->debugLevel >= 5) _bl->out.printDebug("Loading XML RPC device " + filepath);
     bool oldFormat = false;
     std::shared_ptr<HomegearDevice> device;
+    if (extension == ".xml") {
+      device = loadFromCache(filepath);
+      if (device) return device;
+    }
     if (extension == ".hgd") {
       std::vector<char> data = Io::getBinaryFileContent(filepath);
       int32_t pos = -1;
@@ -130,8 +210,11 @@ std::shared_ptr<HomegearDevice> Devices::loadFile(std::string &filepath) {
       if (_eventHandler) ((IDevicesEventSink *)_eventHandler)->onDecryptDeviceDescription(moduleId, input, xml);
       if (!xml.empty()) device.reset(new HomegearDevice(_bl, filepath, xml));
     } else device.reset(new HomegearDevice(_bl, filepath, oldFormat));
-    if (oldFormat) return loadHomeMatic(filepath);
-    else if (device && device->loaded()) return device;
+    if (oldFormat) {
+      device = loadHomeMatic(filepath);
+      if (device) saveToCache(filepath, device);
+      return device;
+    } else if (device && device->loaded()) return device;
   }
   catch (const std::exception &ex) {
     _bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -1040,6 +1123,7 @@ std::shared_ptr<HomegearDevice> Devices::loadHomeMatic(std::string &filepath) {
     HmDeviceDescription::HmConverter converter(_bl);
     std::shared_ptr<HomegearDevice> device(new HomegearDevice(_bl));
     converter.convert(homeMaticDevice, device);
+    device->compileCasts();
     return device;
   }
   catch (const std::exception &ex) {
@@ -1051,8 +1135,272 @@ std::shared_ptr<HomegearDevice> Devices::loadHomeMatic(std::string &filepath) {
   return std::shared_ptr<HomegearDevice>();
 }
 
+// {{{ Cache
+std::string Devices::getCacheVersion() {
+  return std::to_string(_cacheFormatVersion) + '-' + SharedObjects::version();
+}
+
+void Devices::loadCacheIndex() {
+  try {
+    _cacheIndex.clear();
+    _cacheIndexChanged = false;
+    std::string indexFilename = _cachePath + "index";
+    int fileDescriptor = open(indexFilename.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fileDescriptor == -1) return;
+    struct stat fileInfo{};
+    if (fstat(fileDescriptor, &fileInfo) == -1 || fileInfo.st_size < 16) {
+      close(fileDescriptor);
+      return;
+    }
+    size_t size = fileInfo.st_size;
+    void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+    close(fileDescriptor);
+    if (mapping == MAP_FAILED) return;
+
+    const char *data = (const char *)mapping;
+    uint32_t version = 0;
+    uint32_t cacheVersionSize = 0;
+    std::memcpy(&version, data + 4, 4);
+    std::memcpy(&cacheVersionSize, data + 8, 4);
+    std::string cacheVersion;
+    if (12 + (size_t)cacheVersionSize + 4 <= size) cacheVersion.assign(data + 12, cacheVersionSize);
+    if (std::string(data, 4) == "HGDI" && version == _cacheFormatVersion && cacheVersion == getCacheVersion()) {
+      size_t pos = 12 + cacheVersionSize;
+      uint32_t count = 0;
+      std::memcpy(&count, data + pos, 4);
+      pos += 4;
+      for (uint32_t i = 0; i < count; i++) {
+        uint32_t pathSize = 0;
+        if (pos + 4 > size) break;
+        std::memcpy(&pathSize, data + pos, 4);
+        pos += 4;
+        if (pos + pathSize + 24 > size) break;
+        std::string path(data + pos, pathSize);
+        pos += pathSize;
+        CacheEntry entry;
+        std::memcpy(&entry.modificationTime, data + pos, 8);
+        std::memcpy(&entry.size, data + pos + 8, 8);
+        std::memcpy(&entry.hash, data + pos + 16, 8);
+        pos += 24;
+        _cacheIndex.emplace(std::move(path), entry);
+      }
+    } else {
+      //Written by another library version. None of the cached conversions can be used anymore.
+      _bl->out.printInfo("Info: Device description cache was written by another version. Clearing it.");
+      clearCacheDirectory();
+    }
+    munmap(mapping, size);
+  }
+  catch (const std::exception &ex) {
+    _bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void Devices::clearCacheDirectory() {
+  try {
+    std::vector<std::string> files = Io::getFiles(_cachePath);
+    for (auto &file : files) {
+      Io::deleteFile(_cachePath + file);
+    }
+  }
+  catch (const std::exception &ex) {
+    _bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void Devices::saveCacheIndex(const std::vector<std::string> &existingFiles) {
+  try {
+    std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+    if (_cachePath.empty()) return;
+
+    //Remove entries of deleted files in the directories just loaded
+    std::unordered_set<std::string> existingFileSet(existingFiles.begin(), existingFiles.end());
+    std::unordered_set<std::string> directories;
+    for (auto &file : existingFiles) {
+      directories.emplace(file.substr(0, file.find_last_of('/') + 1));
+    }
+    for (auto entryIterator = _cacheIndex.begin(); entryIterator != _cacheIndex.end();) {
+      std::string directory = entryIterator->first.substr(0, entryIterator->first.find_last_of('/') + 1);
+      if (directories.find(directory) != directories.end() && existingFileSet.find(entryIterator->first) == existingFileSet.end()) {
+        Io::deleteFile(getCacheFilename(entryIterator->first, entryIterator->second.hash));
+        entryIterator = _cacheIndex.erase(entryIterator);
+        _cacheIndexChanged = true;
+      } else ++entryIterator;
+    }
+
+    if (!_cacheIndexChanged) return;
+
+    std::string cacheVersion = getCacheVersion();
+    std::vector<char> data;
+    data.reserve(16 + cacheVersion.size() + _cacheIndex.size() * 128);
+    uint32_t version = _cacheFormatVersion;
+    uint32_t cacheVersionSize = cacheVersion.size();
+    uint32_t count = _cacheIndex.size();
+    data.push_back('H');
+    data.push_back('G');
+    data.push_back('D');
+    data.push_back('I');
+    data.insert(data.end(), (char *)&version, (char *)&version + 4);
+    data.insert(data.end(), (char *)&cacheVersionSize, (char *)&cacheVersionSize + 4);
+    data.insert(data.end(), cacheVersion.begin(), cacheVersion.end());
+    data.insert(data.end(), (char *)&count, (char *)&count + 4);
+    for (auto &entry : _cacheIndex) {
+      uint32_t pathSize = entry.first.size();
+      data.insert(data.end(), (char *)&pathSize, (char *)&pathSize + 4);
+      data.insert(data.end(), entry.first.begin(), entry.first.end());
+      data.insert(data.end(), (char *)&entry.second.modificationTime, (char *)&entry.second.modificationTime + 8);
+      data.insert(data.end(), (char *)&entry.second.size, (char *)&entry.second.size + 8);
+      data.insert(data.end(), (char *)&entry.second.hash, (char *)&entry.second.hash + 8);
+    }
+
+    //Write to a temporary file first, so an interrupted write never leaves a corrupted index.
+    std::string indexFilename = _cachePath + "index";
+    std::string tempFilename = indexFilename + ".tmp";
+    Io::writeFile(tempFilename, data, data.size());
+    if (rename(tempFilename.c_str(), indexFilename.c_str()) == -1) {
+      _bl->out.printError("Error: Could not write device description cache index \"" + indexFilename + "\": " + std::string(strerror(errno)));
+      return;
+    }
+    _cacheIndexChanged = false;
+  }
+  catch (const std::exception &ex) {
+    _bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  catch (...) {
+    _bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+  }
+}
+
+std::string Devices::getCacheFilename(const std::string &filepath, uint64_t hash) {
+  return _cachePath + HelperFunctions::getHexString(getContentHash(filepath.data(), filepath.size()) ^ _cacheVersionHash, 16) + '-' + HelperFunctions::getHexString(hash, 16) + ".xml";
+}
+
+uint64_t Devices::getContentHash(const char *data, size_t size) {
+  //FNV-1a
+  uint64_t hash = 14695981039346656037ULL;
+  for (size_t i = 0; i < size; i++) {
+    hash ^= (uint8_t)data[i];
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+std::shared_ptr<HomegearDevice> Devices::loadFromCache(const std::string &filepath) {
+  try {
+    struct stat fileInfo{};
+    if (stat(filepath.c_str(), &fileInfo) == -1) return std::shared_ptr<HomegearDevice>();
+    int64_t modificationTime = (int64_t)fileInfo.st_mtim.tv_sec * 1000000000 + fileInfo.st_mtim.tv_nsec;
+
+    CacheEntry entry;
+    std::string cacheFilename;
+    {
+      std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+      if (_cachePath.empty()) return std::shared_ptr<HomegearDevice>();
+      auto entryIterator = _cacheIndex.find(filepath);
+      if (entryIterator == _cacheIndex.end()) return std::shared_ptr<HomegearDevice>();
+      entry = entryIterator->second;
+      cacheFilename = getCacheFilename(filepath, entry.hash);
+    }
+
+    if (entry.modificationTime != modificationTime || entry.size != (uint64_t)fileInfo.st_size) {
+      //The file was touched. It only needs to be converted again when its content changed.
+      std::vector<char> content = Io::getBinaryFileContent(filepath);
+      if (getContentHash(content.data(), content.size()) != entry.hash) return std::shared_ptr<HomegearDevice>();
+      std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+      auto entryIterator = _cacheIndex.find(filepath);
+      if (entryIterator != _cacheIndex.end()) {
+        entryIterator->second.modificationTime = modificationTime;
+        entryIterator->second.size = fileInfo.st_size;
+        _cacheIndexChanged = true;
+      }
+    }
+
+    if (!Io::fileExists(cacheFilename)) return std::shared_ptr<HomegearDevice>();
+    std::vector<char> xml = Io::getBinaryFileContent(cacheFilename);
+    xml.push_back('\0');
+    std::shared_ptr<HomegearDevice> device = std::make_shared<HomegearDevice>(_bl);
+    if (!device->loadSaved(xml)) return std::shared_ptr<HomegearDevice>();
+    if (_bl->debugLevel >= 5) _bl->out.printDebug("Debug: Loaded converted device description of " + filepath + " from cache.");
+    return device;
+  }
+  catch (const std::exception &ex) {
+    _bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  catch (...) {
+    _bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+  }
+  return std::shared_ptr<HomegearDevice>();
+}
+
+void Devices::saveToCache(const std::string &filepath, std::shared_ptr<HomegearDevice> &device) {
+  try {
+    struct stat fileInfo{};
+    if (stat(filepath.c_str(), &fileInfo) == -1) return;
+
+    CacheEntry entry;
+    entry.modificationTime = (int64_t)fileInfo.st_mtim.tv_sec * 1000000000 + fileInfo.st_mtim.tv_nsec;
+    entry.size = fileInfo.st_size;
+    std::vector<char> content = Io::getBinaryFileContent(filepath);
+    entry.hash = getContentHash(content.data(), content.size());
+
+    std::string cacheFilename;
+    std::string oldCacheFilename;
+    {
+      std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+      if (_cachePath.empty()) return;
+      cacheFilename = getCacheFilename(filepath, entry.hash);
+      auto entryIterator = _cacheIndex.find(filepath);
+      if (entryIterator != _cacheIndex.end() && entryIterator->second.hash != entry.hash) oldCacheFilename = getCacheFilename(filepath, entryIterator->second.hash);
+    }
+
+    //The cache file name is unique per source file, so no other thread writes it.
+    device->save(cacheFilename);
+    if (!Io::fileExists(cacheFilename)) return;
+    if (!oldCacheFilename.empty()) Io::deleteFile(oldCacheFilename);
+
+    std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+    _cacheIndex[filepath] = entry;
+    _cacheIndexChanged = true;
+  }
+  catch (const std::exception &ex) {
+    _bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  catch (...) {
+    _bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+  }
+}
+// }}}
+
+void Devices::createIndex() {
+  try {
+    auto index = std::make_shared<DeviceIndex>();
+    for (auto &device : _devices) {
+      for (auto &supportedDevice : device->supportedDevices) {
+        DeviceIndex::Candidate candidate;
+        candidate.supportedDevice = supportedDevice;
+        candidate.device = device;
+        index->devicesByTypeNumber[supportedDevice->typeNumber].push_back(std::move(candidate));
+        //emplace doesn't overwrite existing entries, so the first match wins like when searching "_devices".
+        index->typeNumbersByTypeId.emplace(supportedDevice->id, supportedDevice->typeNumber);
+        index->typeNumbersByProductId.emplace(supportedDevice->productId, supportedDevice->typeNumber);
+      }
+    }
+    std::atomic_store(&_index, std::shared_ptr<const DeviceIndex>(std::move(index)));
+    std::atomic_store(&_dynamicDeviceIndex, std::shared_ptr<const DynamicDeviceIndex>());
+  }
+  catch (const std::exception &ex) {
+    _bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
 uint64_t Devices::getTypeNumberFromTypeId(const std::string &typeId) {
   try {
+    auto index = std::atomic_load(&_index);
+    if (index) {
+      auto typeNumberIterator = index->typeNumbersByTypeId.find(typeId);
+      if (typeNumberIterator != index->typeNumbersByTypeId.end()) return typeNumberIterator->second;
+    }
+
     std::lock_guard<std::mutex> devicesGuard(_devicesMutex);
     for (auto &device : _devices) {
       for (auto &supportedDevice : device->supportedDevices) {
@@ -1068,6 +1416,12 @@ uint64_t Devices::getTypeNumberFromTypeId(const std::string &typeId) {
 
 uint64_t Devices::getTypeNumberFromProductId(const std::string &productId) {
   try {
+    auto index = std::atomic_load(&_index);
+    if (index) {
+      auto typeNumberIterator = index->typeNumbersByProductId.find(productId);
+      if (typeNumberIterator != index->typeNumbersByProductId.end()) return typeNumberIterator->second;
+    }
+
     std::lock_guard<std::mutex> devicesGuard(_devicesMutex);
     for (auto &device : _devices) {
       for (auto &supportedDevice : device->supportedDevices) {
@@ -1081,29 +1435,82 @@ uint64_t Devices::getTypeNumberFromProductId(const std::string &productId) {
   return 0;
 }
 
+std::shared_ptr<HomegearDevice> Devices::findUnindexed(uint64_t typeNumber, uint32_t firmwareVersion) {
+  for (auto &device : _devices) {
+    for (auto &supportedDevice : device->supportedDevices) {
+      if (supportedDevice->matches(typeNumber, firmwareVersion)) return device;
+    }
+  }
+  return nullptr;
+}
+
+std::shared_ptr<HomegearDevice> Devices::getDynamicDevice(const std::shared_ptr<HomegearDevice> &device, int32_t channelCount) {
+  DynamicDeviceKey key;
+  key.device = device.get();
+  key.channelCount = channelCount;
+
+  auto dynamicDeviceIndex = std::atomic_load(&_dynamicDeviceIndex);
+  if (dynamicDeviceIndex) {
+    auto dynamicDeviceIterator = dynamicDeviceIndex->find(key);
+    if (dynamicDeviceIterator != dynamicDeviceIndex->end()) {
+      auto dynamicDevice = dynamicDeviceIterator->second.lock();
+      if (dynamicDevice) return dynamicDevice;
+    }
+  }
+
+  std::lock_guard<std::mutex> devicesGuard(_devicesMutex);
+  //Another thread might have created the device in the meantime.
+  dynamicDeviceIndex = std::atomic_load(&_dynamicDeviceIndex);
+  if (dynamicDeviceIndex) {
+    auto dynamicDeviceIterator = dynamicDeviceIndex->find(key);
+    if (dynamicDeviceIterator != dynamicDeviceIndex->end()) {
+      auto dynamicDevice = dynamicDeviceIterator->second.lock();
+      if (dynamicDevice) return dynamicDevice;
+    }
+  }
+
+  //The copy shares all functions, parameter groups and parameters with the original description. setDynamicChannelCount() only adds
+  //references to the dynamic function to the copied maps.
+  auto newDevice = std::make_shared<HomegearDevice>(*device);
+  newDevice->setDynamicChannelCount(channelCount);
+
+  auto newDynamicDeviceIndex = std::make_shared<DynamicDeviceIndex>();
+  if (dynamicDeviceIndex) {
+    newDynamicDeviceIndex->reserve(dynamicDeviceIndex->size() + 1);
+    for (auto &entry : *dynamicDeviceIndex) {
+      if (!entry.second.expired()) newDynamicDeviceIndex->emplace(entry.first, entry.second);
+    }
+  }
+  (*newDynamicDeviceIndex)[key] = newDevice;
+  std::atomic_store(&_dynamicDeviceIndex, std::shared_ptr<const DynamicDeviceIndex>(std::move(newDynamicDeviceIndex)));
+  return newDevice;
+}
+
 std::shared_ptr<HomegearDevice> Devices::find(uint64_t typeNumber, uint32_t firmwareVersion, int32_t countFromSysinfo) {
   try {
-    std::lock_guard<std::mutex> devicesGuard(_devicesMutex);
-    for (std::vector<std::shared_ptr<HomegearDevice>>::iterator i = _devices.begin(); i != _devices.end(); ++i) {
-      for (SupportedDevices::iterator j = (*i)->supportedDevices.begin(); j != (*i)->supportedDevices.end(); ++j) {
-        if ((*j)->matches(typeNumber, firmwareVersion)) {
-          if (countFromSysinfo > -1 && (*i)->dynamicChannelCountIndex > -1) {
-            //Device has dynamic channel count
-            for (std::vector<std::shared_ptr<HomegearDevice>>::iterator k = _dynamicDevices.begin(); k != _dynamicDevices.end(); ++k) {
-              for (SupportedDevices::iterator l = (*k)->supportedDevices.begin(); l != (*k)->supportedDevices.end(); ++l) {
-                if ((*l)->matches(typeNumber, firmwareVersion) && (*k)->getDynamicChannelCount() == countFromSysinfo) return *k;
-              }
-            }
-            //No matching device was found
-            std::shared_ptr<HomegearDevice> newDevice(new HomegearDevice(_bl));
-            *newDevice = **i;
-            newDevice->setDynamicChannelCount(countFromSysinfo);
-            _dynamicDevices.push_back(newDevice);
-            return newDevice;
-          } else return *i;
+    std::shared_ptr<HomegearDevice> device;
+    auto index = std::atomic_load(&_index);
+    if (index) {
+      auto candidatesIterator = index->devicesByTypeNumber.find(typeNumber);
+      if (candidatesIterator != index->devicesByTypeNumber.end()) {
+        for (auto &candidate : candidatesIterator->second) {
+          if (candidate.supportedDevice->matches(typeNumber, firmwareVersion)) {
+            device = candidate.device;
+            break;
+          }
         }
       }
     }
+
+    if (!device) {
+      std::lock_guard<std::mutex> devicesGuard(_devicesMutex);
+      device = findUnindexed(typeNumber, firmwareVersion);
+      if (!device) return nullptr;
+    }
+
+    //Device has dynamic channel count
+    if (countFromSysinfo > -1 && device->dynamicChannelCountIndex > -1) return getDynamicDevice(device, countFromSysinfo);
+    return device;
   }
   catch (const std::exception &ex) {
     _bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
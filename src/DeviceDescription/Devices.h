@@ -35,7 +35,9 @@
 
 #include <vector>
 #include <memory>
+#include <atomic>
 #include <unordered_set>
+#include <unordered_map>
 
 #include "../Systems/Packet.h"
 #include "../Sockets/RpcClientInfo.h"
@@ -88,10 +90,111 @@ protected:
 	int32_t _family = -1;
 	std::mutex _devicesMutex;
 	std::vector<std::shared_ptr<HomegearDevice>> _devices;
+
+	/**
+	 * @deprecated Not filled anymore. Dynamic channel variants are only referenced weakly through "_dynamicDeviceIndex", so they can be freed.
+	 * Kept so derived classes still compile. Will be removed in a future version.
+	 */
 	std::vector<std::shared_ptr<HomegearDevice>> _dynamicDevices;
     std::shared_ptr<DeviceDescription::DeviceTranslations> _translations;
 
 	std::shared_ptr<HomegearDevice> loadHomeMatic(std::string& filepath);
+
+	// {{{ Lookup indexes
+	/**
+	 * Indexes of "_devices" built at load time. The index is never modified after it was created, so it can be read without locking
+	 * "_devicesMutex". It is replaced atomically.
+	 */
+	struct DeviceIndex {
+		struct Candidate {
+			PSupportedDevice supportedDevice;
+			std::shared_ptr<HomegearDevice> device;
+		};
+
+		std::unordered_map<uint64_t, std::vector<Candidate>> devicesByTypeNumber;
+		std::unordered_map<std::string, uint64_t> typeNumbersByTypeId;
+		std::unordered_map<std::string, uint64_t> typeNumbersByProductId;
+	};
+
+	struct DynamicDeviceKey {
+		const HomegearDevice* device = nullptr;
+		int32_t channelCount = 0;
+
+		bool operator==(const DynamicDeviceKey& other) const { return device == other.device && channelCount == other.channelCount; }
+	};
+
+	struct DynamicDeviceKeyHash {
+		size_t operator()(const DynamicDeviceKey& key) const { return std::hash<const void*>()(key.device) ^ std::hash<int32_t>()(key.channelCount); }
+	};
+
+	typedef std::unordered_map<DynamicDeviceKey, std::weak_ptr<HomegearDevice>, DynamicDeviceKeyHash> DynamicDeviceIndex;
+
+	std::shared_ptr<const DeviceIndex> _index;
+
+	/**
+	 * Maps a device with dynamic channel count and the channel count to the variant created for it. Variants are only referenced weakly, so they
+	 * are freed when no peer uses them anymore. Copied on write while "_devicesMutex" is locked.
+	 */
+	std::shared_ptr<const DynamicDeviceIndex> _dynamicDeviceIndex;
+
+	/**
+	 * Rebuilds "_index". "_devicesMutex" needs to be locked.
+	 */
+	void createIndex();
+
+	/**
+	 * Searches "_devices" without using the index. Used for devices added after the index was built. "_devicesMutex" needs to be locked.
+	 */
+	std::shared_ptr<HomegearDevice> findUnindexed(uint64_t typeNumber, uint32_t firmwareVersion);
+	std::shared_ptr<HomegearDevice> getDynamicDevice(const std::shared_ptr<HomegearDevice>& device, int32_t channelCount);
+	// }}}
+
+	// {{{ Loading
+	struct FileLoadInfo {
+		std::vector<std::string> files;
+		/**
+		 * Encrypted files are skipped by the workers and loaded afterwards on the calling thread.
+		 */
+		std::vector<uint8_t> encrypted;
+		std::vector<std::shared_ptr<HomegearDevice>> devices;
+		std::atomic<size_t> nextIndex{0};
+	};
+
+	void loadFilesWorker(FileLoadInfo* loadInfo);
+	// }}}
+
+	// {{{ Cache
+	/**
+	 * Cache of converted HomeMatic device descriptions. Converted descriptions are stored in the format written by HomegearDevice::save(). The
+	 * index maps the path of the original file to its modification time, size and content hash. The index header and the cache file names include
+	 * the cache format version and the library version, so conversions of a different converter are never loaded.
+	 */
+	struct CacheEntry {
+		int64_t modificationTime = 0;
+		uint64_t size = 0;
+		uint64_t hash = 0;
+	};
+
+	/**
+	 * Increment when the conversion or the format written by HomegearDevice::save() changes in a way the library version doesn't reflect.
+	 */
+	static const uint32_t _cacheFormatVersion = 2;
+
+	std::string _cachePath;
+	std::mutex _cacheMutex;
+	uint64_t _cacheVersionHash = 0;
+	std::unordered_map<std::string, CacheEntry> _cacheIndex;
+	bool _cacheIndexChanged = false;
+
+	static std::string getCacheVersion();
+	void loadCacheIndex();
+	void clearCacheDirectory();
+	void saveCacheIndex(const std::vector<std::string>& existingFiles);
+	std::string getCacheFilename(const std::string& filepath, uint64_t hash);
+	static uint64_t getContentHash(const char* data, size_t size);
+	std::shared_ptr<HomegearDevice> loadFromCache(const std::string& filepath);
+	void saveToCache(const std::string& filepath, std::shared_ptr<HomegearDevice>& device);
+	// }}}
 };
 
 }
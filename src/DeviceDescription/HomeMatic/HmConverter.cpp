@@ -200,6 +200,7 @@ void HmConverter::convert(std::shared_ptr<Device> homematicDevice, std::shared_p
 		if(!packet->function1.empty()) homegearDevice->packetsByFunction1.insert(std::pair<std::string, PPacket>(packet->function1, packet));
 		if(!packet->function2.empty()) homegearDevice->packetsByFunction2.insert(std::pair<std::string, PPacket>(packet->function2, packet));
 	}
+	homegearDevice->invalidatePacketMatcher();
 
 	for(Functions::iterator i = homegearDevice->functions.begin(); i != homegearDevice->functions.end(); ++i)
 	{
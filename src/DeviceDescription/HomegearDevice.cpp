@@ -148,6 +148,7 @@ void HomegearDevice::load(std::string xmlFilename, std::vector<char> &xml) {
     parseXML(doc.first_node("homegearDevice"));
 
     postLoad();
+    compileCasts();
     _loaded = true;
   }
   catch (const std::exception &ex) {
@@ -188,6 +189,7 @@ void HomegearDevice::load(std::string xmlFilename, bool &oldFormat) {
     } else _bl->out.printError("Error reading file " + xmlFilename + ": " + strerror(errno));
 
     postLoad();
+    compileCasts();
     _loaded = true;
   }
   catch (const std::exception &ex) {
@@ -244,6 +246,24 @@ void HomegearDevice::postLoad() {
   }
 }
 
+void HomegearDevice::compileCasts() {
+  try {
+    for (auto &function : functions) {
+      if (!function.second) continue;
+      if (function.second->parameterGroupSelector) function.second->parameterGroupSelector->compileCasts();
+      for (auto &parameterGroup : {(PParameterGroup)function.second->configParameters, (PParameterGroup)function.second->variables, (PParameterGroup)function.second->linkParameters}) {
+        if (!parameterGroup) continue;
+        for (auto &parameter : parameterGroup->parameters) {
+          if (parameter.second) parameter.second->compileCasts();
+        }
+      }
+    }
+  }
+  catch (const std::exception &ex) {
+    _bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
 void HomegearDevice::save(std::string &filename) {
   xml_document doc;
   try {
@@ -275,6 +295,43 @@ void HomegearDevice::save(std::string &filename) {
   doc.clear();
 }
 
+PPacketMatcher HomegearDevice::getPacketMatcher() {
+  auto packetMatcher = std::atomic_load(&_packetMatcher.matcher);
+  if (packetMatcher) return packetMatcher;
+  //When called concurrently, the matcher might be compiled more than once. This is harmless.
+  packetMatcher = std::make_shared<const PacketMatcher>(packetsByMessageType);
+  std::atomic_store(&_packetMatcher.matcher, packetMatcher);
+  return packetMatcher;
+}
+
+void HomegearDevice::invalidatePacketMatcher() {
+  std::atomic_store(&_packetMatcher.matcher, PPacketMatcher());
+}
+
+bool HomegearDevice::loadSaved(std::vector<char> &xml) {
+  if (xml.empty() || xml.back() != '\0') return false;
+  xml_document doc;
+  try {
+    doc.parse<parse_no_entity_translation | parse_validate_closing_tags>(xml.data());
+    xml_node *node = doc.first_node("homegearDevice");
+    if (!node) {
+      doc.clear();
+      return false;
+    }
+    parseXML(node);
+    compileCasts();
+    _loaded = true;
+  }
+  catch (const std::exception &ex) {
+    _bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  catch (...) {
+    _bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__);
+  }
+  doc.clear();
+  return _loaded;
+}
+
 void HomegearDevice::saveDevice(xml_document *doc, xml_node *parentNode, HomegearDevice *device) {
   try {
     std::string tempString = std::to_string(device->version);
@@ -2353,6 +2410,7 @@ void HomegearDevice::parseXML(xml_node *node) {
           if (!packet->function1.empty()) packetsByFunction1.insert(std::pair<std::string, PPacket>(packet->function1, packet));
           if (!packet->function2.empty()) packetsByFunction2.insert(std::pair<std::string, PPacket>(packet->function2, packet));
         }
+        invalidatePacketMatcher();
       } else if (nodeName == "group") {
         group.reset(new HomegearDevice(_bl, subNode));
       } else _bl->out.printWarning("Warning: Unknown node name for \"homegearDevice\": " + nodeName);
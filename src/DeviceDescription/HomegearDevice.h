@@ -34,6 +34,7 @@
 #include <cstdint>
 
 #include "DevicePacket.h"
+#include "PacketMatcher.h"
 #include "SupportedDevice.h"
 #include "RunProgram.h"
 #include "Function.h"
@@ -113,10 +114,46 @@ public:
     void setFilename(std::string& value);
     std::string getFilename();
 	int32_t getDynamicChannelCount();
+
+	/**
+	 * Adds the channels of a device with dynamic channel count. The added channels reference the function with "dynamicChannelCountIndex" set,
+	 * so they don't use additional memory for functions, parameter groups or parameters. This is also true for copies of the description.
+	 *
+	 * @param value The number of channels.
+	 */
 	void setDynamicChannelCount(int32_t value);
 	PSupportedDevice getType(uint64_t typeNumber);
 	PSupportedDevice getType(uint64_t typeNumber, int32_t firmwareVersion);
 	void save(std::string& filename);
+
+	/**
+	 * Returns a matcher to find the packet definition of received packets. The matcher is compiled from "packetsByMessageType" on the first call.
+	 *
+	 * @see PacketMatcher
+	 * @see invalidatePacketMatcher()
+	 */
+	PPacketMatcher getPacketMatcher();
+
+	/**
+	 * Discards the compiled packet matcher. Needs to be called after "packetsByMessageType" or the packets in it were changed.
+	 */
+	void invalidatePacketMatcher();
+
+	/**
+	 * Loads a device description previously written with save(). In contrast to loading a device description file, no parameters are added,
+	 * so the loaded description equals the saved one.
+	 *
+	 * @param xml The XML written by save(). Needs to end with a null character.
+	 * @return Returns "true" on success.
+	 */
+	bool loadSaved(std::vector<char>& xml);
+
+	/**
+	 * Compiles the casts of all parameters of all functions. Needs to be called after the device description is completely loaded.
+	 *
+	 * @see Parameter::compileCasts()
+	 */
+	void compileCasts();
 	// }}}
 protected:
 	BaseLib::SharedObjects* _bl = nullptr;
@@ -126,6 +163,20 @@ protected:
 	std::string _path;
     std::string _filename;
 	int32_t _dynamicChannelCount = -1;
+
+	/**
+	 * Holds the lazily compiled matcher. It might be set concurrently, so it is only accessed atomically, also when the device is copied.
+	 */
+	struct PacketMatcherHolder
+	{
+		PPacketMatcher matcher;
+
+		PacketMatcherHolder() = default;
+		PacketMatcherHolder(const PacketMatcherHolder& other) : matcher(std::atomic_load(&other.matcher)) {}
+		PacketMatcherHolder& operator=(const PacketMatcherHolder& other) { std::atomic_store(&matcher, std::atomic_load(&other.matcher)); return *this; }
+	};
+
+	PacketMatcherHolder _packetMatcher;
 	// }}}
 
 	void load(std::string xmlFilename, bool& oldFormat);
@@ -0,0 +1,240 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "PacketMatcher.h"
+
+#include <cmath>
+
+namespace BaseLib
+{
+namespace DeviceDescription
+{
+
+bool PacketMatcher::Condition::read(const std::vector<uint8_t>& data, uint32_t& result) const
+{
+	if(byteIndex + byteCount > data.size()) return false;
+	result = 0;
+	for(uint32_t i = byteIndex; i < byteIndex + byteCount; i++)
+	{
+		result = (result << 8u) | data[i];
+	}
+	result = (result >> shift) & mask;
+	return true;
+}
+
+bool PacketMatcher::Condition::matches(const std::vector<uint8_t>& data) const
+{
+	uint32_t result = 0;
+	return read(data, result) && result == value;
+}
+
+PacketMatcher::PacketMatcher(const PacketsByMessageType& packets)
+{
+	std::map<int32_t, std::vector<Candidate>> candidatesByType;
+	std::vector<Candidate> anyTypeCandidates;
+	for(auto& entry : packets)
+	{
+		const PPacket& packet = entry.second;
+		if(!packet) continue;
+		Candidate candidate;
+		candidate.packet = packet;
+		for(auto& payload : packet->binaryPayloads)
+		{
+			if(!payload || payload->constValueInteger < 0) continue;
+			Condition condition;
+			if(!compilePosition(payload->index, payload->size, condition))
+			{
+				candidate.exact = false;
+				continue;
+			}
+			condition.value = (uint32_t)payload->constValueInteger;
+			candidate.conditions.push_back(condition);
+		}
+		if(packet->type == -1) anyTypeCandidates.push_back(std::move(candidate));
+		else candidatesByType[packet->type].push_back(std::move(candidate));
+	}
+
+	for(auto& typeCandidates : candidatesByType)
+	{
+		buildNode(typeCandidates.second, _types[typeCandidates.first]);
+	}
+	buildNode(anyTypeCandidates, _anyType);
+}
+
+bool PacketMatcher::compilePosition(double index, double size, Condition& condition)
+{
+	if(index < 0 || size <= 0) return false;
+	uint32_t byteIndex = (uint32_t)index;
+	uint32_t bitIndex = (uint32_t)std::lround((index - byteIndex) * 10);
+	uint32_t bitSize = (uint32_t)size * 8 + (uint32_t)std::lround((size - (uint32_t)size) * 10);
+	if(bitSize == 0 || bitIndex > 7) return false;
+
+	condition.byteIndex = byteIndex;
+	if(bitIndex + bitSize <= 8)
+	{
+		//Value within one byte
+		condition.byteCount = 1;
+		condition.shift = bitIndex;
+		condition.mask = (1u << bitSize) - 1;
+		return true;
+	}
+	else if(bitIndex == 0 && bitSize % 8 == 0 && bitSize <= 32)
+	{
+		condition.byteCount = bitSize / 8;
+		condition.shift = 0;
+		condition.mask = bitSize == 32 ? 0xFFFFFFFFu : (1u << bitSize) - 1;
+		return true;
+	}
+	return false;
+}
+
+void PacketMatcher::buildNode(const std::vector<Candidate>& candidates, TypeNode& node)
+{
+	//Candidates can only be selected by subtype, when all subtypes are at the same position.
+	bool hasSubtype = false;
+	bool samePosition = true;
+	Condition position;
+	for(auto& candidate : candidates)
+	{
+		if(candidate.packet->subtype < 0 || candidate.packet->subtypeIndex < 0) continue;
+		Condition currentPosition;
+		if(!compilePosition(candidate.packet->subtypeIndex, candidate.packet->subtypeSize > 0 ? candidate.packet->subtypeSize : 1.0, currentPosition))
+		{
+			samePosition = false;
+			break;
+		}
+		if(!hasSubtype)
+		{
+			position = currentPosition;
+			hasSubtype = true;
+		}
+		else if(currentPosition.byteIndex != position.byteIndex || currentPosition.byteCount != position.byteCount || currentPosition.shift != position.shift || currentPosition.mask != position.mask)
+		{
+			samePosition = false;
+			break;
+		}
+	}
+
+	if(!hasSubtype || !samePosition)
+	{
+		//Check the subtype like any other constant field
+		node.subtypeIndexed = false;
+		node.candidates.reserve(candidates.size());
+		for(auto& candidate : candidates)
+		{
+			node.candidates.push_back(candidate);
+			if(candidate.packet->subtype < 0) continue;
+			Condition condition;
+			if(candidate.packet->subtypeIndex < 0 || !compilePosition(candidate.packet->subtypeIndex, candidate.packet->subtypeSize > 0 ? candidate.packet->subtypeSize : 1.0, condition))
+			{
+				node.candidates.back().exact = false;
+				continue;
+			}
+			condition.value = (uint32_t)candidate.packet->subtype;
+			node.candidates.back().conditions.insert(node.candidates.back().conditions.begin(), condition);
+		}
+		return;
+	}
+
+	node.subtypeIndexed = true;
+	node.subtypePosition = position;
+	for(auto& candidate : candidates)
+	{
+		if(candidate.packet->subtype < 0) node.candidates.push_back(candidate);
+		else if(candidate.packet->subtypeIndex < 0)
+		{
+			node.candidates.push_back(candidate);
+			node.candidates.back().exact = false;
+		}
+		else node.candidatesBySubtype.emplace((uint32_t)candidate.packet->subtype, std::vector<Candidate>());
+	}
+	//Keep the original order of candidates with and without subtype
+	for(auto& subtypeCandidates : node.candidatesBySubtype)
+	{
+		for(auto& candidate : candidates)
+		{
+			if(candidate.packet->subtype >= 0 && candidate.packet->subtypeIndex < 0)
+			{
+				subtypeCandidates.second.push_back(candidate);
+				subtypeCandidates.second.back().exact = false;
+			}
+			else if(candidate.packet->subtype < 0 || (uint32_t)candidate.packet->subtype == subtypeCandidates.first) subtypeCandidates.second.push_back(candidate);
+		}
+	}
+}
+
+PPacket PacketMatcher::find(const std::vector<Candidate>& candidates, const std::vector<uint8_t>& data, Packet::Direction::Enum direction, const std::function<bool(const PPacket&)>& verify)
+{
+	for(auto& candidate : candidates)
+	{
+		if(direction != Packet::Direction::Enum::none && candidate.packet->direction != direction) continue;
+		bool matches = true;
+		for(auto& condition : candidate.conditions)
+		{
+			if(!condition.matches(data))
+			{
+				matches = false;
+				break;
+			}
+		}
+		if(!matches) continue;
+		if(!candidate.exact && verify && !verify(candidate.packet)) continue;
+		return candidate.packet;
+	}
+	return PPacket();
+}
+
+PPacket PacketMatcher::find(const TypeNode& node, const std::vector<uint8_t>& data, Packet::Direction::Enum direction, const std::function<bool(const PPacket&)>& verify)
+{
+	if(node.subtypeIndexed)
+	{
+		uint32_t subtype = 0;
+		if(node.subtypePosition.read(data, subtype))
+		{
+			auto candidatesIterator = node.candidatesBySubtype.find(subtype);
+			if(candidatesIterator != node.candidatesBySubtype.end()) return find(candidatesIterator->second, data, direction, verify);
+		}
+	}
+	return find(node.candidates, data, direction, verify);
+}
+
+PPacket PacketMatcher::find(int32_t type, const std::vector<uint8_t>& data, Packet::Direction::Enum direction, const std::function<bool(const PPacket&)>& verify) const
+{
+	auto typeIterator = _types.find(type);
+	if(typeIterator != _types.end())
+	{
+		PPacket packet = find(typeIterator->second, data, direction, verify);
+		if(packet) return packet;
+	}
+	return find(_anyType, data, direction, verify);
+}
+
+}
+}
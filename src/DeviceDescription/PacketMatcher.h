@@ -0,0 +1,132 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef PACKETMATCHER_H_
+#define PACKETMATCHER_H_
+
+#include "DevicePacket.h"
+
+#include <functional>
+#include <unordered_map>
+
+namespace BaseLib
+{
+namespace DeviceDescription
+{
+
+class PacketMatcher;
+
+/**
+ * Helper type for PacketMatcher pointers.
+ */
+typedef std::shared_ptr<const PacketMatcher> PPacketMatcher;
+
+/**
+ * Finds the packet definition matching a received binary packet. The matcher is compiled once from "packetsByMessageType". Packets are
+ * indexed by message type and subtype, so only the few candidates with the right type and subtype are checked. For them the constant payload
+ * fields ("constValueInteger") are compared directly on the packet bytes.
+ *
+ * Positions use the format of the device description files: The integer part of "index" is the byte index, the first decimal place the bit
+ * index within that byte. The integer part of "size" is the number of bytes, the first decimal place the number of additional bits. Values
+ * spanning multiple bytes are big endian.
+ */
+class PacketMatcher
+{
+public:
+	explicit PacketMatcher(const PacketsByMessageType& packets);
+	virtual ~PacketMatcher() = default;
+
+	/**
+	 * Returns the first packet definition matching the packet in the order of "packetsByMessageType".
+	 *
+	 * @param type The message type of the received packet.
+	 * @param data The received packet. "index" and "subtypeIndex" of the packet definitions are relative to the start of this buffer.
+	 * @param direction Only packets with this direction are returned. When "none", the direction is not checked.
+	 * @param verify Optional function called for candidates with conditions that couldn't be compiled (e.g. constant fields that don't start at a
+	 * byte boundary and span multiple bytes). When not set, these conditions are ignored.
+	 * @return Returns the matching packet definition or nullptr.
+	 */
+	PPacket find(int32_t type, const std::vector<uint8_t>& data, Packet::Direction::Enum direction = Packet::Direction::Enum::none, const std::function<bool(const PPacket&)>& verify = std::function<bool(const PPacket&)>()) const;
+protected:
+	struct Condition
+	{
+		uint32_t byteIndex = 0;
+		uint32_t byteCount = 1;
+		uint32_t shift = 0;
+		uint32_t mask = 0xFF;
+		uint32_t value = 0;
+
+		bool read(const std::vector<uint8_t>& data, uint32_t& result) const;
+		bool matches(const std::vector<uint8_t>& data) const;
+	};
+
+	struct Candidate
+	{
+		PPacket packet;
+		std::vector<Condition> conditions;
+		bool exact = true;
+	};
+
+	struct TypeNode
+	{
+		/**
+		 * "true" when all candidates with subtype use the same position, so candidates can be selected by the subtype value.
+		 */
+		bool subtypeIndexed = false;
+		Condition subtypePosition;
+
+		/**
+		 * Candidates by subtype. Each list also contains the candidates without subtype in the original order.
+		 */
+		std::unordered_map<uint32_t, std::vector<Candidate>> candidatesBySubtype;
+
+		/**
+		 * Candidates without subtype, or all candidates when "subtypeIndexed" is false.
+		 */
+		std::vector<Candidate> candidates;
+	};
+
+	std::unordered_map<int32_t, TypeNode> _types;
+
+	/**
+	 * Candidates with message type -1, which match all types.
+	 */
+	TypeNode _anyType;
+
+	static bool compilePosition(double index, double size, Condition& condition);
+	static void buildNode(const std::vector<Candidate>& candidates, TypeNode& node);
+	static PPacket find(const std::vector<Candidate>& candidates, const std::vector<uint8_t>& data, Packet::Direction::Enum direction, const std::function<bool(const PPacket&)>& verify);
+	static PPacket find(const TypeNode& node, const std::vector<uint8_t>& data, Packet::Direction::Enum direction, const std::function<bool(const PPacket&)>& verify);
+};
+
+}
+}
+
+#endif
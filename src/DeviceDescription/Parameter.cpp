@@ -295,17 +295,41 @@ void Parameter::parseXml(xml_node *node) {
   // }}}
 }
 
+size_t Parameter::getReversedDataSize() {
+  int32_t size = std::lround(std::ceil(physical->size));
+  if (size == 0) size = 1;
+  return size < 0 ? 0 : size;
+}
+
+int32_t Parameter::getIntegerValue(const std::vector<uint8_t> &data, bool littleEndian) {
+  //Same as "memcpyBigEndian()" on the data reversed by "reverseData()": The first four bytes of the big endian value are used.
+  if (!littleEndian) {
+    uint32_t size = data.size() > 4 ? 4 : data.size();
+    return (int32_t)BitReaderWriter::getPosition64(data.data(), data.size(), 0, size * 8);
+  }
+  size_t size = getReversedDataSize();
+  if (size > 4) size = 4;
+  uint32_t result = 0;
+  for (size_t i = 0; i < size; i++) {
+    result = (result << 8u) | (i < data.size() ? data[data.size() - 1 - i] : 0);
+  }
+  return (int32_t)result;
+}
+
 PVariable Parameter::convertFromPacket(const std::vector<uint8_t> &data, const Role &role, bool isEvent) {
   try {
+    //Integer values are read directly from "data". Little endian data is only copied when the value is needed as byte array.
+    bool littleEndian = (physical->endianess == IPhysical::Endianess::Enum::little);
     std::vector<uint8_t> reversedData;
-    const std::vector<uint8_t> *value = nullptr;
-    if (physical->endianess == IPhysical::Endianess::Enum::little) {
-      reverseData(data, reversedData);
-      value = &reversedData;
-    } else value = &data;
+    const std::vector<uint8_t> *value = &data;
+    auto getReversedValue = [&]() {
+      if (littleEndian && value == &data) {
+        reverseData(data, reversedData);
+        value = &reversedData;
+      }
+    };
     if (logical->type == ILogical::Type::Enum::tEnum && casts.empty()) {
-      int32_t integerValue = 0;
-      BaseLib::HelperFunctions::memcpyBigEndian(integerValue, *value);
+      int32_t integerValue = getIntegerValue(data, littleEndian);
       if (role.invert) {
         auto *parameter = (LogicalEnumeration *)logical.get();
         integerValue = parameter->minimumValue + ((parameter->maximumValue - parameter->minimumValue) - (integerValue - parameter->minimumValue));
@@ -313,10 +337,10 @@ PVariable Parameter::convertFromPacket(const std::vector<uint8_t> &data, const R
       if (role.scale) integerValue = std::lround(Math::scale((double)integerValue, role.scaleInfo.valueMin, role.scaleInfo.valueMax, role.scaleInfo.scaleMin, role.scaleInfo.scaleMax));
       return std::make_shared<Variable>(integerValue);
     } else if (logical->type == ILogical::Type::Enum::tBoolean && casts.empty()) {
-      int32_t integerValue = 0;
-      BaseLib::HelperFunctions::memcpyBigEndian(integerValue, *value);
+      int32_t integerValue = getIntegerValue(data, littleEndian);
       return std::make_shared<Variable>(role.invert == !(bool)integerValue);
     } else if (logical->type == ILogical::Type::Enum::tString && casts.empty()) {
+      getReversedValue();
       if (!value->empty() && value->at(0) != 0) {
         std::size_t size = 0;
         for (auto element: *value) {
@@ -330,27 +354,27 @@ PVariable Parameter::convertFromPacket(const std::vector<uint8_t> &data, const R
     } else if (logical->type == ILogical::Type::Enum::tAction) {
       return std::make_shared<Variable>(isEvent);
     } else if (id == "RSSI_DEVICE") {
-      int32_t integerValue = 0;
-      BaseLib::HelperFunctions::memcpyBigEndian(integerValue, *value);
+      int32_t integerValue = getIntegerValue(data, littleEndian);
       std::shared_ptr<Variable> variable(new Variable(integerValue * -1));
       return variable;
     } else {
       std::shared_ptr<Variable> variable;
+      size_t valueSize = littleEndian ? getReversedDataSize() : data.size();
       if (physical->type == IPhysical::Type::tString) {
+        getReversedValue();
         variable.reset(new Variable(VariableType::tString));
         variable->stringValue.insert(variable->stringValue.end(), value->begin(), value->end());
-      } else if (value->size() <= 4) {
-        int32_t integerValue = 0;
-        BaseLib::HelperFunctions::memcpyBigEndian(integerValue, *value);
-        variable.reset(new Variable(integerValue));
-        if (isSigned && !value->empty() && value->size() <= 4) {
+      } else if (valueSize <= 4) {
+        variable.reset(new Variable(getIntegerValue(data, littleEndian)));
+        if (isSigned && valueSize > 0) {
           int32_t byteSize = std::lround(std::ceil(physical->size));
-          if (byteSize > 0 && (signed)value->size() == byteSize) {
+          if (byteSize > 0 && (signed)valueSize == byteSize) {
             int32_t bitSize = std::lround(physical->size * 10) % 10;
             int32_t signPosition = 0;
             if (bitSize == 0) signPosition = 7;
             else signPosition = bitSize - 1;
-            if (value->at(0) & (1 << signPosition)) {
+            uint8_t mostSignificantByte = littleEndian ? (data.empty() ? 0 : data.back()) : data.front();
+            if (mostSignificantByte & (1 << signPosition)) {
               int32_t bits = (std::lround(std::floor(physical->size)) * 8) + bitSize;
               variable->integerValue -= (1 << bits);
             }
@@ -359,9 +383,15 @@ PVariable Parameter::convertFromPacket(const std::vector<uint8_t> &data, const R
       }
       if (!variable) variable.reset(new Variable(VariableType::tBinary));
 
-      for (auto i = casts.rbegin(); i != casts.rend(); ++i) {
-        if ((*i)->needsBinaryPacketData() && variable->binaryValue.empty()) variable->binaryValue = *value;
-        (*i)->fromPacket(variable);
+      if (_fromPacketProgram && _compiledCasts == casts) _fromPacketProgram->run(*variable);
+      else {
+        for (auto i = casts.rbegin(); i != casts.rend(); ++i) {
+          if ((*i)->needsBinaryPacketData() && variable->binaryValue.empty()) {
+            getReversedValue();
+            variable->binaryValue = *value;
+          }
+          (*i)->fromPacket(variable);
+        }
       }
 
       //{{{ Control boundaries and invert value
@@ -538,6 +568,8 @@ void Parameter::convertToPacket(const PVariable &value, const Role &role, std::v
           if (!variable->stringValue.empty() && variable->stringValue == "true") variable->integerValue = 1;
           else variable->integerValue = (int32_t)variable->booleanValue;
         }
+      } else if (_toPacketProgram && _compiledCasts == casts) {
+        _toPacketProgram->run(*variable);
       } else {
         for (auto &cast: casts) {
           cast->toPacket(variable);
@@ -598,6 +630,25 @@ void Parameter::reverseData(const std::vector<uint8_t> &data, std::vector<uint8_
   }
 }
 
+void Parameter::compileCasts() {
+  try {
+    invalidateCompiledCasts();
+    if (casts.empty()) return;
+    _compiledCasts = casts;
+    _fromPacketProgram = CastProgram::compile(casts, logical, false);
+    _toPacketProgram = CastProgram::compile(casts, logical, true);
+  }
+  catch (const std::exception &ex) {
+    _bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void Parameter::invalidateCompiledCasts() {
+  _fromPacketProgram.reset();
+  _toPacketProgram.reset();
+  _compiledCasts.clear();
+}
+
 void Parameter::adjustBitPosition(std::vector<uint8_t> &data) {
   try {
     if (data.size() > 4 || data.empty() || logical->type == ILogical::Type::Enum::tString) return;
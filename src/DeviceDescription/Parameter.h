@@ -34,6 +34,7 @@
 #include <cstdint>
 
 #include "ParameterCast.h"
+#include "CastProgram.h"
 #include "Logical.h"
 #include "Physical.h"
 #include "../Systems/Role.h"
@@ -188,6 +189,19 @@ class Parameter : public std::enable_shared_from_this<Parameter> {
    */
   void convertToPacket(const std::string &value, const Role &role, std::vector<uint8_t> &convertedValue);
 
+  /**
+   * Compiles "casts" into flattened conversion programs used by "convertFromPacket()" and "convertToPacket()". Casts that can't be compiled are
+   * still executed one by one. This method is not thread safe and needs to be called after all casts are set and before the parameter is used,
+   * e. g. directly after the device description is loaded.
+   */
+  void compileCasts();
+
+  /**
+   * Discards the compiled programs, so the casts are executed one by one again. The programs contain copies of the cast settings, so this method (or
+   * "compileCasts()") needs to be called whenever a cast in "casts" is added, removed, replaced or modified. This method is not thread safe.
+   */
+  void invalidateCompiledCasts();
+
   void adjustBitPosition(std::vector<uint8_t> &data);
 
   PParameterGroup parent();
@@ -196,6 +210,14 @@ class Parameter : public std::enable_shared_from_this<Parameter> {
 
   //Helpers
   std::weak_ptr<ParameterGroup> _parent;
+  PCastProgram _fromPacketProgram;
+  PCastProgram _toPacketProgram;
+
+  /**
+   * The casts the programs were compiled for. Catches casts added, removed or replaced without calling "invalidateCompiledCasts()". Changes to the
+   * settings of a cast can't be detected this way.
+   */
+  Casts _compiledCasts;
 
   /**
    * Reverses a binary array.
@@ -204,6 +226,17 @@ class Parameter : public std::enable_shared_from_this<Parameter> {
    * @param[out] reversedData The reversed array.
    */
   void reverseData(const std::vector<uint8_t> &data, std::vector<uint8_t> &reversedData);
+
+  /**
+   * Returns the size of the array returned by "reverseData()".
+   */
+  size_t getReversedDataSize();
+
+  /**
+   * Returns the integer value of packet data without copying it. The result is the same as calling "HelperFunctions::memcpyBigEndian()" on
+   * the data or, for little endian parameters, on the data returned by "reverseData()".
+   */
+  int32_t getIntegerValue(const std::vector<uint8_t> &data, bool littleEndian);
 };
 
 }
@@ -30,6 +30,7 @@
 
 #include "BitReaderWriter.h"
 #include <iostream>
+#include <cstring>
 #include "../HelperFunctions/HelperFunctions.h"
 
 namespace BaseLib
@@ -40,254 +41,158 @@ const uint8_t BitReaderWriter::_bitMaskSetSource[9] = { 0xFF, 0x01, 0x03, 0x07,
 const uint8_t BitReaderWriter::_bitMaskSetTargetStart[8] = { 0x00, 0x80, 0xC0, 0xE0, 0xF0, 0xF8, 0xFC, 0xFE };
 const uint8_t BitReaderWriter::_bitMaskSetTargetEnd[8] = { 0x00, 0x7F, 0x3F, 0x1F, 0x0F, 0x07, 0x03, 0x01 };
 
-std::vector<uint8_t> BitReaderWriter::getPosition(const std::vector<uint8_t>& data, uint32_t position, uint32_t size)
+namespace
 {
-	std::vector<uint8_t> result;
-	if(size == 0) return result;
 
-	uint32_t bytePosition = position / 8;
-	uint32_t bitPosition = position & 7; // & 7 == % 8
-	uint32_t relativeEndPosition = bitPosition + size;
-	uint32_t sourceByteSize = relativeEndPosition / 8 + ((relativeEndPosition & 7) != 0 ? 1 : 0);
-	uint32_t targetByteSize = size / 8 + ((size & 7) != 0 ? 1 : 0);
-	result.resize(targetByteSize, 0);
+/**
+ * Loads 8 bytes as big endian integer. Missing bytes at the end of the buffer are read as 0.
+ */
+inline uint64_t loadBigEndian64(const uint8_t* data, size_t available)
+{
+	uint64_t word = 0;
+	if(available >= 8) std::memcpy(&word, data, 8);
+	else std::memcpy(&word, data, available);
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	word = __builtin_bswap64(word);
+#endif
+	return word;
+}
 
-	if(bytePosition >= data.size()) return result;
+/**
+ * Stores a big endian integer. Only "available" bytes are written.
+ */
+inline void storeBigEndian64(uint8_t* data, size_t available, uint64_t word)
+{
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+	word = __builtin_bswap64(word);
+#endif
+	std::memcpy(data, &word, available >= 8 ? 8 : available);
+}
 
-	uint8_t firstByte = data.at(bytePosition) & _bitMaskGet[bitPosition];
-	if(sourceByteSize == 1)
-	{
-		result.at(0) = firstByte >> (8 - relativeEndPosition);
-		return result;
-	}
+}
 
-	uint32_t targetBytePosition = 0;
-	uint32_t endSourceByte = bytePosition + sourceByteSize - 1;
+uint64_t BitReaderWriter::getPosition64(const uint8_t* data, size_t dataSize, uint32_t position, uint32_t size)
+{
+	if(size > 64) size = 64;
+	else if(size == 0) return 0;
 
-	int32_t rightShiftCount = 8 - (size & 7) - bitPosition;
-	bool leftShiftFirst = ((size & 7) == 0 || (rightShiftCount & 0x80000000));
-	int32_t leftShiftCount = 0;
-	if(rightShiftCount & 0x80000000) // < 0
-	{
-		leftShiftCount = rightShiftCount * -1;
-		rightShiftCount = 8 - leftShiftCount;
-	}
-	else leftShiftCount = 8 - rightShiftCount;
-	if(rightShiftCount == 8) rightShiftCount = 0;
-	if(leftShiftFirst)
-	{
-		result.at(targetBytePosition) = firstByte << leftShiftCount;
-		if(leftShiftCount == 0) targetBytePosition++;
-	}
-	else
-	{
-		result.at(targetBytePosition) = firstByte >> rightShiftCount;
-		targetBytePosition++;
-		result.at(targetBytePosition) = firstByte << leftShiftCount;
-	}
+	uint32_t bytePosition = position / 8;
+	uint32_t bitPosition = position & 7;
+	if(bytePosition >= dataSize) return 0;
 
-	for(uint32_t i = bytePosition + 1; i < endSourceByte; i++)
-	{
-		if(i >= data.size()) return result;
-		result.at(targetBytePosition) |= data.at(i) >> rightShiftCount;
-		targetBytePosition++;
-		if(leftShiftCount > 0) result.at(targetBytePosition) = data.at(i) << leftShiftCount;
-	}
+	uint64_t word = loadBigEndian64(data + bytePosition, dataSize - bytePosition);
+	if(bitPosition + size <= 64) return (word << bitPosition) >> (64 - size);
 
-	if(endSourceByte >= data.size()) return result;
-	result.at(targetBytePosition) |= data.at(endSourceByte) >> rightShiftCount;
-	return result;
+	//More than 57 bits not starting at a byte boundary span 9 bytes.
+	uint8_t nextByte = bytePosition + 8 < dataSize ? data[bytePosition + 8] : 0;
+	word = (word << bitPosition) | (nextByte >> (8 - bitPosition));
+	return word >> (64 - size);
 }
 
-std::vector<uint8_t> BitReaderWriter::getPosition(const std::vector<char>& data, uint32_t position, uint32_t size)
+void BitReaderWriter::getPosition(const uint8_t* data, size_t dataSize, uint32_t position, uint32_t size, std::vector<uint8_t>& result)
 {
-	std::vector<uint8_t> result;
-	if(size == 0) return result;
-
-	uint32_t bytePosition = position / 8;
-	uint32_t bitPosition = position & 7; // & 7 == % 8
-	uint32_t relativeEndPosition = bitPosition + size;
-	uint32_t sourceByteSize = relativeEndPosition / 8 + ((relativeEndPosition & 7) != 0 ? 1 : 0);
 	uint32_t targetByteSize = size / 8 + ((size & 7) != 0 ? 1 : 0);
-	result.resize(targetByteSize, 0);
-
-	if(bytePosition >= data.size()) return result;
-
-	uint8_t firstByte = (uint8_t)data.at(bytePosition) & _bitMaskGet[bitPosition];
-	if(sourceByteSize == 1)
+	result.assign(targetByteSize, 0);
+	if(size == 0 || position / 8 >= dataSize) return;
+
+	//Read from the end in chunks of 7 bytes, so every chunk but the first one fills whole bytes of the right aligned result.
+	uint32_t endPosition = position + size;
+	uint32_t bitsLeft = size;
+	uint32_t resultIndex = targetByteSize;
+	while(bitsLeft > 0)
 	{
-		result.at(0) = firstByte >> (8 - relativeEndPosition);
-		return result;
+		uint32_t chunkSize = bitsLeft > 56 ? 56 : bitsLeft;
+		uint64_t chunk = getPosition64(data, dataSize, endPosition - chunkSize, chunkSize);
+		for(uint32_t i = 0; i < chunkSize; i += 8)
+		{
+			resultIndex--;
+			result[resultIndex] = (uint8_t)chunk;
+			chunk >>= 8;
+		}
+		endPosition -= chunkSize;
+		bitsLeft -= chunkSize;
 	}
+}
 
-	uint32_t targetBytePosition = 0;
-	uint32_t endSourceByte = bytePosition + sourceByteSize - 1;
-
-	int32_t rightShiftCount = 8 - (size & 7) - bitPosition;
-	bool leftShiftFirst = ((size & 7) == 0 || rightShiftCount < 0);
-	int32_t leftShiftCount = 0;
-	if(rightShiftCount & 0x80000000) // < 0
-	{
-		leftShiftCount = rightShiftCount * -1;
-		rightShiftCount = 8 - leftShiftCount;
-	}
-	else leftShiftCount = 8 - rightShiftCount;
-	if(rightShiftCount == 8) rightShiftCount = 0;
-	if(leftShiftFirst)
-	{
-		result.at(targetBytePosition) = firstByte << leftShiftCount;
-		if(leftShiftCount == 0) targetBytePosition++;
-	}
-	else
-	{
-		result.at(targetBytePosition) = firstByte >> rightShiftCount;
-		targetBytePosition++;
-		result.at(targetBytePosition) = firstByte << leftShiftCount;
-	}
+void BitReaderWriter::getPosition(const std::vector<uint8_t>& data, uint32_t position, uint32_t size, std::vector<uint8_t>& result)
+{
+	getPosition(data.data(), data.size(), position, size, result);
+}
 
-	for(uint32_t i = bytePosition + 1; i < endSourceByte; i++)
-	{
-		if(i >= data.size()) return result;
-		result.at(targetBytePosition) |= (uint8_t)data.at(i) >> rightShiftCount;
-		targetBytePosition++;
-		if(leftShiftCount > 0) result.at(targetBytePosition) = (uint8_t)data.at(i) << leftShiftCount;
-	}
+std::vector<uint8_t> BitReaderWriter::getPosition(const std::vector<uint8_t>& data, uint32_t position, uint32_t size)
+{
+	std::vector<uint8_t> result;
+	getPosition(data.data(), data.size(), position, size, result);
+	return result;
+}
 
-	if(endSourceByte >= data.size()) return result;
-	result.at(targetBytePosition) |= (uint8_t)data.at(endSourceByte) >> rightShiftCount;
+std::vector<uint8_t> BitReaderWriter::getPosition(const std::vector<char>& data, uint32_t position, uint32_t size)
+{
+	std::vector<uint8_t> result;
+	getPosition((const uint8_t*)data.data(), data.size(), position, size, result);
 	return result;
 }
 
 uint8_t BitReaderWriter::getPosition8(const std::vector<uint8_t>& data, uint32_t position, uint32_t size)
 {
 	if(size > 8) size = 8;
-	else if(size == 0) return 0;
-	uint8_t result = 0;
-
-	uint32_t bytePosition = position / 8;
-	int32_t bitPosition = position % 8;
-	int32_t sourceByteSize = (bitPosition + size) / 8 + ((bitPosition + size) % 8 != 0 ? 1 : 0);
-
-	if(bytePosition >= data.size()) return 0;
-
-	uint8_t firstByte = data.at(bytePosition) & _bitMaskGet[bitPosition];
-	if(sourceByteSize == 1)
-	{
-		result = firstByte >> ((8 - ((bitPosition + size) % 8)) % 8);
-		return result;
-	}
-
-	result |= (uint16_t)firstByte << (size - (8 - bitPosition));
-
-	if(bytePosition + 1 >= data.size()) return result;
-	result |= data.at(bytePosition + 1) >> ((8 - ((bitPosition + size) % 8)) % 8);
-	return result;
+	return (uint8_t)getPosition64(data.data(), data.size(), position, size);
 }
 
 uint16_t BitReaderWriter::getPosition16(const std::vector<uint8_t>& data, uint32_t position, uint32_t size)
 {
 	if(size > 16) size = 16;
-	else if(size == 0) return 0;
-	uint16_t result = 0;
-
-	uint32_t bytePosition = position / 8;
-	int32_t bitPosition = position % 8;
-	int32_t sourceByteSize = (bitPosition + size) / 8 + ((bitPosition + size) % 8 != 0 ? 1 : 0);
-
-	if(bytePosition >= data.size()) return 0;
-
-	uint8_t firstByte = data.at(bytePosition) & _bitMaskGet[bitPosition];
-	if(sourceByteSize == 1)
-	{
-		result = firstByte >> ((8 - ((bitPosition + size) % 8)) % 8);
-		return result;
-	}
-
-	int32_t bitsLeft = size - (8 - bitPosition);
-	result |= (uint16_t)firstByte << bitsLeft;
-	bitsLeft -= 8;
-
-	for(uint32_t i = bytePosition + 1; i < bytePosition + sourceByteSize - 1; i++)
-	{
-		if(i >= data.size()) return result;
-		result |= (uint16_t)data.at(i) << bitsLeft;
-		bitsLeft -= 8;
-	}
-
-	if(bytePosition + sourceByteSize - 1 >= data.size()) return result;
-	result |= data.at(bytePosition + sourceByteSize - 1) >> ((8 - ((bitPosition + size) % 8)) % 8);
-
-	return result;
+	return (uint16_t)getPosition64(data.data(), data.size(), position, size);
 }
 
 uint32_t BitReaderWriter::getPosition32(const std::vector<uint8_t>& data, uint32_t position, uint32_t size)
 {
 	if(size > 32) size = 32;
-	else if(size == 0) return 0;
-	uint32_t result = 0;
-
-	uint32_t bytePosition = position / 8;
-	int32_t bitPosition = position % 8;
-	int32_t sourceByteSize = (bitPosition + size) / 8 + ((bitPosition + size) % 8 != 0 ? 1 : 0);
-
-	if(bytePosition >= data.size()) return 0;
-
-	uint8_t firstByte = data.at(bytePosition) & _bitMaskGet[bitPosition];
-	if(sourceByteSize == 1)
-	{
-		result = firstByte >> ((8 - ((bitPosition + size) % 8)) % 8);
-		return result;
-	}
-
-	int32_t bitsLeft = size - (8 - bitPosition);
-	result |= (uint32_t)firstByte << bitsLeft;
-	bitsLeft -= 8;
-
-	for(uint32_t i = bytePosition + 1; i < bytePosition + sourceByteSize - 1; i++)
-	{
-		if(i >= data.size()) return result;
-		result |= (uint32_t)data.at(i) << bitsLeft;
-		bitsLeft -= 8;
-	}
-
-	if(bytePosition + sourceByteSize - 1 >= data.size()) return result;
-	result |= data.at(bytePosition + sourceByteSize - 1) >> ((8 - ((bitPosition + size) % 8)) % 8);
-	return result;
+	return (uint32_t)getPosition64(data.data(), data.size(), position, size);
 }
 
 uint64_t BitReaderWriter::getPosition64(const std::vector<uint8_t>& data, uint32_t position, uint32_t size)
 {
-	if(size > 64) size = 64;
-	else if(size == 0) return 0;
-	uint64_t result = 0;
+	return getPosition64(data.data(), data.size(), position, size);
+}
 
+void BitReaderWriter::setPosition(uint32_t position, uint32_t size, uint8_t* target, size_t targetSize, uint64_t value)
+{
 	uint32_t bytePosition = position / 8;
-	int32_t bitPosition = position % 8;
-	int32_t sourceByteSize = (bitPosition + size) / 8 + ((bitPosition + size) % 8 != 0 ? 1 : 0);
-
-	if(bytePosition >= data.size()) return 0;
-
-	uint8_t firstByte = data.at(bytePosition) & _bitMaskGet[bitPosition];
-	if(sourceByteSize == 1)
+	uint32_t bitPosition = position & 7;
+	if(bitPosition + size > 64)
 	{
-		result = firstByte >> ((8 - ((bitPosition + size) % 8)) % 8);
-		return result;
+		//Split fields spanning 9 bytes
+		setPosition(position, size - 32, target, targetSize, value >> 32u);
+		setPosition(position + size - 32, 32, target, targetSize, value & 0xFFFFFFFFu);
+		return;
 	}
 
-	int32_t bitsLeft = size - (8 - bitPosition);
-	result |= (uint64_t)firstByte << bitsLeft;
-	bitsLeft -= 8;
+	uint64_t mask = size == 64 ? 0xFFFFFFFFFFFFFFFFull : (1ull << size) - 1;
+	uint32_t shift = 64 - bitPosition - size;
+	uint64_t word = loadBigEndian64(target + bytePosition, targetSize - bytePosition);
+	word = (word & ~(mask << shift)) | ((value & mask) << shift);
+	storeBigEndian64(target + bytePosition, targetSize - bytePosition, word);
+}
 
-	for(uint32_t i = bytePosition + 1; i < bytePosition + sourceByteSize - 1; i++)
-	{
-		if(i >= data.size()) return result;
-		result |= (uint64_t)data.at(i) << bitsLeft;
-		bitsLeft -= 8;
-	}
+void BitReaderWriter::setPosition(uint32_t position, uint32_t size, std::vector<uint8_t>& target, uint64_t value)
+{
+	if(size == 0) return;
+	if(size > 64) size = 64;
+	uint32_t relativeEndPosition = (position & 7) + size;
+	uint32_t requiredSize = position / 8 + relativeEndPosition / 8 + ((relativeEndPosition & 7) != 0 ? 1 : 0);
+	if(target.size() < requiredSize) target.resize(requiredSize, 0);
+	setPosition(position, size, target.data(), target.size(), value);
+}
 
-	if(bytePosition + sourceByteSize - 1 >= data.size()) return result;
-	result |= data.at(bytePosition + sourceByteSize - 1) >> ((8 - ((bitPosition + size) % 8)) % 8);
-	return result;
+void BitReaderWriter::setPosition(uint32_t position, uint32_t size, std::vector<char>& target, uint64_t value)
+{
+	if(size == 0) return;
+	if(size > 64) size = 64;
+	uint32_t relativeEndPosition = (position & 7) + size;
+	uint32_t requiredSize = position / 8 + relativeEndPosition / 8 + ((relativeEndPosition & 7) != 0 ? 1 : 0);
+	if(target.size() < requiredSize) target.resize(requiredSize, 0);
+	setPosition(position, size, (uint8_t*)target.data(), target.size(), value);
 }
 
 void BitReaderWriter::setPositionLE(uint32_t position, uint32_t size, std::vector<uint8_t>& target, const std::vector<uint8_t>& source)
@@ -32,6 +32,7 @@
 #define BITREADERWRITER_H_
 
 #include <vector>
+#include <cstddef>
 #include <cstdint>
 
 namespace BaseLib
@@ -102,6 +103,45 @@ public:
 	 */
 	static uint64_t getPosition64(const std::vector<uint8_t>& data, uint32_t position, uint32_t size);
 
+	/**
+	 * Reads up to 64 bits at any position from a byte buffer and returns it as an uint64_t. This method doesn't allocate memory. Fields of up to 57
+	 * bits are read with a single 64 bit load.
+	 *
+	 * @param data The byte buffer to read from. Index 0 must be the most significant byte.
+	 * @param dataSize The size of the buffer in bytes. It is ok for position + size to exceed it.
+	 * @param position The position in bits starting with bit 7 of index 0.
+	 * @param size The size in bits of the data to read.
+	 * @return The data is returned right aligned.
+	 */
+	static uint64_t getPosition64(const uint8_t* data, size_t dataSize, uint32_t position, uint32_t size);
+
+	/**
+	 * Reads any number of bits at any position from a byte array into a caller provided buffer. The buffer's memory is reused, so no memory is
+	 * allocated when it is large enough.
+	 *
+	 * @param data The byte array to read from. Index 0 must be the most significant byte.
+	 * @param position The position in bits starting with bit 7 of index 0.
+	 * @param size The size in bits of the data to read.
+	 * @param[out] result The data right aligned.
+	 */
+	static void getPosition(const std::vector<uint8_t>& data, uint32_t position, uint32_t size, std::vector<uint8_t>& result);
+
+	/**
+	 * Sets up to 64 bits at any position in a byte array. This is the same as "setPositionBE()" with the big endian bytes of "value" as source,
+	 * but doesn't allocate memory unless target needs to grow.
+	 *
+	 * @param position The position in bits starting with bit 7 of index 0.
+	 * @param size The size in bits of the data to set.
+	 * @param target The byte array to write to. Index 0 is the most significant byte.
+	 * @param value The value to set. Only the lowest "size" bits are used.
+	 */
+	static void setPosition(uint32_t position, uint32_t size, std::vector<uint8_t>& target, uint64_t value);
+
+	/**
+	 * @see setPosition(uint32_t, uint32_t, std::vector<uint8_t>&, uint64_t)
+	 */
+	static void setPosition(uint32_t position, uint32_t size, std::vector<char>& target, uint64_t value);
+
 	/**
 	 * Sets any number of bits at any position in a byte array. The source bytes are read LSB first (i. e. least significant byte at the smallest index). For example 0xABCD in source becomes 0xCDAB in target.
 	 *
@@ -147,6 +187,9 @@ private:
 	static const uint8_t _bitMaskSetTargetStart[8];
 	static const uint8_t _bitMaskSetTargetEnd[8];
 
+	static void getPosition(const uint8_t* data, size_t dataSize, uint32_t position, uint32_t size, std::vector<uint8_t>& result);
+	static void setPosition(uint32_t position, uint32_t size, uint8_t* target, size_t targetSize, uint64_t value);
+
 	BitReaderWriter();
 };
 
@@ -416,8 +416,10 @@ int32_t Http::process(char *buffer, int32_t bufferLength, bool checkForChunkedXm
         if (BaseLib::Math::isNumber(BaseLib::HelperFunctions::trim(chunk), true)) _header.transferEncoding = BaseLib::Http::TransferEncoding::chunked;
       }
     }
-    if (_header.contentLength > _maxContentSize) throw HttpException("Data is larger than " + std::to_string(_maxContentSize) + " bytes.");
-    _content.reserve(_header.contentLength);
+    if (!_contentCallback) {
+      if (_header.contentLength > _maxContentSize) throw HttpException("Data is larger than " + std::to_string(_maxContentSize) + " bytes.");
+      _content.reserve(_header.contentLength);
+    }
   }
   _dataProcessingStarted = true;
 
@@ -657,6 +659,8 @@ void Http::reset() {
   _rawHeader.shrink_to_fit();
   _chunk.shrink_to_fit();
   _chunkNewLineMissing = false;
+  _streamedContentSize = 0;
+  _streamedChunkSize = 0;
   _type = Type::Enum::none;
   _finished = false;
   _dataProcessingStarted = false;
@@ -666,13 +670,20 @@ void Http::reset() {
 void Http::setFinished() {
   if (_finished) return;
   _finished = true;
-  _content.push_back('\0');
+  //Streamed content isn't stored, so there is nothing to terminate.
+  if (!_contentCallback) _content.push_back('\0');
 }
 
 int32_t Http::processContent(char *buffer, int32_t bufferLength) {
-  if (_content.size() + bufferLength > _maxContentSize) throw HttpException("Data is larger than " + std::to_string(_maxContentSize) + " bytes.");
+  if (!_contentCallback && _content.size() + bufferLength > _maxContentSize) throw HttpException("Data is larger than " + std::to_string(_maxContentSize) + " bytes.");
   int32_t processedBytes = bufferLength;
-  if (_header.contentLength == 0) {
+  if (_contentCallback) {
+    //Without "Content-Length" the content ends when the connection is closed.
+    if (_header.contentLength != 0 && _streamedContentSize + bufferLength > _header.contentLength) processedBytes = _header.contentLength - _streamedContentSize;
+    _contentCallback(buffer, processedBytes);
+    _streamedContentSize += processedBytes;
+    if (_header.contentLength != 0 && _streamedContentSize == _header.contentLength) setFinished();
+  } else if (_header.contentLength == 0) {
     _content.insert(_content.end(), buffer, buffer + bufferLength);
     if (_header.contentType == "application/json") {
       bool finished = true;
@@ -706,7 +717,7 @@ int32_t Http::processContent(char *buffer, int32_t bufferLength) {
 int32_t Http::processChunkedContent(char *buffer, int32_t bufferLength) {
   int32_t initialBufferLength = bufferLength;
   while (true) {
-    if (_content.size() + bufferLength > _maxContentSize) throw HttpException("Data is larger than " + std::to_string(_maxContentSize) + " bytes.");
+    if (!_contentCallback && _content.size() + bufferLength > _maxContentSize) throw HttpException("Data is larger than " + std::to_string(_maxContentSize) + " bytes.");
     if (_chunkSize == -1) {
       if (_chunkNewLineMissing) {
         _chunkNewLineMissing = false;
@@ -728,12 +739,24 @@ int32_t Http::processChunkedContent(char *buffer, int32_t bufferLength) {
       }
       if (bufferLength <= 0) break;
       int32_t sizeToInsert = bufferLength;
-      if ((signed)_chunk.size() + sizeToInsert > _chunkSize) sizeToInsert -= (_chunk.size() + sizeToInsert) - _chunkSize;
-      _chunk.insert(_chunk.end(), buffer, buffer + sizeToInsert);
-      if ((signed)_chunk.size() == _chunkSize) {
-        _content.insert(_content.end(), _chunk.begin(), _chunk.end());
-        _chunk.clear();
-        _chunkSize = -1;
+      if (_contentCallback) {
+        //Pass on the data directly instead of collecting the whole chunk.
+        if (_streamedChunkSize + sizeToInsert > _chunkSize) sizeToInsert = _chunkSize - _streamedChunkSize;
+        _contentCallback(buffer, sizeToInsert);
+        _streamedContentSize += sizeToInsert;
+        _streamedChunkSize += sizeToInsert;
+        if (_streamedChunkSize == _chunkSize) {
+          _streamedChunkSize = 0;
+          _chunkSize = -1;
+        }
+      } else {
+        if ((signed)_chunk.size() + sizeToInsert > _chunkSize) sizeToInsert -= (_chunk.size() + sizeToInsert) - _chunkSize;
+        _chunk.insert(_chunk.end(), buffer, buffer + sizeToInsert);
+        if ((signed)_chunk.size() == _chunkSize) {
+          _content.insert(_content.end(), _chunk.begin(), _chunk.end());
+          _chunk.clear();
+          _chunkSize = -1;
+        }
       }
       bufferLength -= _crlf ? sizeToInsert + 2 : sizeToInsert + 1;
       if (bufferLength < 0) {
@@ -853,6 +876,7 @@ size_t Http::readStream(char *buffer, size_t requestLength) {
 }
 
 size_t Http::readContentStream(char *buffer, size_t requestLength) {
+  if (_content.empty()) return 0;
   size_t bytesRead = 0;
   size_t contentSize = _content.size() - 1; //Ignore trailing "0"
   if (_contentStreamPos < contentSize) {
@@ -40,6 +40,7 @@
 #include <string>
 #include <map>
 #include <cstring>
+#include <functional>
 #include <memory>
 #include <vector>
 #include <set>
@@ -111,6 +112,11 @@ class Http {
     std::set<std::shared_ptr<FormData>> multipartMixed;
   };
 
+  /**
+   * Receives the decoded content (without chunk framing) while it is processed.
+   */
+  typedef std::function<void(const char *data, size_t size)> ContentCallback;
+
   Http();
   virtual ~Http();
 
@@ -128,6 +134,18 @@ class Http {
   size_t getMaxContentSize() { return _maxContentSize; }
   void setMaxContentSize(size_t value) { _maxContentSize = value; }
 
+  /**
+   * When set, the content is passed to "callback" as it arrives instead of being stored, so the memory usage doesn't depend on the content size.
+   * getContent() stays empty and the maximum content size is not checked. The callback is kept on reset().
+   */
+  void setContentCallback(ContentCallback callback) { _contentCallback = std::move(callback); }
+  bool hasContentCallback() const { return (bool)_contentCallback; }
+
+  /**
+   * Returns the number of content bytes passed to the content callback.
+   */
+  size_t getStreamedContentSize() const { return _streamedContentSize; }
+
   /**
    * This method sets _finished and terminates _content with a null character. Use it, when the header does not contain "Content-Length".
    *
@@ -198,6 +216,9 @@ class Http {
   int32_t _redirectStatus = -1;
   size_t _maxHeaderSize = 102400;
   size_t _maxContentSize = 104857600;
+  ContentCallback _contentCallback;
+  size_t _streamedContentSize = 0;
+  int32_t _streamedChunkSize = 0;
 
   int32_t processHeader(char **buffer, int32_t &bufferLength);
   void processHeaderField(char *name, uint32_t nameSize, char *value, uint32_t valueSize);
@@ -31,6 +31,10 @@
 #include "SerialDeviceManager.h"
 #include "../BaseLib.h"
 
+#include <array>
+
+#include <sys/epoll.h>
+
 namespace BaseLib
 {
 
@@ -43,6 +47,18 @@ void SerialDeviceManager::init(BaseLib::SharedObjects* baseLib)
 	_bl = baseLib;
 }
 
+void SerialDeviceManager::dispose()
+{
+	std::lock_guard<std::mutex> eventLoopThreadGuard(_eventLoopThreadMutex);
+	_stopEventLoop = true;
+	if(_bl) _bl->threadManager.join(_eventLoopThread);
+	if(_epollDescriptor != -1)
+	{
+		close(_epollDescriptor);
+		_epollDescriptor = -1;
+	}
+}
+
 void SerialDeviceManager::add(const std::string& device, std::shared_ptr<SerialReaderWriter> readerWriter)
 {
 	try
@@ -101,4 +117,97 @@ void SerialDeviceManager::remove(const std::string& device)
 	}
 	_devicesMutex.unlock();
 }
+
+bool SerialDeviceManager::addToEventLoop(SerialReaderWriter* readerWriter)
+{
+	try
+	{
+		if(!readerWriter || !readerWriter->isOpen()) return false;
+
+		{
+			std::lock_guard<std::mutex> eventLoopThreadGuard(_eventLoopThreadMutex);
+			if(_stopEventLoop) return false;
+			if(_epollDescriptor == -1)
+			{
+				_epollDescriptor = epoll_create1(EPOLL_CLOEXEC);
+				if(_epollDescriptor == -1)
+				{
+					_bl->out.printError("Error: Could not create epoll descriptor for serial devices: " + std::string(strerror(errno)));
+					return false;
+				}
+			}
+			if(!_eventLoopThread.joinable() && !_bl->threadManager.start(_eventLoopThread, true, &SerialDeviceManager::eventLoop, this)) return false;
+		}
+
+		int32_t descriptor = readerWriter->fileDescriptor()->descriptor;
+		std::lock_guard<std::recursive_mutex> eventLoopGuard(_eventLoopMutex);
+		_eventLoopDevices[descriptor] = readerWriter;
+		struct epoll_event event{};
+		event.events = EPOLLIN;
+		event.data.fd = descriptor;
+		if(epoll_ctl(_epollDescriptor, EPOLL_CTL_ADD, descriptor, &event) == -1)
+		{
+			_eventLoopDevices.erase(descriptor);
+			_bl->out.printError("Error: Could not add serial device to event loop: " + std::string(strerror(errno)));
+			return false;
+		}
+		return true;
+	}
+	catch(const std::exception& ex)
+	{
+		_bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+	return false;
+}
+
+void SerialDeviceManager::removeFromEventLoop(SerialReaderWriter* readerWriter)
+{
+	try
+	{
+		std::lock_guard<std::recursive_mutex> eventLoopGuard(_eventLoopMutex);
+		for(auto i = _eventLoopDevices.begin(); i != _eventLoopDevices.end(); ++i)
+		{
+			if(i->second != readerWriter) continue;
+			if(_epollDescriptor != -1) epoll_ctl(_epollDescriptor, EPOLL_CTL_DEL, i->first, nullptr);
+			_eventLoopDevices.erase(i);
+			break;
+		}
+	}
+	catch(const std::exception& ex)
+	{
+		_bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+	}
+}
+
+void SerialDeviceManager::eventLoop()
+{
+	std::array<struct epoll_event, 16> events{};
+	while(!_stopEventLoop)
+	{
+		try
+		{
+			int eventCount = epoll_wait(_epollDescriptor, events.data(), events.size(), 100);
+			if(eventCount == -1)
+			{
+				if(errno == EINTR) continue;
+				_bl->out.printError("Error: epoll_wait failed for serial devices: " + std::string(strerror(errno)));
+				std::this_thread::sleep_for(std::chrono::milliseconds(100));
+				continue;
+			}
+
+			for(int i = 0; i < eventCount; i++)
+			{
+				//Look the device up again for every event, as it might have been removed while handling a previous event.
+				std::lock_guard<std::recursive_mutex> eventLoopGuard(_eventLoopMutex);
+				auto deviceIterator = _eventLoopDevices.find(events[i].data.fd);
+				if(deviceIterator == _eventLoopDevices.end()) continue;
+				deviceIterator->second->handleReadable();
+			}
+		}
+		catch(const std::exception& ex)
+		{
+			_bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+		}
+	}
+}
 }
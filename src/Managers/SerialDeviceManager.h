@@ -39,6 +39,8 @@
 #include <string>
 #include <map>
 #include <mutex>
+#include <thread>
+#include <atomic>
 
 namespace BaseLib
 {
@@ -46,7 +48,8 @@ namespace BaseLib
 class SharedObjects;
 
 /*
- * This class is used, when a device needs to be accessible from different modules.
+ * This class is used, when a device needs to be accessible from different modules. It also provides an event loop, which services all devices with
+ * "SerialReaderWriter::setUseSharedReadThread()" enabled using one thread.
  */
 class SerialDeviceManager
 {
@@ -59,10 +62,39 @@ public:
 	virtual std::shared_ptr<SerialReaderWriter> create(std::string device, int32_t baudrate, int32_t flags, bool createLockFile, int32_t readThreadPriority);
 	virtual std::shared_ptr<SerialReaderWriter> get(const std::string& device);
 	virtual void remove(const std::string& device);
+
+	/**
+	 * Stops the event loop. Called by SharedObjects on destruction.
+	 */
+	void dispose();
+
+	/**
+	 * Adds an open device to the event loop. The event loop thread is started on first use. Called by "SerialReaderWriter::openDevice()".
+	 *
+	 * @return Returns true on success.
+	 */
+	bool addToEventLoop(SerialReaderWriter* readerWriter);
+
+	/**
+	 * Removes a device from the event loop. When this method returns, the event loop doesn't access the device anymore. Called by "SerialReaderWriter::closeDevice()".
+	 */
+	void removeFromEventLoop(SerialReaderWriter* readerWriter);
 private:
 	BaseLib::SharedObjects* _bl = nullptr;
 	std::mutex _devicesMutex;
 	std::map<std::string, std::shared_ptr<SerialReaderWriter>> _devices;
+
+	/**
+	 * Protects _eventLoopDevices and is held while a device is serviced. Recursive, so devices can remove themselves from within the event loop.
+	 */
+	std::recursive_mutex _eventLoopMutex;
+	std::map<int32_t, SerialReaderWriter*> _eventLoopDevices;
+	int _epollDescriptor = -1;
+	std::atomic_bool _stopEventLoop{false};
+	std::mutex _eventLoopThreadMutex;
+	std::thread _eventLoopThread;
+
+	void eventLoop();
 };
 }
 #endif
@@ -0,0 +1,202 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "AsyncOutputWriter.h"
+#include "Output.h"
+
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+
+namespace BaseLib {
+
+bool AsyncOutputWriter::Ring::push(Entry &entry) {
+  size_t tail = _tail.load(std::memory_order_relaxed);
+  size_t nextTail = (tail + 1) % _entries.size();
+  if (nextTail == _head.load(std::memory_order_acquire)) return false;
+  _entries[tail] = std::move(entry);
+  _tail.store(nextTail, std::memory_order_release);
+  return true;
+}
+
+bool AsyncOutputWriter::Ring::pop(Entry &entry) {
+  size_t head = _head.load(std::memory_order_relaxed);
+  if (head == _tail.load(std::memory_order_acquire)) return false;
+  entry = std::move(_entries[head]);
+  _entries[head].callback = nullptr;
+  _head.store((head + 1) % _entries.size(), std::memory_order_release);
+  return true;
+}
+
+AsyncOutputWriter::AsyncOutputWriter(std::mutex &outputMutex) : _outputMutex(outputMutex) {
+}
+
+AsyncOutputWriter::~AsyncOutputWriter() {
+  stop();
+}
+
+void AsyncOutputWriter::start() {
+  std::lock_guard<std::mutex> startStopGuard(_startStopMutex);
+  if (_running) return;
+  _running = true;
+  _writerThread = std::thread(&AsyncOutputWriter::writer, this);
+}
+
+void AsyncOutputWriter::stop() {
+  std::lock_guard<std::mutex> startStopGuard(_startStopMutex);
+  if (!_running) return;
+  _running = false;
+  {
+    std::lock_guard<std::mutex> wakeGuard(_wakeMutex);
+    _wakeCondition.notify_one();
+  }
+  while (_activeProducers > 0) std::this_thread::yield(); //Make sure nobody adds entries after the last batch was written.
+  if (_writerThread.joinable()) _writerThread.join();
+  writeBatch(true);
+}
+
+std::shared_ptr<AsyncOutputWriter::Ring> AsyncOutputWriter::getRing() {
+  //Rings are owned by the writer too, so entries of exited threads are still written.
+  thread_local std::shared_ptr<Ring> ring;
+  if (!ring) {
+    ring = std::make_shared<Ring>(_ringCapacity);
+    std::lock_guard<std::mutex> ringsGuard(_ringsMutex);
+    _rings.push_back(ring);
+  }
+  return ring;
+}
+
+bool AsyncOutputWriter::enqueue(Entry &entry) {
+  _activeProducers++;
+  if (!_running) {
+    _activeProducers--;
+    return false;
+  }
+  auto ring = getRing();
+  //Announce the sequence number before taking it, so the writer holds back newer entries until this one is queued.
+  ring->inFlight = _sequence.load();
+  entry.sequence = _sequence++;
+  bool result = ring->push(entry);
+  ring->inFlight = UINT64_MAX;
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (result && _writerWaiting) {
+    std::lock_guard<std::mutex> wakeGuard(_wakeMutex);
+    _wakeCondition.notify_one();
+  }
+  _activeProducers--;
+  return result;
+}
+
+bool AsyncOutputWriter::hasEntries() {
+  std::lock_guard<std::mutex> ringsGuard(_ringsMutex);
+  for (auto &ring : _rings) {
+    if (!ring->empty()) return true;
+  }
+  return false;
+}
+
+void AsyncOutputWriter::writer() {
+  while (_running) {
+    writeBatch();
+    if (!_pending.empty()) {
+      //Only waiting for a producer which is about to queue its entry.
+      std::this_thread::yield();
+      continue;
+    }
+    std::unique_lock<std::mutex> wakeGuard(_wakeMutex);
+    _writerWaiting = true;
+    _wakeCondition.wait(wakeGuard, [&] { return !_running || hasEntries(); });
+    _writerWaiting = false;
+  }
+}
+
+bool AsyncOutputWriter::writeBatch(bool final) {
+  try {
+    uint64_t nextSequence = _sequence.load();
+    std::vector<std::shared_ptr<Ring>> rings;
+    {
+      std::lock_guard<std::mutex> ringsGuard(_ringsMutex);
+      //Remove rings of exited threads which are empty.
+      _rings.erase(std::remove_if(_rings.begin(), _rings.end(), [](const std::shared_ptr<Ring> &ring) { return ring.use_count() == 1 && ring->empty(); }), _rings.end());
+      rings = _rings;
+    }
+
+    //Entries numbered from here on might not be queued yet. The bound has to be determined before collecting the entries.
+    uint64_t sequenceBound = final ? UINT64_MAX : nextSequence;
+    if (!final) {
+      for (auto &ring : rings) {
+        sequenceBound = std::min(sequenceBound, ring->inFlight.load());
+      }
+    }
+
+    std::vector<Entry> entries = std::move(_pending);
+    _pending.clear();
+    Entry entry;
+    for (auto &ring : rings) {
+      while (ring->pop(entry)) {
+        entries.emplace_back(std::move(entry));
+      }
+    }
+    if (entries.empty()) return false;
+    std::sort(entries.begin(), entries.end(), [](const Entry &a, const Entry &b) { return a.sequence < b.sequence; });
+    auto firstPending = std::find_if(entries.begin(), entries.end(), [&](const Entry &element) { return element.sequence >= sequenceBound; });
+    _pending.insert(_pending.end(), std::make_move_iterator(firstPending), std::make_move_iterator(entries.end()));
+    entries.erase(firstPending, entries.end());
+    if (entries.empty()) return false;
+
+    std::string stdOutput;
+    std::string errorOutput;
+    for (auto &element : entries) {
+      if (!element.stdOutput) continue;
+      std::string line = Output::getTimeString(element.time);
+      line.push_back(' ');
+      line.append(element.text);
+      line.push_back('\n');
+      stdOutput.append(line);
+      if (element.errorOutput) errorOutput.append(line);
+    }
+
+    std::lock_guard<std::mutex> outputGuard(_outputMutex);
+    if (!stdOutput.empty()) std::cout.write(stdOutput.data(), stdOutput.size()).flush();
+    if (!errorOutput.empty()) std::cerr.write(errorOutput.data(), errorOutput.size()).flush();
+    for (auto &element : entries) {
+      if (!element.callback) continue;
+      if (element.callbackOffset == 0) element.callback(element.level, element.text);
+      else element.callback(element.level, element.text.substr(element.callbackOffset));
+    }
+    return true;
+  }
+  catch (const std::exception &ex) {
+    std::cerr << "Error in file " << __FILE__ << " line " << __LINE__ << " in function " << __PRETTY_FUNCTION__ << ": " << ex.what() << std::endl;
+  }
+  return false;
+}
+
+}
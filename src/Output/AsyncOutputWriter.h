@@ -0,0 +1,157 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef LIBHOMEGEAR_BASE_ASYNCOUTPUTWRITER_H_
+#define LIBHOMEGEAR_BASE_ASYNCOUTPUTWRITER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace BaseLib {
+
+/**
+ * Background writer for asynchronous logging used by Output. Every producing thread gets its own lock-free single producer single consumer ring
+ * buffer, so threads logging at the same time don't block each other. One writer thread collects the entries of all buffers, restores the order
+ * in which they were logged, formats the time stamps and writes them to stdout and stderr in batches. Entries of producers which are still
+ * between numbering and queueing an entry are held back until that entry arrived, so the order is also kept across batches. The writer
+ * thread sleeps until a producer signals new entries.
+ */
+class AsyncOutputWriter {
+ public:
+  struct Entry {
+    uint64_t sequence = 0;
+
+    /**
+     * Unix time stamp in milliseconds.
+     */
+    int64_t time = 0;
+
+    /**
+     * The level passed to the output callback.
+     */
+    int32_t level = 0;
+    bool stdOutput = false;
+    bool errorOutput = false;
+
+    /**
+     * Only the text starting at this position is passed to the output callback.
+     */
+    size_t callbackOffset = 0;
+    std::string text;
+    std::function<void(int32_t, const std::string &)> callback;
+  };
+
+  /**
+   * @param outputMutex The mutex synchronous output is serialized with. It is locked while writing a batch.
+   */
+  explicit AsyncOutputWriter(std::mutex &outputMutex);
+  virtual ~AsyncOutputWriter();
+
+  bool running() { return _running; }
+  void start();
+
+  /**
+   * Stops the writer thread and writes all entries still queued.
+   */
+  void stop();
+
+  /**
+   * Queues an entry. "entry" is only moved on success.
+   *
+   * @return Returns "false" when the writer is not running or the calling thread's buffer is full. The caller should output the entry
+   * synchronously in this case.
+   */
+  bool enqueue(Entry &entry);
+ private:
+  class Ring {
+   public:
+    explicit Ring(size_t capacity) : _entries(capacity) {}
+
+    bool empty() { return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_acquire); }
+    bool push(Entry &entry);
+    bool pop(Entry &entry);
+
+    /**
+     * Lower bound of the sequence number the owning thread is currently queueing or UINT64_MAX.
+     */
+    std::atomic<uint64_t> inFlight{UINT64_MAX};
+   private:
+    std::vector<Entry> _entries;
+    std::atomic<size_t> _head{0};
+    std::atomic<size_t> _tail{0};
+  };
+
+  static const size_t _ringCapacity = 1024;
+
+  std::mutex &_outputMutex;
+  std::atomic_bool _running{false};
+  std::atomic<uint32_t> _activeProducers{0};
+  std::atomic<uint64_t> _sequence{0};
+  std::mutex _startStopMutex;
+  std::thread _writerThread;
+
+  std::mutex _wakeMutex;
+  std::condition_variable _wakeCondition;
+  std::atomic_bool _writerWaiting{false};
+
+  /**
+   * Entries which were collected but have to wait for an entry with a lower sequence number. Only accessed by the writer thread.
+   */
+  std::vector<Entry> _pending;
+
+  std::mutex _ringsMutex;
+  std::vector<std::shared_ptr<Ring>> _rings;
+
+  AsyncOutputWriter(const AsyncOutputWriter &) = delete;
+  AsyncOutputWriter &operator=(const AsyncOutputWriter &) = delete;
+
+  std::shared_ptr<Ring> getRing();
+  bool hasEntries();
+  void writer();
+
+  /**
+   * Writes all queued entries.
+   *
+   * @param final Set to "true" when no producer can add entries anymore. All entries are written then.
+   * @return Returns "true" when at least one entry was written.
+   */
+  bool writeBatch(bool final = false);
+};
+
+}
+
+#endif
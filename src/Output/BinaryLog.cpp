@@ -0,0 +1,317 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "BinaryLog.h"
+#include "Output.h"
+
+#include <chrono>
+#include <fcntl.h>
+#include <fstream>
+#include <iterator>
+#include <unistd.h>
+#include <unordered_map>
+
+namespace BaseLib {
+
+std::shared_mutex BinaryLog::_fileMutex;
+std::atomic<int> BinaryLog::_fileDescriptor{-1};
+
+namespace {
+const char binaryLogMagic[] = {'H', 'G', 'B', 'L'};
+const uint8_t binaryLogVersion = 1;
+const size_t recordHeaderSize = 5; //Type and length
+const size_t recordFixedPayloadSize = 8 + 4 + 4 + 4 + 1; //Time, level, format ID, prefix length and argument count
+
+template<typename T>
+bool readValue(const char *data, size_t size, size_t &position, T &value) {
+  if (position + sizeof(T) > size) return false;
+  std::memcpy(&value, data + position, sizeof(T));
+  position += sizeof(T);
+  return true;
+}
+
+void writeAll(int fileDescriptor, const char *data, size_t size) {
+  while (size > 0) {
+    ssize_t bytesWritten = ::write(fileDescriptor, data, size);
+    if (bytesWritten <= 0) {
+      if (bytesWritten == -1 && errno == EINTR) continue;
+      return;
+    }
+    data += bytesWritten;
+    size -= bytesWritten;
+  }
+}
+}
+
+BinaryLog::FormatRegistry &BinaryLog::formatRegistry() {
+  static FormatRegistry registry;
+  return registry;
+}
+
+uint32_t BinaryLog::registerFormat(const std::string &format) {
+  uint32_t formatId = 0;
+  {
+    auto &registry = formatRegistry();
+    std::lock_guard<std::mutex> formatsGuard(registry.formatsMutex);
+    registry.formats.push_back(format);
+    formatId = (uint32_t)registry.formats.size();
+  }
+  std::shared_lock<std::shared_mutex> fileGuard(_fileMutex);
+  if (_fileDescriptor != -1) writeFormat(_fileDescriptor, formatId, format);
+  return formatId;
+}
+
+bool BinaryLog::open(const std::string &path) {
+  std::unique_lock<std::shared_mutex> fileGuard(_fileMutex);
+  if (_fileDescriptor != -1) {
+    ::close(_fileDescriptor);
+    _fileDescriptor = -1;
+  }
+  int fileDescriptor = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0640);
+  if (fileDescriptor == -1) return false;
+
+  if (lseek(fileDescriptor, 0, SEEK_END) == 0) {
+    std::vector<char> header(binaryLogMagic, binaryLogMagic + sizeof(binaryLogMagic));
+    header.push_back((char)binaryLogVersion);
+    writeAll(fileDescriptor, header.data(), header.size());
+  }
+
+  //Write all formats, so the file can be decoded without this process.
+  {
+    auto &registry = formatRegistry();
+    std::lock_guard<std::mutex> formatsGuard(registry.formatsMutex);
+    for (size_t i = 0; i < registry.formats.size(); i++) {
+      writeFormat(fileDescriptor, (uint32_t)i + 1, registry.formats[i]);
+    }
+  }
+
+  _fileDescriptor = fileDescriptor;
+  return true;
+}
+
+void BinaryLog::close() {
+  std::unique_lock<std::shared_mutex> fileGuard(_fileMutex);
+  if (_fileDescriptor == -1) return;
+  ::close(_fileDescriptor);
+  _fileDescriptor = -1;
+}
+
+void BinaryLog::encodeArgument(std::vector<char> &buffer, bool value) {
+  buffer.push_back('b');
+  buffer.push_back((char)value);
+}
+
+void BinaryLog::encodeArgument(std::vector<char> &buffer, double value) {
+  buffer.push_back('d');
+  appendValue(buffer, value);
+}
+
+void BinaryLog::encodeArgument(std::vector<char> &buffer, const std::string &value) {
+  buffer.push_back('s');
+  appendValue(buffer, (uint32_t)value.size());
+  buffer.insert(buffer.end(), value.begin(), value.end());
+}
+
+void BinaryLog::encodeArgument(std::vector<char> &buffer, const char *value) {
+  if (!value) value = "";
+  size_t length = strlen(value);
+  buffer.push_back('s');
+  appendValue(buffer, (uint32_t)length);
+  buffer.insert(buffer.end(), value, value + length);
+}
+
+void BinaryLog::beginRecord(std::vector<char> &buffer, int32_t level, const std::string &prefix, uint32_t formatId, size_t argumentCount) {
+  buffer.push_back('R');
+  appendValue(buffer, (uint32_t)0); //Length, set by endRecord()
+  appendValue(buffer, (int64_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count());
+  appendValue(buffer, level);
+  appendValue(buffer, formatId);
+  appendValue(buffer, (uint32_t)prefix.size());
+  buffer.insert(buffer.end(), prefix.begin(), prefix.end());
+  buffer.push_back((char)(uint8_t)argumentCount);
+}
+
+void BinaryLog::endRecord(std::vector<char> &buffer) {
+  uint32_t length = buffer.size() - recordHeaderSize;
+  std::memcpy(buffer.data() + 1, &length, sizeof(length));
+}
+
+void BinaryLog::writeRecord(const std::vector<char> &buffer) {
+  std::shared_lock<std::shared_mutex> fileGuard(_fileMutex);
+  if (_fileDescriptor == -1) return;
+  //With O_APPEND every record is appended in one piece, so no additional locking is needed.
+  writeAll(_fileDescriptor, buffer.data(), buffer.size());
+}
+
+void BinaryLog::writeFormat(int fileDescriptor, uint32_t formatId, const std::string &format) {
+  std::vector<char> buffer;
+  buffer.reserve(recordHeaderSize + 4 + format.size());
+  buffer.push_back('F');
+  appendValue(buffer, (uint32_t)(4 + format.size()));
+  appendValue(buffer, formatId);
+  buffer.insert(buffer.end(), format.begin(), format.end());
+  writeAll(fileDescriptor, buffer.data(), buffer.size());
+}
+
+std::string BinaryLog::formatRecord(const std::vector<char> &buffer) {
+  uint32_t formatId = 0;
+  std::memcpy(&formatId, buffer.data() + recordHeaderSize + 8 + 4, sizeof(formatId));
+  std::string format;
+  {
+    auto &registry = formatRegistry();
+    std::lock_guard<std::mutex> formatsGuard(registry.formatsMutex);
+    if (formatId > 0 && formatId <= registry.formats.size()) format = registry.formats[formatId - 1];
+  }
+  //Records created by format() have no prefix.
+  std::string result;
+  formatArguments(format, buffer.data(), buffer.size(), recordHeaderSize + recordFixedPayloadSize, (uint8_t)buffer.at(recordHeaderSize + recordFixedPayloadSize - 1), result);
+  return result;
+}
+
+bool BinaryLog::formatArguments(const std::string &format, const char *data, size_t size, size_t position, uint8_t argumentCount, std::string &result) {
+  result.reserve(format.size() + argumentCount * 8);
+  size_t formatPosition = 0;
+  for (uint8_t i = 0; i < argumentCount; i++) {
+    if (position >= size) return false;
+    char tag = data[position++];
+    std::string argument;
+    switch (tag) {
+      case 'i': {
+        int64_t value = 0;
+        if (!readValue(data, size, position, value)) return false;
+        argument = std::to_string(value);
+        break;
+      }
+      case 'u': {
+        uint64_t value = 0;
+        if (!readValue(data, size, position, value)) return false;
+        argument = std::to_string(value);
+        break;
+      }
+      case 'd': {
+        double value = 0;
+        if (!readValue(data, size, position, value)) return false;
+        argument = std::to_string(value);
+        break;
+      }
+      case 'b': {
+        uint8_t value = 0;
+        if (!readValue(data, size, position, value)) return false;
+        argument = value ? "true" : "false";
+        break;
+      }
+      case 's': {
+        uint32_t length = 0;
+        if (!readValue(data, size, position, length) || position + length > size) return false;
+        argument.assign(data + position, length);
+        position += length;
+        break;
+      }
+      default: return false;
+    }
+
+    auto placeholderPosition = format.find("{}", formatPosition);
+    if (placeholderPosition == std::string::npos) {
+      //More arguments than placeholders => append them.
+      result.append(format, formatPosition, std::string::npos);
+      formatPosition = format.size();
+      result.push_back(' ');
+      result.append(argument);
+    } else {
+      result.append(format, formatPosition, placeholderPosition - formatPosition);
+      result.append(argument);
+      formatPosition = placeholderPosition + 2;
+    }
+  }
+  if (formatPosition < format.size()) result.append(format, formatPosition, std::string::npos);
+  return true;
+}
+
+std::string BinaryLog::decode(const std::vector<char> &data) {
+  std::string text;
+  if (data.size() < sizeof(binaryLogMagic) + 1 || std::memcmp(data.data(), binaryLogMagic, sizeof(binaryLogMagic)) != 0) return text;
+
+  std::unordered_map<uint32_t, std::string> formats;
+  size_t position = sizeof(binaryLogMagic) + 1;
+  while (position + recordHeaderSize <= data.size()) {
+    char type = data[position];
+    uint32_t length = 0;
+    std::memcpy(&length, data.data() + position + 1, sizeof(length));
+    size_t payloadPosition = position + recordHeaderSize;
+    size_t recordEnd = payloadPosition + length;
+    if (recordEnd > data.size()) break;
+
+    if (type == 'F' && length >= 4) {
+      uint32_t formatId = 0;
+      std::memcpy(&formatId, data.data() + payloadPosition, sizeof(formatId));
+      formats[formatId] = std::string(data.data() + payloadPosition + 4, length - 4);
+    } else if (type == 'R' && length >= recordFixedPayloadSize) {
+      int64_t time = 0;
+      int32_t level = 0;
+      uint32_t formatId = 0;
+      uint32_t prefixLength = 0;
+      size_t valuePosition = payloadPosition;
+      readValue(data.data(), recordEnd, valuePosition, time);
+      readValue(data.data(), recordEnd, valuePosition, level);
+      readValue(data.data(), recordEnd, valuePosition, formatId);
+      readValue(data.data(), recordEnd, valuePosition, prefixLength);
+      std::string message;
+      auto formatIterator = formats.find(formatId);
+      if (valuePosition + prefixLength + 1 > recordEnd || formatIterator == formats.end()) {
+        message = "<Undecodable record with format ID " + std::to_string(formatId) + ">";
+      } else {
+        message.assign(data.data() + valuePosition, prefixLength);
+        valuePosition += prefixLength;
+        uint8_t argumentCount = (uint8_t)data[valuePosition++];
+        std::string formattedMessage;
+        if (formatArguments(formatIterator->second, data.data(), recordEnd, valuePosition, argumentCount, formattedMessage)) message.append(formattedMessage);
+        else message = "<Undecodable record with format ID " + std::to_string(formatId) + ">";
+      }
+      text.append(Output::getTimeString(time));
+      text.append(" <" + std::to_string(level) + "> ");
+      text.append(message);
+      text.push_back('\n');
+    }
+
+    position = recordEnd;
+  }
+  return text;
+}
+
+bool BinaryLog::decodeFile(const std::string &path, std::string &text) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) return false;
+  std::vector<char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+  if (data.size() < sizeof(binaryLogMagic) || std::memcmp(data.data(), binaryLogMagic, sizeof(binaryLogMagic)) != 0) return false;
+  text = decode(data);
+  return true;
+}
+
+}
@@ -0,0 +1,181 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef LIBHOMEGEAR_BASE_BINARYLOG_H_
+#define LIBHOMEGEAR_BASE_BINARYLOG_H_
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace BaseLib {
+
+/**
+ * Structured binary log. Instead of formatting messages, call sites register a format string once and then only pass the format ID and the
+ * arguments. Records are appended to a compact binary file and rendered to text later using "decode()" or "decodeFile()".
+ *
+ * Format strings use "{}" as placeholder for the arguments. Supported arguments are integers, floating point numbers, booleans and strings.
+ *
+ * File layout (native byte order): The magic "HGBL" followed by a one byte version. Then records follow, each starting with a one byte type and a
+ * four byte payload length. Type "F" defines a format (four byte ID followed by the format string), type "R" is a log record (eight byte time in
+ * milliseconds, four byte level, four byte format ID, the prefix as four byte length followed by the string, one byte argument count and the
+ * arguments). Arguments start with a one byte tag: "i"
+ * (signed 64 bit integer), "u" (unsigned 64 bit integer), "d" (double), "b" (one byte boolean) or "s" (four byte length followed by the string).
+ */
+class BinaryLog {
+ public:
+  /**
+   * Registers a format string. Call this once per call site, e.g. to initialize a static variable.
+   *
+   * @param format The format string with "{}" as placeholder for arguments.
+   * @return Returns the ID to pass to "write()" and "format()".
+   */
+  static uint32_t registerFormat(const std::string &format);
+
+  /**
+   * Opens the binary log. If the file exists, records are appended.
+   *
+   * @param path The path of the log file.
+   * @return Returns "true" on success.
+   */
+  static bool open(const std::string &path);
+  static void close();
+  static bool isOpen() { return _fileDescriptor != -1; }
+
+  /**
+   * Appends a record to the binary log. Does nothing when the log is not open.
+   *
+   * @param level The debug level of the message.
+   * @param prefix A prefix put before the message when it is rendered (e.g. the prefix of an Output object).
+   * @param formatId The ID returned by "registerFormat()".
+   * @param args The arguments for the placeholders in the format string.
+   */
+  template<typename... Args>
+  static void write(int32_t level, const std::string &prefix, uint32_t formatId, const Args &... args) {
+    thread_local std::vector<char> buffer;
+    buffer.clear();
+    beginRecord(buffer, level, prefix, formatId, sizeof...(args));
+    (encodeArgument(buffer, args), ...);
+    endRecord(buffer);
+    writeRecord(buffer);
+  }
+
+  /**
+   * Renders a message as text.
+   */
+  template<typename... Args>
+  static std::string format(uint32_t formatId, const Args &... args) {
+    std::vector<char> buffer;
+    beginRecord(buffer, 0, std::string(), formatId, sizeof...(args));
+    (encodeArgument(buffer, args), ...);
+    endRecord(buffer);
+    return formatRecord(buffer);
+  }
+
+  /**
+   * Renders the content of a binary log as text. Each record is rendered as one line starting with time and level.
+   *
+   * @param data The content of the log file.
+   * @return Returns the rendered text. Incomplete records at the end are ignored.
+   */
+  static std::string decode(const std::vector<char> &data);
+
+  /**
+   * Reads a binary log file and renders it as text.
+   *
+   * @param path The path of the log file.
+   * @param text Is filled with the rendered text.
+   * @return Returns "false" when the file could not be read or is no binary log.
+   */
+  static bool decodeFile(const std::string &path, std::string &text);
+
+  template<typename T>
+  static typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type encodeArgument(std::vector<char> &buffer, T value) {
+    buffer.push_back('i');
+    appendValue(buffer, (int64_t)value);
+  }
+
+  template<typename T>
+  static typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value && !std::is_same<T, bool>::value>::type encodeArgument(std::vector<char> &buffer, T value) {
+    buffer.push_back('u');
+    appendValue(buffer, (uint64_t)value);
+  }
+
+  static void encodeArgument(std::vector<char> &buffer, bool value);
+  static void encodeArgument(std::vector<char> &buffer, double value);
+  static void encodeArgument(std::vector<char> &buffer, float value) { encodeArgument(buffer, (double)value); }
+  static void encodeArgument(std::vector<char> &buffer, const std::string &value);
+  static void encodeArgument(std::vector<char> &buffer, const char *value);
+ private:
+  struct FormatRegistry {
+    std::mutex formatsMutex;
+    std::vector<std::string> formats;
+  };
+
+  /**
+   * Function local static, so formats can be registered during static initialization.
+   */
+  static FormatRegistry &formatRegistry();
+  static std::shared_mutex _fileMutex;
+  static std::atomic<int> _fileDescriptor;
+
+  template<typename T>
+  static void appendValue(std::vector<char> &buffer, T value) {
+    size_t size = buffer.size();
+    buffer.resize(size + sizeof(T));
+    std::memcpy(buffer.data() + size, &value, sizeof(T));
+  }
+
+  static void beginRecord(std::vector<char> &buffer, int32_t level, const std::string &prefix, uint32_t formatId, size_t argumentCount);
+  static void endRecord(std::vector<char> &buffer);
+  static void writeRecord(const std::vector<char> &buffer);
+  static void writeFormat(int fileDescriptor, uint32_t formatId, const std::string &format);
+
+  /**
+   * Renders a record created by "beginRecord()" and "endRecord()" without time, level and prefix.
+   */
+  static std::string formatRecord(const std::vector<char> &buffer);
+
+  /**
+   * Renders the arguments of the record payload starting at "position".
+   *
+   * @return Returns "false" when the record is malformed.
+   */
+  static bool formatArguments(const std::string &format, const char *data, size_t size, size_t position, uint8_t argumentCount, std::string &result);
+};
+
+}
+
+#endif
@@ -0,0 +1,200 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "LogRateLimiter.h"
+#include "../Managers/ThreadManager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <vector>
+
+namespace BaseLib {
+
+LogRateLimiter::LogRateLimiter(SummaryCallback summaryCallback) : _summaryCallback(std::move(summaryCallback)) {
+}
+
+LogRateLimiter::~LogRateLimiter() {
+  {
+    std::lock_guard<std::mutex> flushThreadGuard(_flushThreadMutex);
+    _stopFlushThread = true;
+    _flushCondition.notify_all();
+  }
+  //The thread manager is gone if "stopFlushThread()" wasn't called.
+  if (_flushThread.joinable()) _flushThread.join();
+}
+
+int64_t LogRateLimiter::getTime() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool LogRateLimiter::check(ThreadManager &threadManager, void *owner, int32_t level, std::string_view file, uint32_t line, uint32_t ratePerSecond, uint32_t burst, uint32_t sampleRate, uint64_t &suppressedCount) {
+  suppressedCount = 0;
+  if (ratePerSecond == 0) return true;
+  if (burst == 0) burst = 1;
+  int64_t now = getTime();
+
+  uint64_t bucketId = std::hash<std::string_view>()(file) * 31 + line;
+  bucketId ^= std::hash<void *>()(owner) + 0x9e3779b97f4a7c15ull + (bucketId << 6) + (bucketId >> 2);
+  Shard &shard = _shards[bucketId % _shardCount];
+  std::unique_lock<std::mutex> bucketsGuard(shard.bucketsMutex);
+  auto bucketIterator = shard.buckets.find(bucketId);
+  if (bucketIterator == shard.buckets.end()) {
+    if (shard.buckets.size() >= _maxBucketsPerShard) {
+      //Limit memory usage. Only buckets without pending summaries can be dropped, they just start with a full burst again.
+      for (auto i = shard.buckets.begin(); i != shard.buckets.end();) {
+        if (i->second.suppressed == 0) i = shard.buckets.erase(i);
+        else ++i;
+      }
+      if (shard.buckets.size() >= _maxBucketsPerShard) return true;
+    }
+    Bucket bucket;
+    bucket.owner = owner;
+    bucket.file = std::string(file);
+    bucket.line = line;
+    bucket.tokens = burst;
+    bucket.lastRefill = now;
+    bucket.lastSummary = now;
+    bucketIterator = shard.buckets.emplace(bucketId, std::move(bucket)).first;
+  }
+  Bucket &bucket = bucketIterator->second;
+  bucket.level = level;
+
+  bucket.tokens = std::min((double)burst, bucket.tokens + ((double)(now - bucket.lastRefill) * ratePerSecond) / 1000.0);
+  bucket.lastRefill = now;
+
+  bool print = false;
+  if (bucket.tokens >= 1.0) {
+    bucket.tokens -= 1.0;
+    bucket.exceeded = 0;
+    print = true;
+  } else {
+    bucket.exceeded++;
+    if (sampleRate > 0 && bucket.exceeded % sampleRate == 0) print = true;
+    else bucket.suppressed++;
+  }
+
+  if (bucket.suppressed > 0 && (print || now - bucket.lastSummary >= _summaryInterval)) {
+    suppressedCount = bucket.suppressed;
+    bucket.suppressed = 0;
+    bucket.lastSummary = now;
+  }
+
+  bool startThread = bucket.suppressed > 0;
+  bucketsGuard.unlock();
+  if (startThread && !_flushThreadStarted) startFlushThread(threadManager);
+
+  return print;
+}
+
+void LogRateLimiter::removeOwner(void *owner) {
+  try {
+    std::lock_guard<std::mutex> summaryGuard(_summaryMutex);
+    std::vector<Summary> summaries;
+    for (auto &shard : _shards) {
+      std::lock_guard<std::mutex> bucketsGuard(shard.bucketsMutex);
+      for (auto bucketIterator = shard.buckets.begin(); bucketIterator != shard.buckets.end();) {
+        auto &bucket = bucketIterator->second;
+        if (bucket.owner != owner) {
+          ++bucketIterator;
+          continue;
+        }
+        if (bucket.suppressed > 0) summaries.emplace_back(Summary{owner, bucket.level, bucket.file, bucket.line, bucket.suppressed});
+        //A new owner at the same address starts with new buckets.
+        bucketIterator = shard.buckets.erase(bucketIterator);
+      }
+    }
+    for (auto &summary : summaries) {
+      _summaryCallback(summary.owner, summary.level, summary.file, summary.line, summary.suppressedCount);
+    }
+  }
+  catch (const std::exception &ex) {
+    std::cerr << "Error in file " << __FILE__ << " line " << __LINE__ << " in function " << __PRETTY_FUNCTION__ << ": " << ex.what() << std::endl;
+  }
+}
+
+void LogRateLimiter::startFlushThread(ThreadManager &threadManager) {
+  std::lock_guard<std::mutex> flushThreadGuard(_flushThreadMutex);
+  if (_flushThreadStarted || _flushThread.joinable() || _stopFlushThread) return;
+  //Set before starting the thread, as the thread manager might print an error, which calls check() again. When the thread can't be started, summaries are
+  //only printed with the next message of a call site.
+  _flushThreadStarted = true;
+  if (threadManager.start(_flushThread, false, &LogRateLimiter::flushThread, this)) _threadManager = &threadManager;
+}
+
+void LogRateLimiter::stopFlushThread(ThreadManager &threadManager) {
+  std::unique_lock<std::mutex> flushThreadGuard(_flushThreadMutex);
+  if (_threadManager != &threadManager) return;
+  _stopFlushThread = true;
+  _flushCondition.notify_all();
+  flushThreadGuard.unlock();
+  threadManager.join(_flushThread);
+  flushThreadGuard.lock();
+  _threadManager = nullptr;
+  _stopFlushThread = false;
+  _flushThreadStarted = false;
+}
+
+void LogRateLimiter::flushThread() {
+  std::unique_lock<std::mutex> flushThreadGuard(_flushThreadMutex);
+  while (!_stopFlushThread) {
+    _flushCondition.wait_for(flushThreadGuard, std::chrono::milliseconds(_summaryInterval / 2), [&] { return _stopFlushThread; });
+    if (_stopFlushThread) break;
+    flushThreadGuard.unlock();
+    flush();
+    flushThreadGuard.lock();
+  }
+}
+
+void LogRateLimiter::flush() {
+  try {
+    std::lock_guard<std::mutex> summaryGuard(_summaryMutex);
+    int64_t now = getTime();
+    std::vector<Summary> summaries;
+    for (auto &shard : _shards) {
+      std::lock_guard<std::mutex> bucketsGuard(shard.bucketsMutex);
+      for (auto &bucket : shard.buckets) {
+        //Buckets without owner are reported when their call site prints the next time.
+        if (bucket.second.suppressed == 0 || !bucket.second.owner || now - bucket.second.lastSummary < _summaryInterval) continue;
+        summaries.emplace_back(Summary{bucket.second.owner, bucket.second.level, bucket.second.file, bucket.second.line, bucket.second.suppressed});
+        bucket.second.suppressed = 0;
+        bucket.second.lastSummary = now;
+      }
+    }
+    for (auto &summary : summaries) {
+      _summaryCallback(summary.owner, summary.level, summary.file, summary.line, summary.suppressedCount);
+    }
+  }
+  catch (const std::exception &ex) {
+    std::cerr << "Error in file " << __FILE__ << " line " << __LINE__ << " in function " << __PRETTY_FUNCTION__ << ": " << ex.what() << std::endl;
+  }
+}
+
+}
@@ -0,0 +1,157 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef LIBHOMEGEAR_BASE_LOGRATELIMITER_H_
+#define LIBHOMEGEAR_BASE_LOGRATELIMITER_H_
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+
+namespace BaseLib {
+
+class ThreadManager;
+
+/**
+ * Token bucket rate limiter for log messages. Every owner and call site (file and line) has its own bucket, so messages of one Output object don't
+ * suppress the same messages of another one. Messages exceeding the limit are suppressed,
+ * optionally letting every n-th suppressed message through. The number of suppressed messages is reported with the next message printed for the
+ * call site or, when the call site stays silent, by a background thread after the summary interval.
+ */
+class LogRateLimiter {
+ public:
+  /**
+   * Called with the number of messages suppressed at a call site.
+   *
+   * @param owner The owner passed to check().
+   */
+  typedef std::function<void(void *owner, int32_t level, const std::string &file, uint32_t line, uint64_t suppressedCount)> SummaryCallback;
+
+  explicit LogRateLimiter(SummaryCallback summaryCallback);
+  virtual ~LogRateLimiter();
+
+  /**
+   * Checks if a message may be printed.
+   *
+   * @param threadManager Used to start the thread reporting summaries of call sites that stay silent.
+   * @param owner The object printing the message. It is passed to the summary callback.
+   * @param level The level of the message.
+   * @param file The file of the call site.
+   * @param line The line of the call site.
+   * @param ratePerSecond The number of messages per second and call site that may be printed on average.
+   * @param burst The number of messages that may be printed at once before the rate limit applies.
+   * @param sampleRate When greater than 0, every n-th message exceeding the limit is printed anyway.
+   * @param[out] suppressedCount Set to the number of messages suppressed since the last summary when a summary should be printed, otherwise 0.
+   * @return Returns "true" when the message should be printed.
+   */
+  bool check(ThreadManager &threadManager, void *owner, int32_t level, std::string_view file, uint32_t line, uint32_t ratePerSecond, uint32_t burst, uint32_t sampleRate, uint64_t &suppressedCount);
+
+  /**
+   * Reports all pending summaries of "owner" through the summary callback. The callback is not called for "owner" anymore after this method
+   * returned. Must be called before the owner is destroyed.
+   */
+  void removeOwner(void *owner);
+
+  /**
+   * Stops the summary thread when it was started with "threadManager". It is started again by the next call of "check()". Must be called before
+   * "threadManager" is destroyed.
+   */
+  void stopFlushThread(ThreadManager &threadManager);
+ private:
+  struct Bucket {
+    void *owner = nullptr;
+    int32_t level = 0;
+    std::string file;
+    uint32_t line = 0;
+    double tokens = 0;
+    int64_t lastRefill = 0;
+    int64_t lastSummary = 0;
+    uint64_t suppressed = 0;
+    uint64_t exceeded = 0;
+  };
+
+  struct Summary {
+    void *owner = nullptr;
+    int32_t level = 0;
+    std::string file;
+    uint32_t line = 0;
+    uint64_t suppressedCount = 0;
+  };
+
+  /**
+   * Buckets are split into shards with their own mutex, so different call sites rarely block each other.
+   */
+  struct Shard {
+    std::mutex bucketsMutex;
+    std::unordered_map<uint64_t, Bucket> buckets;
+  };
+
+  static const size_t _shardCount = 16;
+  static const size_t _maxBucketsPerShard = 1000;
+  static const int64_t _summaryInterval = 10000;
+
+  std::array<Shard, _shardCount> _shards;
+  SummaryCallback _summaryCallback;
+
+  /**
+   * Held while summaries are collected and reported, so removeOwner() can't return while a summary of the owner is reported.
+   */
+  std::mutex _summaryMutex;
+
+  std::mutex _flushThreadMutex;
+  std::condition_variable _flushCondition;
+  bool _stopFlushThread = false;
+  std::atomic_bool _flushThreadStarted{false};
+  ThreadManager *_threadManager = nullptr;
+  std::thread _flushThread;
+
+  LogRateLimiter(const LogRateLimiter &) = delete;
+  LogRateLimiter &operator=(const LogRateLimiter &) = delete;
+
+  static int64_t getTime();
+  void startFlushThread(ThreadManager &threadManager);
+  void flushThread();
+
+  /**
+   * Reports the suppressed messages of all call sites whose last summary is older than the summary interval.
+   */
+  void flush();
+};
+
+}
+
+#endif
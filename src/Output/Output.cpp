@@ -38,6 +38,8 @@
 namespace BaseLib
 {
 std::mutex Output::_outputMutex;
+AsyncOutputWriter Output::_asyncOutputWriter(Output::_outputMutex);
+LogRateLimiter Output::_rateLimiter(&Output::printSuppressedSummary);
 
 std::string Output::getPrefix()
 {
@@ -66,7 +68,10 @@ void Output::setOutputCallback(std::function<void(int32_t, const std::string&)>
 
 Output::Output() = default;
 
-Output::~Output() = default;
+Output::~Output()
+{
+	_rateLimiter.removeOwner(this);
+}
 
 void Output::init(SharedObjects* baseLib)
 {
@@ -89,143 +94,169 @@ std::string Output::getTimeString(int64_t time)
 		t = std::chrono::system_clock::to_time_t(timePoint);
 		milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(timePoint.time_since_epoch()).count() % 1000;
 	}
-	char timeString[50];
-	std::tm localTime{};
-	localtime_r(&t, &localTime);
-	strftime(&timeString[0], 50, &timeFormat[0], &localTime);
-	std::ostringstream timeStream;
-	timeStream << timeString << "." << std::setw(3) << std::setfill('0') << milliseconds;
-	return timeStream.str();
+	//localtime_r() and strftime() are expensive, so only call them once per second.
+	thread_local std::time_t cachedTime = -1;
+	thread_local std::string cachedTimeString;
+	if(t != cachedTime)
+	{
+		char timeString[50];
+		std::tm localTime{};
+		localtime_r(&t, &localTime);
+		strftime(&timeString[0], 50, &timeFormat[0], &localTime);
+		cachedTimeString = timeString;
+		cachedTime = t;
+	}
+	std::string result;
+	result.reserve(cachedTimeString.size() + 4);
+	result.append(cachedTimeString);
+	result.push_back('.');
+	result.push_back((char)('0' + milliseconds / 100));
+	result.push_back((char)('0' + (milliseconds / 10) % 10));
+	result.push_back((char)('0' + milliseconds % 10));
+	return result;
 }
 
-void Output::printEx(const std::string& file, uint32_t line, const std::string& function, const std::string& what)
+void Output::stopRateLimiterThread(ThreadManager& threadManager)
 {
-	if(_bl && _bl->debugLevel < 2) return;
-	std::string error;
-	if(!what.empty())
+	_rateLimiter.stopFlushThread(threadManager);
+}
+
+void Output::enableAsyncOutput()
+{
+	_asyncOutputWriter.start();
+}
+
+void Output::disableAsyncOutput()
+{
+	_asyncOutputWriter.stop();
+}
+
+bool Output::asyncOutputEnabled()
+{
+	return _asyncOutputWriter.running();
+}
+
+void Output::output(int32_t level, std::string&& text, size_t callbackOffset, bool errorOutput)
+{
+	bool stdOutput = _stdOutput;
+	if(!stdOutput && !_outputCallback) return;
+
+	if(_asyncOutputWriter.running())
 	{
-		error = _prefix + "Error in file " + file + " line " + std::to_string(line) + " in function " + function + ": " + what;
-        if(_stdOutput)
-        {
-            std::lock_guard<std::mutex> outputGuard(_outputMutex);
-            std::cout << getTimeString() << " " << error << std::endl;
-            std::cerr << getTimeString() << " " << error << std::endl;
-        }
+		AsyncOutputWriter::Entry entry;
+		entry.time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+		entry.level = level;
+		entry.stdOutput = stdOutput;
+		entry.errorOutput = errorOutput;
+		entry.callbackOffset = callbackOffset;
+		entry.text = std::move(text);
+		entry.callback = _outputCallback;
+		if(_asyncOutputWriter.enqueue(entry)) return;
+		text = std::move(entry.text); //Buffer is full or writer was stopped => output synchronously
 	}
-	else
+
+	if(stdOutput)
+	{
+		std::string timeString = getTimeString();
+		std::lock_guard<std::mutex> outputGuard(_outputMutex);
+		std::cout << timeString << " " << text << std::endl;
+		if(errorOutput) std::cerr << timeString << " " << text << std::endl;
+	}
+	if(_outputCallback)
 	{
-		error = _prefix + "Unknown error in file " + file + " line " + std::to_string(line) + " in function " + function + ".";
-        if(_stdOutput)
-        {
-            std::lock_guard<std::mutex> outputGuard(_outputMutex);
-            std::cout << getTimeString() << " " << error << std::endl;
-            std::cerr << getTimeString() << " " << error << std::endl;
-        }
+		std::lock_guard<std::mutex> outputGuard(_outputMutex);
+		if(callbackOffset == 0) _outputCallback(level, text);
+		else _outputCallback(level, text.substr(callbackOffset));
 	}
-    if(_outputCallback)
-    {
-        std::lock_guard<std::mutex> outputGuard(_outputMutex);
-        _outputCallback(2, error);
-    }
 }
 
-void Output::printCritical(const std::string& message)
+bool Output::textOutputNeeded()
 {
-	if(_bl && _bl->debugLevel < 1) return;
-	std::string error = _prefix + message;
-    if(_stdOutput)
-	{
-    	std::lock_guard<std::mutex> outputGuard(_outputMutex);
-    	std::cout << getTimeString() << " " << error << std::endl;
-    	std::cerr << getTimeString() << " " << error << std::endl;
-	}
-    if(_outputCallback)
-    {
-        std::lock_guard<std::mutex> outputGuard(_outputMutex);
-        _outputCallback(1, error);
-    }
+	if(!BinaryLog::isOpen()) return true;
+	if(_bl && _bl->settings.binaryLogOnly()) return false;
+	return _stdOutput || _outputCallback;
 }
 
-void Output::printError(const std::string& errorString)
+bool Output::levelEnabled(int32_t level)
+{
+	return !_bl || _bl->debugLevel >= level;
+}
+
+bool Output::rateLimitPassed(int32_t level, std::string_view file, uint32_t line)
+{
+	if(!_bl || _bl->settings.logRateLimit() == 0) return true;
+	uint64_t suppressedCount = 0;
+	bool print = _rateLimiter.check(_bl->threadManager, this, level, file, line, _bl->settings.logRateLimit(), _bl->settings.logRateLimitBurst(), _bl->settings.logSampleRate(), suppressedCount);
+	if(suppressedCount > 0) printSuppressedSummary(this, level, std::string(file), line, suppressedCount);
+	return print;
+}
+
+void Output::printSuppressedSummary(void* owner, int32_t level, const std::string& file, uint32_t line, uint64_t suppressedCount)
+{
+	auto output = (Output*)owner;
+	output->output(level, output->_prefix + std::to_string(suppressedCount) + " similar messages in file " + file + " line " + std::to_string(line) + " were suppressed.", 0, true);
+}
+
+void Output::printEx(const std::string& file, uint32_t line, const std::string& function, const std::string& what)
 {
 	if(_bl && _bl->debugLevel < 2) return;
-	std::string error = _prefix + errorString;
-	if(_stdOutput)
+	if(!rateLimitPassed(2, file, line)) return;
+	if(BinaryLog::isOpen())
 	{
-    	std::lock_guard<std::mutex> outputGuard(_outputMutex);
-    	std::cout << getTimeString() << " " << error << std::endl;
-    	std::cerr << getTimeString() << " " << error << std::endl;
+		static const uint32_t exceptionFormatId = BinaryLog::registerFormat("Error in file {} line {} in function {}: {}");
+		static const uint32_t unknownExceptionFormatId = BinaryLog::registerFormat("Unknown error in file {} line {} in function {}.");
+		if(!what.empty()) BinaryLog::write(2, _prefix, exceptionFormatId, file, line, function, what);
+		else BinaryLog::write(2, _prefix, unknownExceptionFormatId, file, line, function);
 	}
-    if(_outputCallback)
-    {
-        std::lock_guard<std::mutex> outputGuard(_outputMutex);
-        _outputCallback(2, error);
-    }
+	if(!textOutputNeeded()) return;
+	if(!what.empty()) output(2, _prefix + "Error in file " + file + " line " + std::to_string(line) + " in function " + function + ": " + what, 0, true);
+	else output(2, _prefix + "Unknown error in file " + file + " line " + std::to_string(line) + " in function " + function + ".", 0, true);
 }
 
-void Output::printWarning(const std::string& errorString)
+void Output::printCritical(const std::string& message)
+{
+	if(_bl && _bl->debugLevel < 1) return;
+	output(1, _prefix + message, 0, true);
+}
+
+void Output::printError(const std::string& errorString, const char* file, uint32_t line)
+{
+	if(_bl && _bl->debugLevel < 2) return;
+	if(!rateLimitPassed(2, file, line)) return;
+	output(2, _prefix + errorString, 0, true);
+}
+
+void Output::printWarning(const std::string& errorString, const char* file, uint32_t line)
 {
 	if(_bl && _bl->debugLevel < 3) return;
-	std::string error = _prefix + errorString;
-	if(_stdOutput)
-	{
-	    std::lock_guard<std::mutex> outputGuard(_outputMutex);
-    	std::cout << getTimeString() << " " << error << std::endl;
-    	std::cerr << getTimeString() << " " << error << std::endl;
-	}
-    if(_outputCallback)
-    {
-        std::lock_guard<std::mutex> outputGuard(_outputMutex);
-        _outputCallback(3, error);
-    }
+	if(!rateLimitPassed(3, file, line)) return;
+	output(3, _prefix + errorString, 0, true);
 }
 
 void Output::printInfo(const std::string& message)
 {
 	if(_bl && _bl->debugLevel < 4) return;
-    if(_stdOutput)
-    {
-        std::lock_guard<std::mutex> outputGuard(_outputMutex);
-        std::cout << getTimeString() << " " << _prefix << message << std::endl;
-    }
-    if(_outputCallback)
-    {
-        std::lock_guard<std::mutex> outputGuard(_outputMutex);
-        _outputCallback(4, message);
-    }
+	//The callback gets the message without prefix.
+	output(4, _prefix + message, _prefix.size(), false);
 }
 
 void Output::printDebug(const std::string& message, int32_t minDebugLevel)
 {
 	if(_bl && _bl->debugLevel < minDebugLevel) return;
-    if(_stdOutput)
-    {
-        std::lock_guard<std::mutex> outputGuard(_outputMutex);
-        std::cout << getTimeString() << " " << _prefix << message << std::endl;
-    }
-    if(_outputCallback)
-    {
-        std::lock_guard<std::mutex> outputGuard(_outputMutex);
-        _outputCallback(minDebugLevel, message);
-    }
+	if(BinaryLog::isOpen())
+	{
+		static const uint32_t debugFormatId = BinaryLog::registerFormat("{}");
+		BinaryLog::write(minDebugLevel, _prefix, debugFormatId, message);
+	}
+	if(!textOutputNeeded()) return;
+	//The callback gets the message without prefix.
+	output(minDebugLevel, _prefix + message, _prefix.size(), false);
 }
 
 void Output::printMessage(const std::string& message, int32_t minDebugLevel, bool errorLog)
 {
 	if(_bl && _bl->debugLevel < minDebugLevel) return;
-	std::string prefixedMessage = _prefix + message;
-
-	if(_stdOutput)
-    {
-        std::lock_guard<std::mutex> outputGuard(_outputMutex);
-        std::cout << getTimeString() << " " << prefixedMessage << std::endl;
-        if(minDebugLevel <= 3 && errorLog) std::cerr << getTimeString() << " " << prefixedMessage << std::endl;
-    }
-    if(_outputCallback)
-    {
-        std::lock_guard<std::mutex> outputGuard(_outputMutex);
-        _outputCallback(minDebugLevel, prefixedMessage);
-    }
+	output(minDebugLevel, _prefix + message, 0, minDebugLevel <= 3 && errorLog);
 }
 
 }
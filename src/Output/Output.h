@@ -34,8 +34,12 @@
 #include <cstdint>
 
 #include "../Exception.h"
+#include "AsyncOutputWriter.h"
+#include "BinaryLog.h"
+#include "LogRateLimiter.h"
 
 #include <string>
+#include <string_view>
 #include <memory>
 #include <vector>
 #include <map>
@@ -102,6 +106,7 @@ public:
 
 	/**
 	 * Sets a callback function which will be called for all messages. First parameter of the function is the debug level (1 = critical, 2 = error, 3 = warning, 4 = info, >= 5 = debug ), second parameter is the message string.
+	 * When asynchronous output is enabled (see "enableAsyncOutput()"), the callback is called from the background writer thread and not from the thread printing the message.
 	 */
 	void setOutputCallback(std::function<void(int32_t, const std::string&)> value);
 
@@ -112,7 +117,27 @@ public:
 	static std::string getTimeString(int64_t time = 0);
 
 	/**
-	 * Prints an error message with filename, line number and function name.
+	 * Enables asynchronous output for all Output objects. Messages are then queued in per-thread lock-free buffers and written by a background
+	 * thread, so logging threads don't block each other. Output callbacks are called from the background thread in this mode. Enabled by
+	 * "asyncLogging = true" in main.conf.
+	 */
+	static void enableAsyncOutput();
+
+	/**
+	 * Disables asynchronous output. All queued messages are written before this method returns.
+	 */
+	static void disableAsyncOutput();
+
+	static bool asyncOutputEnabled();
+
+	/**
+	 * Stops the thread of the rate limiter when it was started with "threadManager". Called before "threadManager" is destroyed.
+	 */
+	static void stopRateLimiterThread(ThreadManager& threadManager);
+
+	/**
+	 * Prints an error message with filename, line number and function name. When the binary log is open, the message is written to it, too. With "binaryLogOnly" set in main.conf it is then not formatted as text.
+	 * When "logRateLimit" is set, messages are rate limited per file and line.
 	 *
 	 * @param file The name of the file where the error occured.
 	 * @param line The line number where the error occured.
@@ -134,7 +159,7 @@ public:
 	void printCritical(const std::string& message);
 
 	/**
-	 * Prints an error message (debug level < 2).
+	 * Prints an error message (debug level < 2). When "logRateLimit" is set, messages are rate limited per call site.
 	 *
 	 * @see printCritical()
 	 * @see printWarning()
@@ -142,11 +167,13 @@ public:
 	 * @see printDebug()
 	 * @see printMessage()
 	 * @param message The error message.
+	 * @param file Set to the file of the caller automatically. Used to identify the call site for rate limiting.
+	 * @param line Set to the line of the caller automatically. Used to identify the call site for rate limiting.
 	 */
-	void printError(const std::string& message);
+	void printError(const std::string& message, const char* file = __builtin_FILE(), uint32_t line = __builtin_LINE());
 
 	/**
-	 * Prints a warning message (debug level < 3).
+	 * Prints a warning message (debug level < 3). When "logRateLimit" is set, messages are rate limited per call site.
 	 *
 	 * @see printCritical()
 	 * @see printError()
@@ -154,8 +181,10 @@ public:
 	 * @see printDebug()
 	 * @see printMessage()
 	 * @param message The warning message.
+	 * @param file Set to the file of the caller automatically. Used to identify the call site for rate limiting.
+	 * @param line Set to the line of the caller automatically. Used to identify the call site for rate limiting.
 	 */
-	void printWarning(const std::string& message);
+	void printWarning(const std::string& message, const char* file = __builtin_FILE(), uint32_t line = __builtin_LINE());
 
 	/**
 	 * Prints a info message (debug level < 4).
@@ -170,7 +199,7 @@ public:
 	void printInfo(const std::string& message);
 
 	/**
-	 * Prints a debug message (debug level < 5).
+	 * Prints a debug message (debug level < 5). When the binary log is open, the message is written to it, too. With "binaryLogOnly" set in main.conf it is then not formatted as text.
 	 *
 	 * @see printCritical()
 	 * @see printError()
@@ -196,10 +225,60 @@ public:
 	 */
 	void printMessage(const std::string& message, int32_t minDebugLevel = 0, bool errorLog = false);
 
+	/**
+	 * Prints a structured message. When the binary log is open (see BinaryLog::open()), the format ID and the arguments are written to it. The message
+	 * is only rendered and printed like "printMessage()" (with "errorLog" set for warnings and errors) when text output is needed, too (see
+	 * "textOutputNeeded()").
+	 *
+	 * @param level The debug level of the message.
+	 * @param formatId The ID returned by BinaryLog::registerFormat().
+	 * @param args The arguments for the placeholders in the format string.
+	 */
+	template<typename... Args>
+	void printStructured(int32_t level, uint32_t formatId, const Args&... args)
+	{
+		if(!levelEnabled(level)) return;
+		if(BinaryLog::isOpen()) BinaryLog::write(level, _prefix, formatId, args...);
+		if(textOutputNeeded()) printMessage(BinaryLog::format(formatId, args...), level, level <= 3);
+	}
+
 	/**
 	 * Calls the error callback function registered with the constructor.
 	 */
 private:
+	/**
+	 * Prints a message to standard output and calls the output callback.
+	 *
+	 * @param level The level passed to the output callback.
+	 * @param text The message including the prefix.
+	 * @param callbackOffset Only the text starting at this position is passed to the output callback.
+	 * @param errorOutput Also print the message to standard error.
+	 */
+	void output(int32_t level, std::string&& text, size_t callbackOffset, bool errorOutput);
+
+	bool levelEnabled(int32_t level);
+
+	/**
+	 * Returns "false" when a message written to the binary log doesn't need to be formatted as text. That is the case when "binaryLogOnly" is set in
+	 * main.conf or when neither standard output nor an output callback is enabled.
+	 */
+	bool textOutputNeeded();
+
+	/**
+	 * Applies the rate limit configured with "logRateLimit", "logRateLimitBurst" and "logSampleRate" in main.conf. When messages of the call site
+	 * were suppressed, a summary is printed.
+	 *
+	 * @param level The level of the message.
+	 * @param file The file of the call site.
+	 * @param line The line of the call site.
+	 * @return Returns "true" when the message should be printed.
+	 */
+	bool rateLimitPassed(int32_t level, std::string_view file, uint32_t line);
+
+	/**
+	 * Summary callback of the rate limiter.
+	 */
+	static void printSuppressedSummary(void* owner, int32_t level, const std::string& file, uint32_t line, uint64_t suppressedCount);
 
 	/**
 	 * Pointer to the common base library object.
@@ -221,6 +300,16 @@ private:
 	 */
 	static std::mutex _outputMutex;
 
+	/**
+	 * Writer used when asynchronous output is enabled.
+	 */
+	static AsyncOutputWriter _asyncOutputWriter;
+
+	/**
+	 * Token buckets for errors and warnings, shared by all instances.
+	 */
+	static LogRateLimiter _rateLimiter;
+
 	/**
 	 * Pointer to an optional callback function, which will be called whenever printDebug, printInfo, printEx, printWarning, printCritical or printError are called.
 	 */
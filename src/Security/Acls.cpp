@@ -64,6 +64,7 @@ void Acls::fromVariable(PVariable serializedData) {
     acl->fromVariable(element);
     _acls.emplace_back(std::move(acl));
   }
+  aclsChanged();
 }
 
 bool Acls::categoriesReadSet() {
@@ -231,6 +232,52 @@ bool Acls::variablesBuildingPartsRoomsCategoriesRolesDevicesWriteSet() {
 void Acls::clear() {
   std::lock_guard<std::mutex> aclsGuard(_aclsMutex);
   _acls.clear();
+  aclsChanged();
+}
+
+void Acls::aclsChanged() {
+  //Calculate the flags first, so lock-free readers never see intermediate values.
+  bool readAccessDependsOnPeerData = false;
+  bool writeAccessDependsOnPeerData = false;
+  bool readAccessPeerLevelOnly = true;
+  bool writeAccessPeerLevelOnly = true;
+  for (auto &acl : _acls) {
+    if (acl->roomsReadSet() || acl->buildingPartsReadSet() || acl->categoriesReadSet() || acl->rolesReadSet()) readAccessDependsOnPeerData = true;
+    if (acl->roomsWriteSet() || acl->buildingPartsWriteSet() || acl->categoriesWriteSet() || acl->rolesWriteSet()) writeAccessDependsOnPeerData = true;
+    if (acl->variablesReadSet() || readAccessDependsOnPeerData) readAccessPeerLevelOnly = false;
+    if (acl->variablesWriteSet() || writeAccessDependsOnPeerData) writeAccessPeerLevelOnly = false;
+  }
+  _variableReadAccessDependsOnPeerData = readAccessDependsOnPeerData;
+  _variableWriteAccessDependsOnPeerData = writeAccessDependsOnPeerData;
+  _variableReadAccessPeerLevelOnly = readAccessPeerLevelOnly;
+  _variableWriteAccessPeerLevelOnly = writeAccessPeerLevelOnly;
+
+  std::unique_lock<std::shared_mutex> cacheGuard(_variableAccessCacheMutex);
+  _variableReadAccessCache.clear();
+  _variableWriteAccessCache.clear();
+}
+
+bool Acls::getCachedVariableAccess(VariableAccessCache &cache, bool dependsOnPeerData, const std::shared_ptr<Systems::Peer> &peer, int32_t channel, const std::string &variableName, bool &access) {
+  std::shared_lock<std::shared_mutex> cacheGuard(_variableAccessCacheMutex);
+  auto channelIterator = cache.find(VariableAccessChannelKey{peer->getID(), channel});
+  if (channelIterator == cache.end()) return false;
+  if (dependsOnPeerData && channelIterator->second.peerDataVersion != peer->getAclDataVersion()) return false;
+  auto variableIterator = channelIterator->second.variables.find(variableName);
+  if (variableIterator == channelIterator->second.variables.end()) return false;
+  access = variableIterator->second;
+  return true;
+}
+
+void Acls::setCachedVariableAccess(VariableAccessCache &cache, bool dependsOnPeerData, uint64_t peerDataVersion, const std::shared_ptr<Systems::Peer> &peer, int32_t channel, const std::string &variableName, bool access) {
+  std::unique_lock<std::shared_mutex> cacheGuard(_variableAccessCacheMutex);
+  if (cache.size() >= 100000) cache.clear(); //Limit memory usage
+  auto &decisions = cache[VariableAccessChannelKey{peer->getID(), channel}];
+  if (dependsOnPeerData && decisions.peerDataVersion != peerDataVersion) {
+    //Also drops decisions made with an older version
+    decisions.variables.clear();
+    decisions.peerDataVersion = peerDataVersion;
+  }
+  decisions.variables[variableName] = access;
 }
 
 bool Acls::fromUser(std::string &userName) {
@@ -259,6 +306,7 @@ bool Acls::fromGroups(std::vector<uint64_t> &groupIds) {
       if (aclData->errorStruct) {
         _out.printError("Error: Could not get ACLs of group " + std::to_string(group) + ": " + aclData->structValue->at("faultString")->stringValue);
         _acls.clear();
+        aclsChanged();
         return false;
       }
 
@@ -271,6 +319,7 @@ bool Acls::fromGroups(std::vector<uint64_t> &groupIds) {
     outputPrefix = outputPrefix.substr(0, outputPrefix.size() - 2) + "): ";
     _out.setPrefix(outputPrefix);
 
+    aclsChanged();
     return true;
   }
   catch (const std::exception &ex) {
@@ -278,6 +327,7 @@ bool Acls::fromGroups(std::vector<uint64_t> &groupIds) {
   }
 
   _acls.clear();
+  aclsChanged();
   return false;
 }
 
@@ -950,17 +1000,26 @@ bool Acls::checkSystemVariableWriteAccess(Database::PSystemVariable systemVariab
 bool Acls::checkVariableReadAccess(std::shared_ptr<Systems::Peer> peer, int32_t channel, const std::string &variableName) {
   try {
     if (!peer) return false;
+    bool access = false;
+    if (getCachedVariableAccess(_variableReadAccessCache, _variableReadAccessDependsOnPeerData, peer, channel, variableName, access)) {
+      if (!access && _bl->debugLevel >= 5) _out.printDebug("Debug: Access denied to variable " + variableName + " on channel " + std::to_string(channel) + " of peer " + std::to_string(peer->getID()) + " (cached).");
+      return access;
+    }
+
     std::lock_guard<std::mutex> aclsGuard(_aclsMutex);
+    uint64_t peerDataVersion = peer->getAclDataVersion(); //Get the version before checking, so changes during the check invalidate the decision.
     bool acceptSet = false;
     for (auto &acl : _acls) {
       auto result = acl->checkVariableReadAccess(peer, channel, variableName);
       if (result == AclResult::error || result == AclResult::deny) {
         if (_bl->debugLevel >= 5) _out.printDebug("Debug: Access denied to variable " + variableName + " on channel " + std::to_string(channel) + " of peer " + std::to_string(peer->getID()) + " (1).");
+        if (result == AclResult::deny) setCachedVariableAccess(_variableReadAccessCache, _variableReadAccessDependsOnPeerData, peerDataVersion, peer, channel, variableName, false);
         return false;
       } else if (result == AclResult::accept) acceptSet = true;
     }
 
     if (!acceptSet && _bl->debugLevel >= 5) _out.printDebug("Debug: Access denied to system variable " + variableName + " (2).");
+    setCachedVariableAccess(_variableReadAccessCache, _variableReadAccessDependsOnPeerData, peerDataVersion, peer, channel, variableName, acceptSet);
     return acceptSet;
   }
   catch (const std::exception &ex) {
@@ -973,17 +1032,26 @@ bool Acls::checkVariableReadAccess(std::shared_ptr<Systems::Peer> peer, int32_t
 bool Acls::checkVariableWriteAccess(std::shared_ptr<Systems::Peer> peer, int32_t channel, const std::string &variableName) {
   try {
     if (!peer) return false;
+    bool access = false;
+    if (getCachedVariableAccess(_variableWriteAccessCache, _variableWriteAccessDependsOnPeerData, peer, channel, variableName, access)) {
+      if (!access && _bl->debugLevel >= 5) _out.printDebug("Debug: Access denied to variable " + variableName + " on channel " + std::to_string(channel) + " of peer " + std::to_string(peer->getID()) + " (cached).");
+      return access;
+    }
+
     std::lock_guard<std::mutex> aclsGuard(_aclsMutex);
+    uint64_t peerDataVersion = peer->getAclDataVersion(); //Get the version before checking, so changes during the check invalidate the decision.
     bool acceptSet = false;
     for (auto &acl : _acls) {
       auto result = acl->checkVariableWriteAccess(peer, channel, variableName);
       if (result == AclResult::error || result == AclResult::deny) {
         if (_bl->debugLevel >= 5) _out.printDebug("Debug: Access denied to variable " + variableName + " on channel " + std::to_string(channel) + " of peer " + std::to_string(peer->getID()) + " (1).");
+        if (result == AclResult::deny) setCachedVariableAccess(_variableWriteAccessCache, _variableWriteAccessDependsOnPeerData, peerDataVersion, peer, channel, variableName, false);
         return false;
       } else if (result == AclResult::accept) acceptSet = true;
     }
 
     if (!acceptSet && _bl->debugLevel >= 5) _out.printDebug("Debug: Access denied to system variable " + variableName + " (2).");
+    setCachedVariableAccess(_variableWriteAccessCache, _variableWriteAccessDependsOnPeerData, peerDataVersion, peer, channel, variableName, acceptSet);
     return acceptSet;
   }
   catch (const std::exception &ex) {
@@ -993,5 +1061,108 @@ bool Acls::checkVariableWriteAccess(std::shared_ptr<Systems::Peer> peer, int32_t
   return false;
 }
 
+std::vector<bool> Acls::checkVariablesAccess(bool write, const std::shared_ptr<Systems::Peer> &peer, const std::vector<std::pair<int32_t, const std::string *>> &variables) {
+  std::vector<bool> access(variables.size(), false);
+  try {
+    if (!peer || variables.empty()) return access;
+    VariableAccessCache &cache = write ? _variableWriteAccessCache : _variableReadAccessCache;
+
+    std::lock_guard<std::mutex> aclsGuard(_aclsMutex);
+    bool dependsOnPeerData = write ? _variableWriteAccessDependsOnPeerData : _variableReadAccessDependsOnPeerData;
+    bool peerLevelOnly = write ? _variableWriteAccessPeerLevelOnly : _variableReadAccessPeerLevelOnly;
+
+    if (peerLevelOnly) {
+      //All variables have the same access rights, so only check once. Metadata (channel -2) is not special here as no ACL checks variables.
+      bool acceptSet = false;
+      for (auto &acl : _acls) {
+        auto result = write ? acl->checkVariableWriteAccess(peer, variables.front().first, *variables.front().second) : acl->checkVariableReadAccess(peer, variables.front().first, *variables.front().second);
+        if (result == AclResult::error || result == AclResult::deny) {
+          acceptSet = false;
+          break;
+        } else if (result == AclResult::accept) acceptSet = true;
+      }
+      if (!acceptSet && _bl->debugLevel >= 5) _out.printDebug("Debug: Access denied to all variables of peer " + std::to_string(peer->getID()) + ".");
+      access.assign(variables.size(), acceptSet);
+      return access;
+    }
+
+    uint64_t peerDataVersion = peer->getAclDataVersion();
+    std::vector<size_t> uncachedIndexes;
+    {
+      std::shared_lock<std::shared_mutex> cacheGuard(_variableAccessCacheMutex);
+      auto channelIterator = cache.end();
+      for (size_t i = 0; i < variables.size(); i++) {
+        if (channelIterator == cache.end() || channelIterator->first.channel != variables[i].first) {
+          channelIterator = cache.find(VariableAccessChannelKey{peer->getID(), variables[i].first});
+          if (channelIterator != cache.end() && dependsOnPeerData && channelIterator->second.peerDataVersion != peerDataVersion) channelIterator = cache.end();
+        }
+        if (channelIterator != cache.end()) {
+          auto variableIterator = channelIterator->second.variables.find(*variables[i].second);
+          if (variableIterator != channelIterator->second.variables.end()) {
+            access[i] = variableIterator->second;
+            continue;
+          }
+        }
+        uncachedIndexes.push_back(i);
+      }
+    }
+
+    if (uncachedIndexes.empty()) return access;
+
+    std::vector<uint8_t> cacheable(uncachedIndexes.size(), 0);
+    for (size_t i = 0; i < uncachedIndexes.size(); i++) {
+      auto &variable = variables[uncachedIndexes[i]];
+      bool acceptSet = false;
+      bool error = false;
+      for (auto &acl : _acls) {
+        auto result = write ? acl->checkVariableWriteAccess(peer, variable.first, *variable.second) : acl->checkVariableReadAccess(peer, variable.first, *variable.second);
+        if (result == AclResult::error || result == AclResult::deny) {
+          acceptSet = false;
+          error = (result == AclResult::error);
+          break;
+        } else if (result == AclResult::accept) acceptSet = true;
+      }
+      access[uncachedIndexes[i]] = acceptSet;
+      cacheable[i] = !error;
+    }
+
+    {
+      std::unique_lock<std::shared_mutex> cacheGuard(_variableAccessCacheMutex);
+      if (cache.size() >= 100000) cache.clear(); //Limit memory usage
+      for (size_t i = 0; i < uncachedIndexes.size(); i++) {
+        if (!cacheable[i]) continue;
+        auto &variable = variables[uncachedIndexes[i]];
+        auto &decisions = cache[VariableAccessChannelKey{peer->getID(), variable.first}];
+        if (dependsOnPeerData && decisions.peerDataVersion != peerDataVersion) {
+          decisions.variables.clear();
+          decisions.peerDataVersion = peerDataVersion;
+        }
+        decisions.variables[*variable.second] = access[uncachedIndexes[i]];
+      }
+    }
+
+    if (_bl->debugLevel >= 5) {
+      size_t deniedCount = 0;
+      for (auto variableAccess : access) {
+        if (!variableAccess) deniedCount++;
+      }
+      if (deniedCount > 0) _out.printDebug("Debug: Access denied to " + std::to_string(deniedCount) + " of " + std::to_string(access.size()) + " variables of peer " + std::to_string(peer->getID()) + ".");
+    }
+  }
+  catch (const std::exception &ex) {
+    _out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    access.assign(variables.size(), false);
+  }
+  return access;
+}
+
+std::vector<bool> Acls::checkVariablesReadAccess(const std::shared_ptr<Systems::Peer> &peer, const std::vector<std::pair<int32_t, const std::string *>> &variables) {
+  return checkVariablesAccess(false, peer, variables);
+}
+
+std::vector<bool> Acls::checkVariablesWriteAccess(const std::shared_ptr<Systems::Peer> &peer, const std::vector<std::pair<int32_t, const std::string *>> &variables) {
+  return checkVariablesAccess(true, peer, variables);
+}
+
+}
 }
-}
\ No newline at end of file
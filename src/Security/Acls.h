@@ -36,7 +36,9 @@
 #include "Acl.h"
 #include "../Output/Output.h"
 
+#include <atomic>
 #include <mutex>
+#include <shared_mutex>
 
 namespace BaseLib {
 
@@ -55,6 +57,57 @@ class Acls {
   BaseLib::Output _out;
   std::mutex _aclsMutex;
   std::vector<PAcl> _acls;
+
+  struct VariableAccessChannelKey {
+    uint64_t peerId = 0;
+    int32_t channel = 0;
+
+    bool operator==(const VariableAccessChannelKey &other) const { return peerId == other.peerId && channel == other.channel; }
+  };
+
+  struct VariableAccessChannelKeyHash {
+    size_t operator()(const VariableAccessChannelKey &key) const { return std::hash<uint64_t>()(key.peerId ^ ((uint64_t)(uint32_t)key.channel << 32u)); }
+  };
+
+  /**
+   * Cached decisions for the variables of one peer channel. "peerDataVersion" is the value of "Peer::getAclDataVersion()" when the decisions were
+   * made.
+   */
+  struct VariableAccessDecisions {
+    uint64_t peerDataVersion = 0;
+    std::unordered_map<std::string, bool> variables;
+  };
+
+  typedef std::unordered_map<VariableAccessChannelKey, VariableAccessDecisions, VariableAccessChannelKeyHash> VariableAccessCache;
+
+  /**
+   * Protects the decision caches. Entries are only added while "_aclsMutex" is locked, so they can't be older than the ACLs.
+   */
+  std::shared_mutex _variableAccessCacheMutex;
+  VariableAccessCache _variableReadAccessCache;
+  VariableAccessCache _variableWriteAccessCache;
+
+  /**
+   * "true" when at least one ACL checks rooms, building parts, categories or roles. Cached decisions then depend on the peer's data version. Written
+   * while "_aclsMutex" is locked, but read without it.
+   */
+  std::atomic_bool _variableReadAccessDependsOnPeerData{false};
+  std::atomic_bool _variableWriteAccessDependsOnPeerData{false};
+
+  /**
+   * "true" when no ACL checks variables, rooms, building parts, categories or roles. All variables of a peer then have the same access rights.
+   */
+  std::atomic_bool _variableReadAccessPeerLevelOnly{true};
+  std::atomic_bool _variableWriteAccessPeerLevelOnly{true};
+
+  /**
+   * Rebuilds the precompiled decision data. Must be called with "_aclsMutex" locked every time "_acls" is changed.
+   */
+  void aclsChanged();
+
+  bool getCachedVariableAccess(VariableAccessCache &cache, bool dependsOnPeerData, const std::shared_ptr<Systems::Peer> &peer, int32_t channel, const std::string &variableName, bool &access);
+  void setCachedVariableAccess(VariableAccessCache &cache, bool dependsOnPeerData, uint64_t peerDataVersion, const std::shared_ptr<Systems::Peer> &peer, int32_t channel, const std::string &variableName, bool access);
+  std::vector<bool> checkVariablesAccess(bool write, const std::shared_ptr<Systems::Peer> &peer, const std::vector<std::pair<int32_t, const std::string *>> &variables);
  public:
   Acls(BaseLib::SharedObjects *bl, int32_t clientId);
   ~Acls();
@@ -355,6 +408,26 @@ class Acls {
    * @return This method returns "false" if (1) access is explicitly denied in one of the ACLs, (2) on error or (3) if the checked entity is not in at least one of the ACLs. It returns "true" if (1) the checked entity is not part of all ACLs or (2) if access is granted in at least one ACL.
    */
   bool checkVariableWriteAccess(std::shared_ptr<Systems::Peer> peer, int32_t channel, const std::string &variableName);
+
+  /**
+   * Checks if the ACLs grant read access to multiple variables of one peer. Faster than calling "checkVariableReadAccess()" for each variable as
+   * locks are only acquired once and rules not depending on the variable are only evaluated once.
+   *
+   * @param peer The peer to check.
+   * @param variables The channels and names of the variables to check. The names must not be nullptr.
+   * @return Returns one element per entry in "variables" which is "true" when "checkVariableReadAccess()" would return "true" for this variable.
+   */
+  std::vector<bool> checkVariablesReadAccess(const std::shared_ptr<Systems::Peer> &peer, const std::vector<std::pair<int32_t, const std::string *>> &variables);
+
+  /**
+   * Checks if the ACLs grant write access to multiple variables of one peer. Faster than calling "checkVariableWriteAccess()" for each variable as
+   * locks are only acquired once and rules not depending on the variable are only evaluated once.
+   *
+   * @param peer The peer to check.
+   * @param variables The channels and names of the variables to check. The names must not be nullptr.
+   * @return Returns one element per entry in "variables" which is "true" when "checkVariableWriteAccess()" would return "true" for this variable.
+   */
+  std::vector<bool> checkVariablesWriteAccess(const std::shared_ptr<Systems::Peer> &peer, const std::vector<std::pair<int32_t, const std::string *>> &variables);
 };
 typedef std::shared_ptr<Acls> PAcls;
 
@@ -80,7 +80,17 @@ void Settings::reset() {
   _factoryDatabasePath = "";
   _databaseBackupPath = "";
   _databaseMaxBackups = 10;
+  _databaseWriteBehindWindow = 0;
+  _peerLoadThreadCount = 0;
+  _deviceDescriptionLoadThreadCount = 0;
+  _deviceDescriptionCache = true;
   _logfilePath = "/var/log/homegear/";
+  _logRateLimit = 0;
+  _logRateLimitBurst = 20;
+  _logSampleRate = 0;
+  _asyncLogging = false;
+  _binaryLogPath = "";
+  _binaryLogOnly = false;
   _waitForCorrectTime = true;
   _prioritizeThreads = true;
   _maxTotalThreadCount = 0;
@@ -359,11 +369,45 @@ void Settings::load(const std::string &filename, const std::string &executablePa
           _databaseMaxBackups = Math::getNumber(value);
           if (_databaseMaxBackups > 10000) _databaseMaxBackups = 10000;
           if (!hideOutput && _bl->debugLevel >= 5) _bl->out.printDebug("Debug: databaseMaxBackups set to " + std::to_string(_databaseMaxBackups));
+        } else if (name == "databasewritebehindwindow") {
+          _databaseWriteBehindWindow = Math::getNumber(value);
+          if (_databaseWriteBehindWindow > 3600000) _databaseWriteBehindWindow = 3600000;
+          if (!hideOutput && _bl->debugLevel >= 5) _bl->out.printDebug("Debug: databaseWriteBehindWindow set to " + std::to_string(_databaseWriteBehindWindow));
+        } else if (name == "peerloadthreadcount") {
+          _peerLoadThreadCount = Math::getNumber(value);
+          if (_peerLoadThreadCount > 64) _peerLoadThreadCount = 64;
+          if (!hideOutput && _bl->debugLevel >= 5) _bl->out.printDebug("Debug: peerLoadThreadCount set to " + std::to_string(_peerLoadThreadCount));
+        } else if (name == "devicedescriptionloadthreadcount") {
+          _deviceDescriptionLoadThreadCount = Math::getNumber(value);
+          if (_deviceDescriptionLoadThreadCount > 64) _deviceDescriptionLoadThreadCount = 64;
+          if (!hideOutput && _bl->debugLevel >= 5) _bl->out.printDebug("Debug: deviceDescriptionLoadThreadCount set to " + std::to_string(_deviceDescriptionLoadThreadCount));
+        } else if (name == "devicedescriptioncache") {
+          _deviceDescriptionCache = (HelperFunctions::toLower(value) == "true");
+          if (!hideOutput && _bl->debugLevel >= 5) _bl->out.printDebug("Debug: deviceDescriptionCache set to " + std::to_string(_deviceDescriptionCache));
         } else if (name == "logfilepath") {
           _logfilePath = value;
           if (_logfilePath.empty()) _logfilePath = "/var/log/homegear/";
           if (_logfilePath.back() != '/') _logfilePath.push_back('/');
           if (!hideOutput && _bl->debugLevel >= 5) _bl->out.printDebug("Debug: logfilePath set to " + _logfilePath);
+        } else if (name == "logratelimit") {
+          _logRateLimit = Math::getNumber(value);
+          if (!hideOutput && _bl->debugLevel >= 5) _bl->out.printDebug("Debug: logRateLimit set to " + std::to_string(_logRateLimit));
+        } else if (name == "logratelimitburst") {
+          _logRateLimitBurst = Math::getNumber(value);
+          if (_logRateLimitBurst < 1) _logRateLimitBurst = 1;
+          if (!hideOutput && _bl->debugLevel >= 5) _bl->out.printDebug("Debug: logRateLimitBurst set to " + std::to_string(_logRateLimitBurst));
+        } else if (name == "logsamplerate") {
+          _logSampleRate = Math::getNumber(value);
+          if (!hideOutput && _bl->debugLevel >= 5) _bl->out.printDebug("Debug: logSampleRate set to " + std::to_string(_logSampleRate));
+        } else if (name == "asynclogging") {
+          _asyncLogging = (HelperFunctions::toLower(value) == "true");
+          if (!hideOutput && _bl->debugLevel >= 5) _bl->out.printDebug("Debug: asyncLogging set to " + std::to_string(_asyncLogging));
+        } else if (name == "binarylogpath") {
+          _binaryLogPath = value;
+          if (!hideOutput && _bl->debugLevel >= 5) _bl->out.printDebug("Debug: binaryLogPath set to " + _binaryLogPath);
+        } else if (name == "binarylogonly") {
+          _binaryLogOnly = (HelperFunctions::toLower(value) == "true");
+          if (!hideOutput && _bl->debugLevel >= 5) _bl->out.printDebug("Debug: binaryLogOnly set to " + std::to_string(_binaryLogOnly));
         } else if (name == "waitforcorrecttime") {
           _waitForCorrectTime = (HelperFunctions::toLower(value) == "true");
           if (!hideOutput && _bl->debugLevel >= 5) _bl->out.printDebug("Debug: waitForCorrectTime set to " + std::to_string(_waitForCorrectTime));
@@ -721,6 +765,11 @@ void Settings::load(const std::string &filename, const std::string &executablePa
     }
 
     fclose(fin);
+    //Output::init() is called before the settings are loaded, so asynchronous output is enabled here.
+    if (_asyncLogging) Output::enableAsyncOutput();
+    if (!_binaryLogPath.empty() && !BinaryLog::isOpen() && !BinaryLog::open(_binaryLogPath) && !hideOutput) {
+      _bl->out.printError("Error: Could not open binary log " + _binaryLogPath + ".");
+    }
     _lastModified = _bl->io.getFileLastModifiedTime(filename);
     _clientSettingsLastModified = _bl->io.getFileLastModifiedTime(_clientSettingsPath);
     _serverSettingsLastModified = _bl->io.getFileLastModifiedTime(_serverSettingsPath);
@@ -89,7 +89,17 @@ class Settings {
   std::string databaseBackupPath() { return _databaseBackupPath; }
   std::string factoryDatabaseBackupPath() { return _factoryDatabaseBackupPath; }
   uint32_t databaseMaxBackups() { return _databaseMaxBackups; }
+  uint32_t databaseWriteBehindWindow() { return _databaseWriteBehindWindow; }
+  uint32_t peerLoadThreadCount() { return _peerLoadThreadCount; }
+  uint32_t deviceDescriptionLoadThreadCount() { return _deviceDescriptionLoadThreadCount; }
+  bool deviceDescriptionCache() { return _deviceDescriptionCache; }
   std::string logfilePath() { return _logfilePath; }
+  uint32_t logRateLimit() { return _logRateLimit; }
+  uint32_t logRateLimitBurst() { return _logRateLimitBurst; }
+  uint32_t logSampleRate() { return _logSampleRate; }
+  bool asyncLogging() { return _asyncLogging; }
+  std::string binaryLogPath() { return _binaryLogPath; }
+  bool binaryLogOnly() { return _binaryLogOnly; }
   bool waitForCorrectTime() { return _waitForCorrectTime; }
   bool prioritizeThreads() { return _prioritizeThreads; }
   uint32_t maxTotalThreadCount() { return _maxTotalThreadCount; }
@@ -231,7 +241,17 @@ class Settings {
   std::string _databaseBackupPath;
   std::string _factoryDatabaseBackupPath;
   uint32_t _databaseMaxBackups = 10;
+  uint32_t _databaseWriteBehindWindow = 0;
+  uint32_t _peerLoadThreadCount = 0;
+  uint32_t _deviceDescriptionLoadThreadCount = 0;
+  bool _deviceDescriptionCache = true;
   std::string _logfilePath;
+  uint32_t _logRateLimit = 0;
+  uint32_t _logRateLimitBurst = 20;
+  uint32_t _logSampleRate = 0;
+  bool _asyncLogging = false;
+  std::string _binaryLogPath;
+  bool _binaryLogOnly = false;
   bool _waitForCorrectTime = true;
   bool _prioritizeThreads = true;
   uint32_t _maxTotalThreadCount = 0;
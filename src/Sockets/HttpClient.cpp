@@ -163,6 +163,31 @@ void HttpClient::get(const std::string &path, Http &http, const std::string &add
   sendRequest(getRequest, http);
 }
 
+void HttpClient::get(const std::string &path, Http &http, const Http::ContentCallback &contentCallback, const std::string &additionalHeaders) {
+  http.setContentCallback(contentCallback);
+  try {
+    get(path, http, additionalHeaders);
+  }
+  catch (...) {
+    http.setContentCallback(nullptr);
+    throw;
+  }
+  //Don't keep references of the caller.
+  http.setContentCallback(nullptr);
+}
+
+void HttpClient::get(const std::vector<std::string> &paths, std::vector<Http> &responses, const std::string &additionalHeaders) {
+  std::vector<std::string> requests;
+  requests.reserve(paths.size());
+  for (auto &path : paths) {
+    std::string fixedPath = path;
+    if (fixedPath.empty()) fixedPath = "/";
+    requests.emplace_back("GET " + fixedPath + " HTTP/1.1\r\nUser-Agent: " + _userAgent + "\r\nHost: " + _hostname + ":" + std::to_string(_port) + "\r\nConnection: " + (_keepAlive ? "Keep-Alive" : "Close") + "\r\n" + additionalHeaders + "\r\n");
+    if (_bl->debugLevel >= 5) _bl->out.printDebug("Debug: HTTP request: " + requests.back());
+  }
+  sendRequests(requests, responses);
+}
+
 void HttpClient::patch(const std::string &path, std::string &dataIn, std::string &dataOut, const std::string &additionalHeaders) {
   std::string fixedPath = path;
   if (fixedPath.empty()) fixedPath = "/";
@@ -235,6 +260,8 @@ void HttpClient::sendRequest(const std::string &request, std::string &response,
 
 void HttpClient::sendRequest(const std::string &request, Http &http, bool responseIsHeaderOnly) {
   if (request.empty()) throw HttpClientException("Request is empty.");
+  //Streamed content can't be taken back, so the request must not be resent once content was passed on.
+  bool streaming = http.hasContentCallback();
 
   std::lock_guard<std::mutex> socketGuard(_socketMutex);
   //The loop is implemented to resend a request in case we get an EOF on first read.
@@ -295,6 +322,14 @@ void HttpClient::sendRequest(const std::string &request, Http &http, bool respon
       }
       catch (const C1Net::ClosedException &ex) {
         _socket->Shutdown();
+        if (streaming && http.dataProcessingStarted()) {
+          //Without "Content-Length" and chunked encoding the content ends when the connection is closed.
+          if (http.getHeader().contentLength == 0 && !(http.getHeader().transferEncoding & Http::TransferEncoding::Enum::chunked)) {
+            http.setFinished();
+            break;
+          }
+          throw HttpClientException("Socket closed during read.");
+        }
         if (i == 1) throw HttpClientException("Socket closed during read.");
         break;
       }
@@ -336,7 +371,7 @@ void HttpClient::sendRequest(const std::string &request, Http &http, bool respon
         if (!_keepAlive) _socket->Shutdown();
         throw HttpClientException("Unable to read from HTTP server \"" + _hostname + "\": " + ex.what(), ex.responseCode());
       }
-      if (http.getContentSize() > 104857600 || http.getHeader().contentLength > 104857600) {
+      if (!streaming && (http.getContentSize() > 104857600 || http.getHeader().contentLength > 104857600)) {
         if (!_keepAlive) _socket->Shutdown();
         throw HttpClientException("Unable to read from HTTP server \"" + _hostname + "\": Packet with data larger than 100 MiB received.");
       }
@@ -348,4 +383,112 @@ void HttpClient::sendRequest(const std::string &request, Http &http, bool respon
   }
 }
 
+void HttpClient::sendRequests(const std::vector<std::string> &requests, std::vector<Http> &responses) {
+  responses.clear();
+  if (requests.empty()) return;
+  if (!_keepAlive) throw HttpClientException("Pipelining requires a keep-alive connection.");
+  responses.resize(requests.size());
+
+  std::lock_guard<std::mutex> socketGuard(_socketMutex);
+  _rawContent.clear();
+  size_t currentResponse = 0;
+  //Like in sendRequest(), unanswered requests are resent once when the server closed the idle connection.
+  for (uint32_t i = 0; i < 2 && currentResponse < responses.size(); i++) {
+    try {
+      if (!_socket->Connected()) {
+        _socket->Open();
+      }
+    }
+    catch (const C1Net::TimeoutException &ex) {
+      throw HttpClientTimeOutException(std::string(ex.what()));
+    }
+    catch (const C1Net::Exception &ex) {
+      throw HttpClientException("Unable to connect to HTTP server \"" + _hostname + "\": " + ex.what());
+    }
+
+    //Send all outstanding requests at once.
+    std::string pipelinedRequests;
+    for (size_t j = currentResponse; j < requests.size(); j++) {
+      pipelinedRequests.append(requests[j]);
+    }
+    try {
+      if (_bl->debugLevel >= 5) _bl->out.printDebug("Debug: Sending " + std::to_string(requests.size() - currentResponse) + " pipelined requests to HTTP server \"" + _hostname + "\".");
+      _socket->Send((uint8_t *)pipelinedRequests.data(), pipelinedRequests.size());
+    }
+    catch (const C1Net::ClosedException &ex) {
+      _socket->Shutdown();
+      if (i == 1) throw HttpClientException("Socket closed during write.");
+      continue;
+    }
+    catch (const C1Net::TimeoutException &ex) {
+      //It's unknown which requests were sent completely, so the connection can't be used anymore.
+      _socket->Shutdown();
+      throw HttpClientTimeOutException(std::string(ex.what()));
+    }
+    catch (const C1Net::Exception &ex) {
+      _socket->Shutdown();
+      if (i == 1) throw HttpClientException("Unable to write to HTTP server \"" + _hostname + "\": " + ex.what());
+      continue;
+    }
+
+    const int32_t bufferMax = 4096;
+    std::array<char, bufferMax + 1> buffer{};
+    bool moreData = false;
+    bool closed = false;
+    while (currentResponse < responses.size()) {
+      size_t receivedBytes = 0;
+      try {
+        receivedBytes = _socket->Read((uint8_t *)buffer.data(), bufferMax, moreData);
+      }
+      catch (const C1Net::TimeoutException &ex) {
+        _socket->Shutdown();
+        throw HttpClientTimeOutException("Unable to read from HTTP server \"" + _hostname + "\": " + ex.what());
+      }
+      catch (const C1Net::ClosedException &ex) {
+        _socket->Shutdown();
+        //A partially received response can't be completed by resending.
+        if (i == 1 || responses.at(currentResponse).headerProcessingStarted()) {
+          throw HttpClientSocketClosedException("Socket closed during read after " + std::to_string(currentResponse) + " of " + std::to_string(responses.size()) + " responses.");
+        }
+        closed = true;
+        break;
+      }
+      catch (const C1Net::Exception &ex) {
+        _socket->Shutdown();
+        throw HttpClientException("Unable to read from HTTP server \"" + _hostname + "\": " + ex.what());
+      }
+
+      if (_keepRawContent) _rawContent.insert(_rawContent.end(), buffer.begin(), buffer.begin() + receivedBytes);
+
+      //Http uses string functions to process the buffer. So make sure, they don't read beyond the received data.
+      buffer.at(receivedBytes) = '\0';
+
+      //One read can contain the end of one response and the beginning of the next.
+      char *position = buffer.data();
+      int32_t remainingBytes = receivedBytes;
+      while (remainingBytes > 0 && currentResponse < responses.size()) {
+        Http &http = responses.at(currentResponse);
+        int32_t processedBytes = 0;
+        try {
+          processedBytes = http.process(position, remainingBytes);
+        }
+        catch (const HttpException &ex) {
+          _socket->Shutdown();
+          throw HttpClientException("Unable to read from HTTP server \"" + _hostname + "\": " + ex.what(), ex.responseCode());
+        }
+        if (http.getContentSize() > 104857600 || http.getHeader().contentLength > 104857600) {
+          _socket->Shutdown();
+          throw HttpClientException("Unable to read from HTTP server \"" + _hostname + "\": Packet with data larger than 100 MiB received.");
+        }
+
+        if (http.isFinished()) currentResponse++;
+        if (processedBytes <= 0 || processedBytes >= remainingBytes) break;
+        position += processedBytes;
+        remainingBytes -= processedBytes;
+      }
+    }
+    if (!closed) break;
+  }
+}
+
 }
@@ -200,6 +200,16 @@ class HttpClient {
    */
   void sendRequest(const std::string &request, Http &response, bool responseIsHeaderOnly = false);
 
+  /*
+   * Sends multiple HTTP requests on the keep-alive connection without waiting for the responses in between (HTTP/1.1 pipelining) and returns the responses.
+   * Only pipeline idempotent requests (e. g. GET), as requests that weren't answered are resent once when the server closed the connection. Requires
+   * keep-alive and responses with "Content-Length" or chunked encoding.
+   *
+   * @param[in] requests The HTTP requests including the full header.
+   * @param[out] responses The HTTP responses in the order of "requests".
+   */
+  void sendRequests(const std::vector<std::string> &requests, std::vector<Http> &responses);
+
   /*
    * Sends an HTTP GET request and returns the response. This method can be used to download files.
    *
@@ -232,6 +242,25 @@ class HttpClient {
    */
   void get(const std::string &path, Http &data, const std::string &additionalHeaders = "");
 
+  /*
+   * Sends an HTTP GET request and passes the content to "contentCallback" while it is received instead of storing it. Use this for large downloads and
+   * chunked event streams. The request is not resent once content was passed on.
+   *
+   * @param[in] url The path of the file to get.
+   * @param[out] http The HTTP response. Only the header is filled.
+   * @param[in] contentCallback Called for every received part of the content.
+   */
+  void get(const std::string &path, Http &http, const Http::ContentCallback &contentCallback, const std::string &additionalHeaders = "");
+
+  /*
+   * Sends multiple HTTP GET requests on the keep-alive connection without waiting for the responses in between (HTTP/1.1 pipelining).
+   *
+   * @param[in] paths The paths of the files to get.
+   * @param[out] responses The HTTP responses in the order of "paths".
+   * @see sendRequests()
+   */
+  void get(const std::vector<std::string> &paths, std::vector<Http> &responses, const std::string &additionalHeaders = "");
+
   /*
    * Sends an HTTP PATCH request and returns the response.
    *
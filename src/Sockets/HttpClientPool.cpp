@@ -0,0 +1,247 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "HttpClientPool.h"
+#include "../BaseLib.h"
+
+#include <algorithm>
+
+#include <sys/socket.h>
+
+namespace BaseLib {
+
+HttpClientPool::Lease::Lease(Lease &&other) noexcept {
+  _pool = other._pool;
+  _host = std::move(other._host);
+  _client = std::move(other._client);
+  other._pool = nullptr;
+}
+
+HttpClientPool::Lease &HttpClientPool::Lease::operator=(Lease &&other) noexcept {
+  if (this != &other) {
+    release();
+    _pool = other._pool;
+    _host = std::move(other._host);
+    _client = std::move(other._client);
+    other._pool = nullptr;
+  }
+  return *this;
+}
+
+HttpClientPool::Lease::~Lease() {
+  release();
+}
+
+void HttpClientPool::Lease::discard() {
+  if (!_pool || !_client) return;
+  _pool->release(_host, _client, false);
+  _pool = nullptr;
+  _host.reset();
+}
+
+void HttpClientPool::Lease::release() {
+  if (!_pool || !_client) return;
+  _pool->release(_host, _client, true);
+  _pool = nullptr;
+  _host.reset();
+}
+
+HttpClientPool::HttpClientPool(BaseLib::SharedObjects *baseLib, uint32_t maxConnectionsPerHost, uint32_t idleTimeout) {
+  _bl = baseLib;
+  _maxConnectionsPerHost = maxConnectionsPerHost == 0 ? 1 : maxConnectionsPerHost;
+  _idleTimeout = idleTimeout;
+}
+
+HttpClientPool::~HttpClientPool() {
+  clear();
+}
+
+std::string HttpClientPool::getKey(const HostInfo &hostInfo) {
+  //The client key doesn't need to be part of the key, as it belongs to the client certificate.
+  return hostInfo.hostname + '\0' + std::to_string(hostInfo.port) + '\0' + (hostInfo.useSsl ? '1' : '0') + (hostInfo.verifyCertificate ? '1' : '0') + '\0' + hostInfo.caFile + '\0' + hostInfo.caData + '\0' + hostInfo.certPath + '\0'
+      + hostInfo.certData + '\0' + hostInfo.keyPath;
+}
+
+HttpClientPool::Lease HttpClientPool::acquire(const HostInfo &hostInfo) {
+  if (hostInfo.hostname.empty()) throw HttpClientException("The provided hostname is empty.");
+
+  Lease lease;
+  std::vector<std::shared_ptr<HttpClient>> closedClients;
+  std::unique_lock<std::mutex> hostsGuard(_hostsMutex);
+  int64_t now = HelperFunctions::getTime();
+  evictIdle(now, closedClients);
+
+  auto &hostEntry = _hosts[getKey(hostInfo)];
+  if (!hostEntry) hostEntry = std::make_shared<Host>();
+  std::shared_ptr<Host> host = hostEntry;
+
+  uint32_t acquireTimeout = _acquireTimeout;
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(acquireTimeout);
+  auto predicate = [&] { return !host->idleConnections.empty() || host->leasedConnections < _maxConnectionsPerHost; };
+  if (!predicate()) {
+    //Keeps evictIdle() from removing the host while waiting. Otherwise new callers would create a second entry for the same host and exceed the limit.
+    host->waiters++;
+    hostsGuard.unlock();
+    disconnect(closedClients);
+    hostsGuard.lock();
+    bool available = true;
+    if (acquireTimeout == 0) host->connectionReleased.wait(hostsGuard, predicate);
+    else available = host->connectionReleased.wait_until(hostsGuard, deadline, predicate);
+    host->waiters--;
+    if (!available) throw HttpClientTimeOutException("No free connection to HTTP server \"" + hostInfo.hostname + "\" within " + std::to_string(acquireTimeout) + " ms.");
+  }
+
+  //Health check: Skip connections closed by the server in the meantime. The most recently used connection is the least likely to be closed.
+  while (!host->idleConnections.empty()) {
+    Connection connection = std::move(host->idleConnections.back());
+    host->idleConnections.pop_back();
+    if (isAlive(connection.client, hostInfo.useSsl)) {
+      lease._client = std::move(connection.client);
+      break;
+    }
+    closedClients.push_back(std::move(connection.client));
+  }
+  host->leasedConnections++;
+  lease._pool = this;
+  lease._host = host;
+  hostsGuard.unlock();
+  disconnect(closedClients);
+  if (lease._client) return lease;
+
+  //Create the connection without holding the lock. The slot is already reserved by leasedConnections.
+  try {
+    lease._client = std::make_shared<HttpClient>(_bl,
+                                                 hostInfo.hostname,
+                                                 hostInfo.port,
+                                                 true,
+                                                 hostInfo.useSsl,
+                                                 hostInfo.verifyCertificate,
+                                                 hostInfo.caFile,
+                                                 hostInfo.caData,
+                                                 hostInfo.certPath,
+                                                 hostInfo.certData,
+                                                 hostInfo.keyPath,
+                                                 hostInfo.keyData);
+    lease._client->setTimeout(_timeout);
+  }
+  catch (...) {
+    std::shared_ptr<HttpClient> client;
+    release(lease._host, client, false);
+    lease._pool = nullptr;
+    throw;
+  }
+  return lease;
+}
+
+void HttpClientPool::release(const std::shared_ptr<Host> &host, std::shared_ptr<HttpClient> &client, bool reuse) {
+  std::shared_ptr<HttpClient> closedClient;
+  {
+    std::lock_guard<std::mutex> hostsGuard(_hostsMutex);
+    if (host->leasedConnections > 0) host->leasedConnections--;
+    if (client && reuse && client->connected()) {
+      Connection connection;
+      connection.client = std::move(client);
+      connection.lastUsed = HelperFunctions::getTime();
+      host->idleConnections.push_back(std::move(connection));
+    } else closedClient = std::move(client);
+  }
+  host->connectionReleased.notify_one();
+  if (closedClient) closedClient->disconnect();
+}
+
+bool HttpClientPool::isAlive(const std::shared_ptr<HttpClient> &client, bool useSsl) {
+  if (!client->connected()) return false;
+  auto socket = client->getSocket();
+  if (!socket) return false;
+  int32_t socketDescriptor = socket->GetHandle();
+  if (socketDescriptor == -1) return false;
+
+  char byte = 0;
+  ssize_t result = recv(socketDescriptor, &byte, 1, MSG_PEEK | MSG_DONTWAIT);
+  if (result == 0) return false; //The server closed the connection.
+  if (result == -1) return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+  //Unsolicited data. With TLS this can be a record like a session ticket. Without TLS it would be mixed up with the next response.
+  return useSsl;
+}
+
+void HttpClientPool::disconnect(std::vector<std::shared_ptr<HttpClient>> &clients) {
+  for (auto &client : clients) {
+    client->disconnect();
+  }
+  clients.clear();
+}
+
+void HttpClientPool::evictIdle() {
+  std::vector<std::shared_ptr<HttpClient>> closedClients;
+  {
+    std::lock_guard<std::mutex> hostsGuard(_hostsMutex);
+    evictIdle(HelperFunctions::getTime(), closedClients);
+  }
+  disconnect(closedClients);
+}
+
+void HttpClientPool::evictIdle(int64_t now, std::vector<std::shared_ptr<HttpClient>> &closedClients) {
+  for (auto hostIterator = _hosts.begin(); hostIterator != _hosts.end();) {
+    auto &connections = hostIterator->second->idleConnections;
+    //Check every connection, as connections closed by the server can be anywhere in the list.
+    for (auto &connection : connections) {
+      if (now - connection.lastUsed > _idleTimeout || !connection.client->connected()) closedClients.push_back(std::move(connection.client));
+    }
+    connections.erase(std::remove_if(connections.begin(), connections.end(), [](const Connection &connection) { return !connection.client; }), connections.end());
+
+    if (connections.empty() && hostIterator->second->leasedConnections == 0 && hostIterator->second->waiters == 0) hostIterator = _hosts.erase(hostIterator);
+    else ++hostIterator;
+  }
+}
+
+void HttpClientPool::clear() {
+  std::vector<std::shared_ptr<HttpClient>> closedClients;
+  {
+    std::lock_guard<std::mutex> hostsGuard(_hostsMutex);
+    for (auto &host : _hosts) {
+      for (auto &connection : host.second->idleConnections) {
+        closedClients.push_back(std::move(connection.client));
+      }
+      host.second->idleConnections.clear();
+    }
+  }
+  disconnect(closedClients);
+}
+
+size_t HttpClientPool::idleCount() {
+  std::lock_guard<std::mutex> hostsGuard(_hostsMutex);
+  size_t count = 0;
+  for (auto &host : _hosts) {
+    count += host.second->idleConnections.size();
+  }
+  return count;
+}
+
+}
@@ -0,0 +1,199 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef LIBHOMEGEAR_BASE_HTTPCLIENTPOOL_H
+#define LIBHOMEGEAR_BASE_HTTPCLIENTPOOL_H
+
+#include "HttpClient.h"
+
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace BaseLib {
+
+class SharedObjects;
+
+/**
+ * Pool of keep-alive HTTP connections. Connections are grouped by host, port and TLS settings. Up to "maxConnectionsPerHost" requests to the same host can
+ * run at the same time; additional callers wait for a free connection. Idle connections are reused (which also saves the TLS handshake) until they were
+ * unused for "idleTimeout" milliseconds. The class is thread safe. The pool must outlive all leases.
+ *
+ * Example:
+ *   HttpClientPool::HostInfo hostInfo;
+ *   hostInfo.hostname = "api.example.com";
+ *   hostInfo.port = 443;
+ *   hostInfo.useSsl = true;
+ *   std::string response;
+ *   pool.acquire(hostInfo)->get("/status", response);
+ */
+class HttpClientPool {
+ public:
+  struct HostInfo {
+    std::string hostname;
+    int32_t port = 80;
+    bool useSsl = false;
+    bool verifyCertificate = true;
+    std::string caFile;
+    std::string caData;
+    std::string certPath;
+    std::string certData;
+    std::string keyPath;
+    std::shared_ptr<Security::SecureVector<uint8_t>> keyData;
+  };
+
+ private:
+  struct Connection {
+    std::shared_ptr<HttpClient> client;
+    int64_t lastUsed = 0;
+  };
+
+  struct Host {
+    std::vector<Connection> idleConnections;
+    uint32_t leasedConnections = 0;
+    /**
+     * Number of callers waiting in acquire(). Hosts with waiters are not evicted.
+     */
+    uint32_t waiters = 0;
+    std::condition_variable connectionReleased;
+  };
+
+ public:
+  /**
+   * Exclusive access to one pooled connection. The connection is returned to the pool when the lease is destroyed.
+   */
+  class Lease {
+   public:
+    Lease() = default;
+    Lease(const Lease &) = delete;
+    Lease &operator=(const Lease &) = delete;
+    Lease(Lease &&other) noexcept;
+    Lease &operator=(Lease &&other) noexcept;
+    ~Lease();
+
+    HttpClient *operator->() const { return _client.get(); }
+    HttpClient &operator*() const { return *_client; }
+    explicit operator bool() const { return (bool)_client; }
+
+    /**
+     * Closes the connection instead of returning it to the pool, e. g. after the server announced "Connection: close".
+     */
+    void discard();
+   private:
+    friend class HttpClientPool;
+
+    HttpClientPool *_pool = nullptr;
+    std::shared_ptr<Host> _host;
+    std::shared_ptr<HttpClient> _client;
+
+    void release();
+  };
+
+  /**
+   * Constructor
+   *
+   * @param baseLib The common base library object.
+   * @param maxConnectionsPerHost The maximum number of connections to one host.
+   * @param idleTimeout Idle connections are closed after this time in milliseconds.
+   */
+  explicit HttpClientPool(BaseLib::SharedObjects *baseLib, uint32_t maxConnectionsPerHost = 4, uint32_t idleTimeout = 60000);
+  HttpClientPool(const HttpClientPool &) = delete;
+  HttpClientPool &operator=(const HttpClientPool &) = delete;
+  virtual ~HttpClientPool();
+
+  /**
+   * Sets the socket timeout of new connections in milliseconds.
+   */
+  void setTimeout(uint32_t value) { _timeout = value; }
+
+  /**
+   * Sets the maximum time in milliseconds acquire() waits for a free connection. 0 waits forever.
+   */
+  void setAcquireTimeout(uint32_t value) { _acquireTimeout = value; }
+
+  /**
+   * Returns a connection to the host. Prefers the most recently used idle connection. Creates a new one when none is idle and the limit is not reached.
+   * Otherwise waits until a connection is released.
+   *
+   * @throws HttpClientTimeOutException Thrown when no connection became available within the acquire timeout.
+   * @throws HttpClientException Thrown when the host info is invalid.
+   */
+  Lease acquire(const HostInfo &hostInfo);
+
+  /**
+   * Closes all connections which were idle for longer than the idle timeout. Called by acquire(), so only needs to be called when the pool isn't used for a
+   * long time.
+   */
+  void evictIdle();
+
+  /**
+   * Closes all idle connections.
+   */
+  void clear();
+
+  /**
+   * Returns the number of idle connections in the pool.
+   */
+  size_t idleCount();
+ private:
+  BaseLib::SharedObjects *_bl = nullptr;
+  uint32_t _maxConnectionsPerHost = 4;
+  int64_t _idleTimeout = 60000;
+  std::atomic<uint32_t> _timeout{5000};
+  std::atomic<uint32_t> _acquireTimeout{0};
+  std::mutex _hostsMutex;
+  std::map<std::string, std::shared_ptr<Host>> _hosts;
+
+  static std::string getKey(const HostInfo &hostInfo);
+
+  /**
+   * Checks without blocking if the server closed an idle connection. connected() only reflects the local state and doesn't notice a FIN sent by the server.
+   */
+  static bool isAlive(const std::shared_ptr<HttpClient> &client, bool useSsl);
+
+  /**
+   * Disconnects the clients. Must be called without holding _hostsMutex, as disconnecting might block (e. g. on TLS shutdown).
+   */
+  static void disconnect(std::vector<std::shared_ptr<HttpClient>> &clients);
+
+  /**
+   * Removes connections idle for longer than the idle timeout and hosts without connections and waiters. _hostsMutex must be locked. The removed clients are
+   * moved to "closedClients".
+   */
+  void evictIdle(int64_t now, std::vector<std::shared_ptr<HttpClient>> &closedClients);
+  void release(const std::shared_ptr<Host> &host, std::shared_ptr<HttpClient> &client, bool reuse);
+};
+
+}
+
+#endif
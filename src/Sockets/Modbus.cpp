@@ -30,7 +30,9 @@
 
 #include "Modbus.h"
 
+#include <algorithm>
 #include <memory>
+#include <unordered_map>
 #include "../BaseLib.h"
 
 #define MODBUS_HEADER_SIZE 8
@@ -57,12 +59,18 @@ const uint8_t Modbus::_reverseByteMask[256] = {
 };
 
 Modbus::Modbus(BaseLib::SharedObjects *baseLib, Modbus::ModbusInfo &serverInfo) {
+  _bl = baseLib;
   _hostname = serverInfo.hostname;
   if (_hostname.empty()) throw ModbusException("The provided hostname is empty.");
   if (serverInfo.port > 0 && serverInfo.port < 65536) _port = serverInfo.port;
   if (serverInfo.timeout < 1000) serverInfo.timeout = 1000;
+  _timeout = serverInfo.timeout;
+  _maxPendingTransactions = serverInfo.maxPendingTransactions;
+  if (_maxPendingTransactions < 1) _maxPendingTransactions = 1;
+  else if (_maxPendingTransactions > 256) _maxPendingTransactions = 256;
 
   _readBuffer = std::make_unique<std::vector<char>>(1024);
+  _requestBuffer.reserve(MODBUS_HEADER_SIZE + 4);
 
   _keepAlive = serverInfo.keepAlive;
 
@@ -91,6 +99,21 @@ Modbus::Modbus(BaseLib::SharedObjects *baseLib, Modbus::ModbusInfo &serverInfo)
 }
 
 Modbus::~Modbus() {
+  std::deque<PendingTransaction> pipelineQueue;
+  {
+    std::lock_guard<std::mutex> pipelineGuard(_pipelineMutex);
+    _stopPipeline = true;
+  }
+  _pipelineConditionVariable.notify_all();
+  if (_bl) _bl->threadManager.join(_pipelineThread);
+  {
+    std::lock_guard<std::mutex> pipelineGuard(_pipelineMutex);
+    pipelineQueue.swap(_pipelineQueue);
+  }
+  for (auto &transaction : pipelineQueue) {
+    transaction.errorCallback(std::make_exception_ptr(ModbusException("The Modbus object was destroyed before the request could be sent.")));
+  }
+
   std::lock_guard<std::mutex> socketGuard(_socketMutex);
   if (_socket) {
     _socket->Shutdown();
@@ -109,9 +132,9 @@ void Modbus::disconnect() {
 }
 
 void Modbus::insertHeader(std::vector<char> &packet, uint8_t functionCode, uint16_t payloadSize) {
-  packet.push_back((char)(uint8_t)(_transactionId >> 8)); //Transaction identifier 1
-  packet.push_back((char)(uint8_t)(_transactionId & 0xFF)); //Transaction identifier 2
-  _transactionId++;
+  uint16_t transactionId = _transactionId++;
+  packet.push_back((char)(uint8_t)(transactionId >> 8)); //Transaction identifier 1
+  packet.push_back((char)(uint8_t)(transactionId & 0xFF)); //Transaction identifier 2
   packet.push_back(0); //Protocol identifier 1 (always 0)
   packet.push_back(0); //Protocol identifier 2 (always 0)
   payloadSize += 2;
@@ -121,10 +144,38 @@ void Modbus::insertHeader(std::vector<char> &packet, uint8_t functionCode, uint1
   packet.push_back((char)functionCode);
 }
 
-std::vector<char> Modbus::getResponse(std::vector<char> &packet) {
+void Modbus::checkResponse(const std::vector<char> &packet, const char *response, size_t responseSize) {
+  if (responseSize < 9) {
+    throw ModbusException("Invalid Modbus packet received: " + BaseLib::HelperFunctions::getHexString(std::vector<char>(response, response + responseSize)));
+  } else if ((response[7] & 0x7F) != packet.at(7)) {
+    throw ModbusException("Invalid response function code received: " + BaseLib::HelperFunctions::getHexString(std::vector<char>(response, response + responseSize)));
+  } else if (response[0] != packet.at(0) || response[1] != packet.at(1)) {
+    throw ModbusException("Response has invalid transaction ID.");
+  } else if (response[7] & 0x80) //Error response
+  {
+    uint8_t exceptionCode = response[8];
+    std::vector<char> responseCopy(response, response + responseSize);
+    switch (exceptionCode) {
+      case 1:throw ModbusException("Exception code 1: The function code (" + std::to_string(packet.at(7)) + ") is unknown by the server.", exceptionCode, std::move(responseCopy));
+      case 2:throw ModbusException("Exception code 2: Illegal data address.", exceptionCode, std::move(responseCopy));
+      case 3:throw ModbusException("Exception code 3: Illegal data value.", exceptionCode, std::move(responseCopy));
+      case 4:throw ModbusException("Exception code 4: Server failure.", exceptionCode, std::move(responseCopy));
+      case 5:
+        throw ModbusException(
+            "Exception code 5: Acknowledge: The server accepted the service invocation but the service requires a relatively long time to execute. The server therefore returns only an acknowledgement of the service invocation receipt.",
+            exceptionCode,
+            std::move(responseCopy));
+      case 6:throw ModbusServerBusyException("Exception code 6: Server busy", exceptionCode, std::move(responseCopy));
+      case 10:throw ModbusException("Exception code 10: Gateway problem: Gateway paths not available.", exceptionCode, std::move(responseCopy));
+      case 11:throw ModbusException("Exception code 11: Gateway problem: The targeted device failed to respond.", exceptionCode, std::move(responseCopy));
+      default:throw ModbusException("Unknown Modbus exception: " + std::to_string(exceptionCode) + ". Response was: " + BaseLib::HelperFunctions::getHexString(responseCopy), exceptionCode, std::move(responseCopy));
+    }
+  }
+}
+
+size_t Modbus::exchange(const std::vector<char> &packet) {
   if (packet.size() < 8) throw ModbusException("Could not send packet as it is invalid.");
 
-  std::lock_guard<std::mutex> socketGuard(_socketMutex);
   if (!_keepAlive) _socket->Open();
   _socket->Send((uint8_t *)packet.data(), packet.size());
   if (_packetSentCallback) _packetSentCallback(packet);
@@ -134,72 +185,65 @@ std::vector<char> Modbus::getResponse(std::vector<char> &packet) {
   bool more_data = false;
   while (true) {
     bytesread += _socket->Read((uint8_t *)_readBuffer->data() + bytesread, _readBuffer->size() - bytesread, more_data);
-    if (_readBuffer->size() == _readBuffer->capacity()) _readBuffer->resize(_readBuffer->size() + 1024);
     if (bytesread < 6) continue;
-    if (size == 0) size = ((((uint16_t)(uint8_t)_readBuffer->operator[](4)) << 8) | _readBuffer->operator[](5)) + 6;
+    if (size == 0) {
+      size = ((((uint16_t)(uint8_t)_readBuffer->operator[](4)) << 8) | (uint8_t)_readBuffer->operator[](5)) + 6;
+      if (size > _readBuffer->size()) {
+        if (!_keepAlive) _socket->Shutdown();
+        throw ModbusException("Invalid Modbus packet received: " + BaseLib::HelperFunctions::getHexString(std::vector<char>(_readBuffer->begin(), _readBuffer->begin() + bytesread)));
+      }
+    }
     if (bytesread > size) bytesread = size;
     if (bytesread >= size) break;
   }
 
-  std::vector<char> response(_readBuffer->begin(), _readBuffer->begin() + bytesread);
-
-  if (_packetReceivedCallback) _packetReceivedCallback(response);
+  if (_packetReceivedCallback) _packetReceivedCallback(std::vector<char>(_readBuffer->begin(), _readBuffer->begin() + bytesread));
 
-  if (bytesread < 9) {
-    if (!_keepAlive) _socket->Shutdown();
-    throw ModbusException("Invalid Modbus packet received: " + BaseLib::HelperFunctions::getHexString(response));
-  } else if ((_readBuffer->at(7) & 0x7F) != packet.at(7)) {
-    if (!_keepAlive) _socket->Shutdown();
-    throw ModbusException("Invalid response function code received: " + BaseLib::HelperFunctions::getHexString(response));
-  } else if (_readBuffer->at(0) != packet.at(0) || _readBuffer->at(1) != packet.at(1)) {
-    if (!_keepAlive) _socket->Shutdown();
-    throw ModbusException("Response has invalid transaction ID.");
-  } else if (_readBuffer->at(7) & 0x80) //Error response
-  {
+  try {
+    checkResponse(packet, _readBuffer->data(), bytesread);
+  }
+  catch (const std::exception &ex) {
     if (!_keepAlive) _socket->Shutdown();
-    uint8_t exceptionCode = _readBuffer->at(8);
-    switch (exceptionCode) {
-      case 1:throw ModbusException("Exception code 1: The function code (" + std::to_string(packet.at(7)) + ") is unknown by the server.", exceptionCode, response);
-      case 2:throw ModbusException("Exception code 2: Illegal data address.", exceptionCode, response);
-      case 3:throw ModbusException("Exception code 3: Illegal data value.", exceptionCode, response);
-      case 4:throw ModbusException("Exception code 4: Server failure.", exceptionCode, response);
-      case 5:
-        throw ModbusException(
-            "Exception code 5: Acknowledge: The server accepted the service invocation but the service requires a relatively long time to execute. The server therefore returns only an acknowledgement of the service invocation receipt.",
-            exceptionCode,
-            response);
-      case 6:throw ModbusServerBusyException("Exception code 6: Server busy", exceptionCode, response);
-      case 10:throw ModbusException("Exception code 10: Gateway problem: Gateway paths not available.", exceptionCode, response);
-      case 11:throw ModbusException("Exception code 11: Gateway problem: The targeted device failed to respond.", exceptionCode, response);
-      default:throw ModbusException("Unknown Modbus exception: " + std::to_string(exceptionCode) + ". Response was: " + BaseLib::HelperFunctions::getHexString(response), exceptionCode, response);
-    }
+    throw;
   }
 
   if (!_keepAlive) _socket->Shutdown();
 
-  return response;
+  return bytesread;
 }
 
-void Modbus::readCoils(uint16_t startingAddress, std::vector<uint8_t> &buffer, uint16_t coilCount) {
-  if (coilCount == 0) throw ModbusException("coilCount can't be 0.");
+std::vector<char> Modbus::getResponse(std::vector<char> &packet) {
+  std::lock_guard<std::mutex> socketGuard(_socketMutex);
+  size_t responseSize = exchange(packet);
+  return std::vector<char>(_readBuffer->begin(), _readBuffer->begin() + responseSize);
+}
 
-  std::vector<char> packet;
-  packet.reserve(MODBUS_HEADER_SIZE + 4);
-  insertHeader(packet, 1, 4);
-  packet.push_back((char)(uint8_t)(startingAddress >> 8)); //Address 1
-  packet.push_back((char)(uint8_t)(startingAddress & 0xFF)); //Address 2
-  packet.push_back((char)(uint8_t)(coilCount >> 8));
-  packet.push_back((char)(uint8_t)(coilCount & 0xFF));
+size_t Modbus::exchangeReadRequest(uint8_t functionCode, uint16_t startingAddress, uint16_t count) {
+  _requestBuffer.clear();
+  insertHeader(_requestBuffer, functionCode, 4);
+  _requestBuffer.push_back((char)(uint8_t)(startingAddress >> 8)); //Address 1
+  _requestBuffer.push_back((char)(uint8_t)(startingAddress & 0xFF)); //Address 2
+  _requestBuffer.push_back((char)(uint8_t)(count >> 8));
+  _requestBuffer.push_back((char)(uint8_t)(count & 0xFF));
+  return exchange(_requestBuffer);
+}
 
-  uint32_t coilBytes = coilCount / 8 + (coilCount % 8 != 0 ? 1 : 0);
-  if (buffer.size() < coilBytes) throw ModbusException("Buffer is too small.");
+void Modbus::readBits(uint8_t functionCode, uint16_t startingAddress, uint8_t *buffer, size_t bufferSize, uint16_t count) {
+  if (count == 0) throw ModbusException(std::string(functionCode == 1 ? "coilCount" : "inputCount") + " can't be 0.");
+  uint32_t byteCount = count / 8 + (count % 8 != 0 ? 1 : 0);
+  if (bufferSize < byteCount) throw ModbusException("Buffer is too small.");
 
-  std::vector<char> response;
   for (int32_t i = 0; i < 5; i++) {
     try {
-      response = getResponse(packet);
-      if ((uint8_t)response.at(8) >= coilBytes && response.size() >= coilBytes + 9) break;
-      else if (i == 4) throw ModbusException("Could not read Modbus coils from address 0x" + BaseLib::HelperFunctions::getHexString(startingAddress));
+      std::lock_guard<std::mutex> socketGuard(_socketMutex);
+      size_t responseSize = exchangeReadRequest(functionCode, startingAddress, count);
+      const char *response = _readBuffer->data();
+      if ((uint8_t)response[8] >= byteCount && responseSize >= byteCount + 9) {
+        for (uint32_t j = 0; j < byteCount; j++) {
+          buffer[j] = _reverseByteMask[(uint8_t)response[j + 9]];
+        }
+        return;
+      } else if (i == 4) throw ModbusException("Could not read Modbus " + std::string(functionCode == 1 ? "coils" : "inputs") + " from address 0x" + BaseLib::HelperFunctions::getHexString(startingAddress));
     }
     catch (const ModbusServerBusyException &ex) {
       std::this_thread::sleep_for(std::chrono::milliseconds(10));
@@ -212,34 +256,27 @@ void Modbus::readCoils(uint16_t startingAddress, std::vector<uint8_t> &buffer, u
       if (i == 4) throw;
     }
   }
-
-  if ((uint8_t)response.at(8) >= coilBytes && response.size() >= coilBytes + 9) {
-    for (uint32_t i = 9; i < coilBytes + 9; i++) {
-      buffer.at(i - 9) = _reverseByteMask[(uint8_t)response.at(i)];
-    }
-  }
 }
 
-void Modbus::readDiscreteInputs(uint16_t startingAddress, std::vector<uint8_t> &buffer, uint16_t inputCount) {
-  if (inputCount == 0) throw ModbusException("inputCount can't be 0.");
-
-  std::vector<char> packet;
-  packet.reserve(MODBUS_HEADER_SIZE + 4);
-  insertHeader(packet, 2, 4);
-  packet.push_back((char)(uint8_t)(startingAddress >> 8)); //Address 1
-  packet.push_back((char)(uint8_t)(startingAddress & 0xFF)); //Address 2
-  packet.push_back((char)(uint8_t)(inputCount >> 8));
-  packet.push_back((char)(uint8_t)(inputCount & 0xFF));
+void Modbus::readRegisters(uint8_t functionCode, uint16_t startingAddress, uint16_t *buffer, size_t bufferSize, uint16_t registerCount) {
+  if (registerCount == 0) throw ModbusException("registerCount can't be 0.");
+  if (bufferSize < registerCount) throw ModbusException("Buffer is too small.");
 
-  uint32_t inputBytes = inputCount / 8 + (inputCount % 8 != 0 ? 1 : 0);
-  if (buffer.size() < inputBytes) throw ModbusException("Buffer is too small.");
+  uint32_t registerBytes = registerCount * 2;
 
-  std::vector<char> response;
   for (int32_t i = 0; i < 5; i++) {
     try {
-      response = getResponse(packet);
-      if ((uint8_t)response.at(8) >= inputBytes && response.size() >= inputBytes + 9) break;
-      else if (i == 4) throw ModbusException("Could not read Modbus inputs from address 0x" + BaseLib::HelperFunctions::getHexString(startingAddress));
+      std::lock_guard<std::mutex> socketGuard(_socketMutex);
+      size_t responseSize = exchangeReadRequest(functionCode, startingAddress, registerCount);
+      const char *response = _readBuffer->data();
+      //Responses to holding register reads need to contain exactly the requested number of bytes, others are rejected as malformed.
+      bool byteCountValid = functionCode == 3 ? (uint8_t)response[8] == registerBytes : (uint8_t)response[8] >= registerBytes;
+      if (byteCountValid && responseSize >= registerBytes + 9) {
+        for (uint32_t j = 0; j < registerCount; j++) {
+          buffer[j] = (((uint16_t)(uint8_t)response[9 + j * 2]) << 8) | (uint8_t)response[10 + j * 2];
+        }
+        return;
+      } else if (i == 4) throw ModbusException("Could not read Modbus " + std::string(functionCode == 3 ? "holding" : "input") + " registers from address 0x" + BaseLib::HelperFunctions::getHexString(startingAddress));
     }
     catch (const ModbusServerBusyException &ex) {
       std::this_thread::sleep_for(std::chrono::milliseconds(10));
@@ -252,92 +289,259 @@ void Modbus::readDiscreteInputs(uint16_t startingAddress, std::vector<uint8_t> &
       if (i == 4) throw;
     }
   }
+}
 
-  if ((uint8_t)response.at(8) >= inputBytes && response.size() >= inputBytes + 9) {
-    for (uint32_t i = 9; i < inputBytes + 9; i++) {
-      buffer.at(i - 9) = _reverseByteMask[(uint8_t)response.at(i)];
-    }
-  }
+void Modbus::readCoils(uint16_t startingAddress, std::vector<uint8_t> &buffer, uint16_t coilCount) {
+  readBits(1, startingAddress, buffer.data(), buffer.size(), coilCount);
+}
+
+void Modbus::readCoils(uint16_t startingAddress, uint8_t *buffer, size_t bufferSize, uint16_t coilCount) {
+  readBits(1, startingAddress, buffer, bufferSize, coilCount);
+}
+
+void Modbus::readDiscreteInputs(uint16_t startingAddress, std::vector<uint8_t> &buffer, uint16_t inputCount) {
+  readBits(2, startingAddress, buffer.data(), buffer.size(), inputCount);
+}
+
+void Modbus::readDiscreteInputs(uint16_t startingAddress, uint8_t *buffer, size_t bufferSize, uint16_t inputCount) {
+  readBits(2, startingAddress, buffer, bufferSize, inputCount);
 }
 
 void Modbus::readHoldingRegisters(uint16_t startingAddress, std::vector<uint16_t> &buffer, uint16_t registerCount) {
-  if (registerCount == 0) throw ModbusException("registerCount can't be 0.");
-  if (buffer.size() < registerCount) throw ModbusException("Buffer is too small.");
+  readRegisters(3, startingAddress, buffer.data(), buffer.size(), registerCount);
+}
 
-  std::vector<char> packet;
-  packet.reserve(MODBUS_HEADER_SIZE + 4);
-  insertHeader(packet, 3, 4);
-  packet.push_back((char)(uint8_t)(startingAddress >> 8)); //Address 1
-  packet.push_back((char)(uint8_t)(startingAddress & 0xFF)); //Address 2
-  packet.push_back((char)(uint8_t)(registerCount >> 8));
-  packet.push_back((char)(uint8_t)(registerCount & 0xFF));
+void Modbus::readHoldingRegisters(uint16_t startingAddress, uint16_t *buffer, size_t bufferSize, uint16_t registerCount) {
+  readRegisters(3, startingAddress, buffer, bufferSize, registerCount);
+}
 
-  uint32_t registerBytes = registerCount * 2;
+void Modbus::readInputRegisters(uint16_t startingAddress, std::vector<uint16_t> &buffer, uint16_t registerCount) {
+  readRegisters(4, startingAddress, buffer.data(), buffer.size(), registerCount);
+}
 
-  std::vector<char> response;
-  for (int32_t i = 0; i < 5; i++) {
-    try {
-      response = getResponse(packet);
-      if ((uint8_t)response.at(8) == registerBytes && response.size() >= registerBytes + 9) break;
-      else if (i == 4) throw ModbusException("Could not read Modbus holding registers from address 0x" + BaseLib::HelperFunctions::getHexString(startingAddress));
-    }
-    catch (ModbusServerBusyException &ex) {
-      std::this_thread::sleep_for(std::chrono::milliseconds(10));
-      if (i == 4) throw;
-    }
-    catch (ModbusException &ex) {
-      throw;
-    }
-    catch (const std::exception &ex) {
-      if (i == 4) throw;
-    }
-  }
+void Modbus::readInputRegisters(uint16_t startingAddress, uint16_t *buffer, size_t bufferSize, uint16_t registerCount) {
+  readRegisters(4, startingAddress, buffer, bufferSize, registerCount);
+}
+
+std::future<std::vector<uint16_t>> Modbus::readHoldingRegistersAsync(uint16_t startingAddress, uint16_t registerCount) {
+  return readRegistersAsync(3, startingAddress, registerCount);
+}
+
+std::future<std::vector<uint16_t>> Modbus::readInputRegistersAsync(uint16_t startingAddress, uint16_t registerCount) {
+  return readRegistersAsync(4, startingAddress, registerCount);
+}
 
-  if ((uint8_t)response.at(8) >= registerBytes && response.size() >= registerBytes + 9) {
+std::future<std::vector<uint16_t>> Modbus::readRegistersAsync(uint8_t functionCode, uint16_t startingAddress, uint16_t registerCount) {
+  if (registerCount == 0) throw ModbusException("registerCount can't be 0.");
+  if (registerCount > 125) throw ModbusException("registerCount can't be greater than 125.");
+
+  PendingTransaction transaction;
+  transaction.packet.reserve(MODBUS_HEADER_SIZE + 4);
+  insertHeader(transaction.packet, functionCode, 4);
+  transaction.packet.push_back((char)(uint8_t)(startingAddress >> 8)); //Address 1
+  transaction.packet.push_back((char)(uint8_t)(startingAddress & 0xFF)); //Address 2
+  transaction.packet.push_back((char)(uint8_t)(registerCount >> 8));
+  transaction.packet.push_back((char)(uint8_t)(registerCount & 0xFF));
+
+  auto promise = std::make_shared<std::promise<std::vector<uint16_t>>>();
+  auto future = promise->get_future();
+
+  transaction.responseCallback = [promise, functionCode, startingAddress, registerCount](const std::vector<char> &response) {
+    uint32_t registerBytes = registerCount * 2;
+    bool byteCountValid = functionCode == 3 ? (uint8_t)response.at(8) == registerBytes : (uint8_t)response.at(8) >= registerBytes;
+    if (!byteCountValid || response.size() < registerBytes + 9) {
+      throw ModbusException("Could not read Modbus " + std::string(functionCode == 3 ? "holding" : "input") + " registers from address 0x" + BaseLib::HelperFunctions::getHexString(startingAddress));
+    }
+    std::vector<uint16_t> registers(registerCount);
     for (uint32_t i = 9; i < registerBytes + 9; i += 2) {
-      buffer.at((i - 9) / 2) = (((uint16_t)(uint8_t)response.at(i)) << 8) | (uint8_t)response.at(i + 1);
+      registers[(i - 9) / 2] = (((uint16_t)(uint8_t)response[i]) << 8) | (uint8_t)response[i + 1];
     }
-  }
+    promise->set_value(std::move(registers));
+  };
+  transaction.errorCallback = [promise](std::exception_ptr exception) {
+    promise->set_exception(exception);
+  };
+
+  queueTransaction(std::move(transaction));
+  return future;
 }
 
-void Modbus::readInputRegisters(uint16_t startingAddress, std::vector<uint16_t> &buffer, uint16_t registerCount) {
-  if (registerCount == 0) throw ModbusException("registerCount can't be 0.");
-  if (buffer.size() < registerCount) throw ModbusException("Buffer is too small.");
+void Modbus::queueTransaction(PendingTransaction &&transaction) {
+  if (!_bl) throw ModbusException("Asynchronous requests need a SharedObjects object.");
+  std::lock_guard<std::mutex> pipelineGuard(_pipelineMutex);
+  if (_stopPipeline) throw ModbusException("The Modbus object is being destroyed.");
+  _pipelineQueue.emplace_back(std::move(transaction));
+  if (!_pipelineThreadRunning) _pipelineThreadRunning = _bl->threadManager.start(_pipelineThread, false, &Modbus::pipelineWorker, this);
+  if (!_pipelineThreadRunning) {
+    _pipelineQueue.pop_back();
+    throw ModbusException("Could not start Modbus pipeline thread.");
+  }
+  _pipelineConditionVariable.notify_one();
+}
 
-  std::vector<char> packet;
-  packet.reserve(MODBUS_HEADER_SIZE + 4);
-  insertHeader(packet, 4, 4);
-  packet.push_back((char)(uint8_t)(startingAddress >> 8)); //Address 1
-  packet.push_back((char)(uint8_t)(startingAddress & 0xFF)); //Address 2
-  packet.push_back((char)(uint8_t)(registerCount >> 8));
-  packet.push_back((char)(uint8_t)(registerCount & 0xFF));
+void Modbus::pipelineWorker() {
+  while (true) {
+    {
+      std::unique_lock<std::mutex> pipelineGuard(_pipelineMutex);
+      _pipelineConditionVariable.wait(pipelineGuard, [&] { return _stopPipeline || !_pipelineQueue.empty(); });
+      if (_stopPipeline) return;
+      //Don't spin while only retries are queued, which are not due yet.
+      int64_t nextSendTime = _pipelineQueue.front().notBefore;
+      for (auto &transaction : _pipelineQueue) {
+        nextSendTime = std::min(nextSendTime, transaction.notBefore);
+      }
+      int64_t delay = nextSendTime - HelperFunctions::getTime();
+      if (delay > 0) {
+        _pipelineConditionVariable.wait_for(pipelineGuard, std::chrono::milliseconds(delay));
+        continue;
+      }
+    }
+    processPipeline();
+  }
+}
 
-  uint32_t registerBytes = registerCount * 2;
+void Modbus::retryTransaction(PendingTransaction &&transaction, const std::exception_ptr &exception) {
+  if (transaction.retries >= 4) {
+    transaction.errorCallback(exception);
+    return;
+  }
+  //Back off exponentially, so a busy server is not flooded with requests.
+  transaction.notBefore = HelperFunctions::getTime() + (10 << transaction.retries);
+  transaction.retries++;
+  std::lock_guard<std::mutex> pipelineGuard(_pipelineMutex);
+  _pipelineQueue.emplace_back(std::move(transaction));
+}
 
+void Modbus::processPipeline() {
+  std::unordered_map<uint16_t, PendingTransaction> inFlight;
+  inFlight.reserve(_maxPendingTransactions);
+  std::vector<PendingTransaction> toSend;
+  toSend.reserve(_maxPendingTransactions);
+  std::vector<char> buffer;
+  buffer.reserve(1024);
   std::vector<char> response;
-  for (int32_t i = 0; i < 5; i++) {
+
+  std::lock_guard<std::mutex> socketGuard(_socketMutex);
+  //With keep-alive the connection is closed after errors, so it is reopened here.
+  bool opened = _keepAlive && _socket->Connected();
+  //The number of entries of "toSend" that were moved to "inFlight".
+  size_t movedCount = 0;
+  while (true) {
     try {
-      response = getResponse(packet);
-      if ((uint8_t)response.at(8) >= registerBytes && response.size() >= registerBytes + 9) break;
-      else if (i == 4) throw ModbusException("Could not read Modbus input registers from address 0x" + BaseLib::HelperFunctions::getHexString(startingAddress));
-    }
-    catch (const ModbusServerBusyException &ex) {
-      std::this_thread::sleep_for(std::chrono::milliseconds(10));
-      if (i == 4) throw;
+      if (!opened) {
+        _socket->Open();
+        opened = true;
+      }
+
+      {
+        std::lock_guard<std::mutex> pipelineGuard(_pipelineMutex);
+        int64_t time = HelperFunctions::getTime();
+        for (auto transactionIterator = _pipelineQueue.begin(); !_stopPipeline && inFlight.size() + toSend.size() < _maxPendingTransactions && transactionIterator != _pipelineQueue.end();) {
+          if (transactionIterator->notBefore > time) {
+            transactionIterator++;
+            continue;
+          }
+          toSend.emplace_back(std::move(*transactionIterator));
+          transactionIterator = _pipelineQueue.erase(transactionIterator);
+        }
+      }
+
+      while (movedCount < toSend.size()) {
+        auto &transaction = toSend[movedCount];
+        uint16_t transactionId = (((uint16_t)(uint8_t)transaction.packet.at(0)) << 8) | (uint8_t)transaction.packet.at(1);
+        auto &entry = inFlight[transactionId];
+        entry = std::move(transaction);
+        movedCount++;
+        entry.sendTime = HelperFunctions::getTime();
+        _socket->Send((uint8_t *)entry.packet.data(), entry.packet.size());
+        if (_packetSentCallback) _packetSentCallback(entry.packet);
+      }
+      toSend.clear();
+      movedCount = 0;
+
+      if (inFlight.empty()) break;
+
+      bool more_data = false;
+      size_t bufferSize = buffer.size();
+      buffer.resize(bufferSize + 1024);
+      buffer.resize(bufferSize + _socket->Read((uint8_t *)buffer.data() + bufferSize, 1024, more_data));
+
+      //Process all complete frames in the buffer. The server might send several responses in one TCP segment.
+      size_t frameStart = 0;
+      while (buffer.size() - frameStart >= 6) {
+        uint32_t frameSize = ((((uint16_t)(uint8_t)buffer[frameStart + 4]) << 8) | (uint8_t)buffer[frameStart + 5]) + 6;
+        if (frameSize > 260) throw ModbusException("Invalid Modbus packet received: " + BaseLib::HelperFunctions::getHexString(std::vector<char>(buffer.begin() + frameStart, buffer.end())));
+        if (buffer.size() - frameStart < frameSize) break;
+        response.assign(buffer.begin() + frameStart, buffer.begin() + frameStart + frameSize);
+        frameStart += frameSize;
+
+        if (_packetReceivedCallback) _packetReceivedCallback(response);
+
+        uint16_t transactionId = (((uint16_t)(uint8_t)response[0]) << 8) | (uint8_t)response[1];
+        auto transactionIterator = inFlight.find(transactionId);
+        if (transactionIterator == inFlight.end()) continue; //Late response to a transaction that already timed out.
+        PendingTransaction transaction = std::move(transactionIterator->second);
+        inFlight.erase(transactionIterator);
+
+        try {
+          checkResponse(transaction.packet, response.data(), response.size());
+          transaction.responseCallback(response);
+        }
+        catch (const ModbusServerBusyException &ex) {
+          retryTransaction(std::move(transaction), std::current_exception());
+        }
+        catch (const std::exception &ex) {
+          transaction.errorCallback(std::current_exception());
+        }
+      }
+      if (frameStart > 0) buffer.erase(buffer.begin(), buffer.begin() + frameStart);
     }
-    catch (const ModbusException &ex) {
-      throw;
+    catch (const C1Net::TimeoutException &ex) {
+      //No data within the socket timeout. Only transactions exceeding their own timeout fail (see below).
     }
     catch (const std::exception &ex) {
-      if (i == 4) throw;
+      //The connection is broken or the stream is out of sync, so the responses to all outstanding transactions are lost. They are sent again after
+      //reconnecting or fail when they were retried too often.
+      auto exception = std::current_exception();
+      if (!opened) {
+        //The connection couldn't be opened. Back off the due transactions, so they fail after the retries instead of being tried again immediately.
+        std::lock_guard<std::mutex> pipelineGuard(_pipelineMutex);
+        int64_t time = HelperFunctions::getTime();
+        for (auto transactionIterator = _pipelineQueue.begin(); transactionIterator != _pipelineQueue.end();) {
+          if (transactionIterator->notBefore > time) {
+            transactionIterator++;
+            continue;
+          }
+          toSend.emplace_back(std::move(*transactionIterator));
+          transactionIterator = _pipelineQueue.erase(transactionIterator);
+        }
+      }
+      for (size_t i = movedCount; i < toSend.size(); i++) {
+        retryTransaction(std::move(toSend[i]), exception);
+      }
+      for (auto &transaction : inFlight) {
+        retryTransaction(std::move(transaction.second), exception);
+      }
+      toSend.clear();
+      movedCount = 0;
+      inFlight.clear();
+      buffer.clear();
+      //Also with keep-alive, as the stream might still contain stale responses. The retries are sent on a new connection.
+      _socket->Shutdown();
+      opened = false;
+      break;
+    }
+
+    int64_t time = HelperFunctions::getTime();
+    for (auto transactionIterator = inFlight.begin(); transactionIterator != inFlight.end();) {
+      if (time - transactionIterator->second.sendTime > _timeout) {
+        transactionIterator->second.errorCallback(std::make_exception_ptr(C1Net::TimeoutException("No response to pipelined Modbus request within timeout.")));
+        transactionIterator = inFlight.erase(transactionIterator);
+      } else transactionIterator++;
     }
   }
 
-  if ((uint8_t)response.at(8) >= registerBytes && response.size() >= registerBytes + 9) {
-    for (uint32_t i = 9; i < registerBytes + 9; i += 2) {
-      buffer.at((i - 9) / 2) = (((uint16_t)(uint8_t)response.at(i)) << 8) | (uint8_t)response.at(i + 1);
-    }
-  }
+  if (!_keepAlive && opened) _socket->Shutdown();
 }
 
 void Modbus::writeSingleCoil(uint16_t address, bool value) {
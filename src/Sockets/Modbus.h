@@ -37,7 +37,12 @@
 #include "../Security/SecureVector.h"
 
 #include <c1-net/TcpSocket.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <future>
 #include <map>
+#include <thread>
 
 namespace BaseLib {
 
@@ -137,6 +142,11 @@ class Modbus {
     std::string caFile; //For client certificate verification
     std::string caData; //For client certificate verification
     uint32_t timeout = 5000;
+    /**
+     * The maximum number of transactions the asynchronous methods keep outstanding at the same time. Set to "1" for servers that can't handle more than one
+     * request at a time. Valid values range from 1 to 256.
+     */
+    uint32_t maxPendingTransactions = 8;
     std::function<void(const std::vector<char> &packet)> packetSentCallback;
     std::function<void(const std::vector<char> &packet)> packetReceivedCallback;
   };
@@ -196,6 +206,16 @@ class Modbus {
    */
   void readCoils(uint16_t startingAddress, std::vector<uint8_t> &buffer, uint16_t coilCount);
 
+  /**
+   * Same as readCoils() above, but writes the coil states directly to the provided memory. Use this in polling loops to avoid allocations.
+   *
+   * @param startingAddress Valid values range from 0x0000 to 0xFFFF.
+   * @param[out] buffer The buffer to fill.
+   * @param bufferSize The size of buffer in bytes. Must be at least the number of coils divided by 8 and rounded up.
+   * @param coilCount The number of coils to read (from 1 to 2000 [= 0x7D0]).
+   */
+  void readCoils(uint16_t startingAddress, uint8_t *buffer, size_t bufferSize, uint16_t coilCount);
+
   /**
    * Executes modbus function 02 (0x02) "Read Discrete Inputs".
    *
@@ -211,6 +231,16 @@ class Modbus {
    */
   void readDiscreteInputs(uint16_t startingAddress, std::vector<uint8_t> &buffer, uint16_t inputCount);
 
+  /**
+   * Same as readDiscreteInputs() above, but writes the input states directly to the provided memory. Use this in polling loops to avoid allocations.
+   *
+   * @param startingAddress Valid values range from 0x0000 to 0xFFFF.
+   * @param[out] buffer The buffer to fill.
+   * @param bufferSize The size of buffer in bytes. Must be at least the number of inputs divided by 8 and rounded up.
+   * @param inputCount The number of inputs to read (from 1 to 2000 [= 0x7D0]).
+   */
+  void readDiscreteInputs(uint16_t startingAddress, uint8_t *buffer, size_t bufferSize, uint16_t inputCount);
+
   /**
    * Executes modbus function 03 (0x03) "Read Holding Registers".
    *
@@ -226,6 +256,17 @@ class Modbus {
    */
   void readHoldingRegisters(uint16_t startingAddress, std::vector<uint16_t> &buffer, uint16_t registerCount);
 
+  /**
+   * Same as readHoldingRegisters() above, but decodes the register values directly into the provided memory. Use this in polling loops to avoid
+   * allocations.
+   *
+   * @param startingAddress Valid values range from 0x0000 to 0xFFFF.
+   * @param[out] buffer The buffer to fill.
+   * @param bufferSize The number of elements of buffer. Must be at least registerCount.
+   * @param registerCount The number of registers to read (from 1 to 125 [= 0x7D]).
+   */
+  void readHoldingRegisters(uint16_t startingAddress, uint16_t *buffer, size_t bufferSize, uint16_t registerCount);
+
   /**
    * Executes modbus function 04 (0x04) "Read Input Registers".
    *
@@ -241,6 +282,38 @@ class Modbus {
    */
   void readInputRegisters(uint16_t startingAddress, std::vector<uint16_t> &buffer, uint16_t registerCount);
 
+  /**
+   * Same as readInputRegisters() above, but decodes the register values directly into the provided memory. Use this in polling loops to avoid allocations.
+   *
+   * @param startingAddress Valid values range from 0x0000 to 0xFFFF.
+   * @param[out] buffer The buffer to fill.
+   * @param bufferSize The number of elements of buffer. Must be at least registerCount.
+   * @param registerCount The number of registers to read (from 1 to 125 [= 0x7D]).
+   */
+  void readInputRegisters(uint16_t startingAddress, uint16_t *buffer, size_t bufferSize, uint16_t registerCount);
+
+  /**
+   * Asynchronous version of readHoldingRegisters(). The request is queued and sent by a worker thread which keeps up to ModbusInfo::maxPendingTransactions
+   * requests outstanding and matches the responses by transaction ID. This way many register blocks can be polled without waiting a full round trip for
+   * each of them.
+   *
+   * @param startingAddress Valid values range from 0x0000 to 0xFFFF.
+   * @param registerCount The number of registers to read (from 1 to 125 [= 0x7D]).
+   * @returns Returns a future which is set to the register values. On errors the future rethrows the same exceptions as readHoldingRegisters().
+   * @throws ModbusException When the arguments are invalid.
+   */
+  std::future<std::vector<uint16_t>> readHoldingRegistersAsync(uint16_t startingAddress, uint16_t registerCount);
+
+  /**
+   * Asynchronous version of readInputRegisters(). See readHoldingRegistersAsync() for details.
+   *
+   * @param startingAddress Valid values range from 0x0000 to 0xFFFF.
+   * @param registerCount The number of registers to read (from 1 to 125 [= 0x7D]).
+   * @returns Returns a future which is set to the register values. On errors the future rethrows the same exceptions as readInputRegisters().
+   * @throws ModbusException When the arguments are invalid.
+   */
+  std::future<std::vector<uint16_t>> readInputRegistersAsync(uint16_t startingAddress, uint16_t registerCount);
+
   /**
    * Executes modbus function 05 (0x05) "Write Single Coil".
    *
@@ -323,8 +396,26 @@ class Modbus {
    */
   DeviceInfo readDeviceIdentification();
  private:
+  /**
+   * A request queued by one of the asynchronous methods.
+   */
+  struct PendingTransaction {
+    std::vector<char> packet;
+    int32_t retries = 0;
+    int64_t sendTime = 0;
+
+    /**
+     * Retries are not sent before this time.
+     */
+    int64_t notBefore = 0;
+    std::function<void(const std::vector<char> &response)> responseCallback;
+    std::function<void(std::exception_ptr exception)> errorCallback;
+  };
+
   static const uint8_t _reverseByteMask[256];
 
+  BaseLib::SharedObjects *_bl = nullptr;
+
   /**
    * The Modbus slave ID
    */
@@ -362,10 +453,32 @@ class Modbus {
    */
   std::unique_ptr<std::vector<char>> _readBuffer;
 
+  /**
+   * The buffer read requests are encoded to. Only used while _socketMutex is locked.
+   */
+  std::vector<char> _requestBuffer;
+
   /**
    * The transaction ID used for Modbus packet numbering.
    */
-  uint16_t _transactionId = 0;
+  std::atomic<uint16_t> _transactionId{0};
+
+  /**
+   * The socket timeout in milliseconds. Also used as the timeout for pipelined transactions.
+   */
+  uint32_t _timeout = 5000;
+
+  uint32_t _maxPendingTransactions = 8;
+
+  /**
+   * Protects _pipelineQueue, _pipelineThreadRunning and _stopPipeline.
+   */
+  std::mutex _pipelineMutex;
+  std::condition_variable _pipelineConditionVariable;
+  std::deque<PendingTransaction> _pipelineQueue;
+  std::thread _pipelineThread;
+  bool _pipelineThreadRunning = false;
+  bool _stopPipeline = false;
 
   std::function<void(const std::vector<char> &packet)> _packetSentCallback;
   std::function<void(const std::vector<char> &packet)> _packetReceivedCallback;
@@ -378,7 +491,49 @@ class Modbus {
    */
   void insertHeader(std::vector<char> &packet, uint8_t functionCode, uint16_t payloadSize);
 
+  /**
+   * Checks a response against the request it answers and throws the matching ModbusException on errors.
+   */
+  void checkResponse(const std::vector<char> &packet, const char *response, size_t responseSize);
+
+  /**
+   * Sends a packet and reads the response to _readBuffer. _socketMutex must be locked.
+   *
+   * @return Returns the size of the response.
+   */
+  size_t exchange(const std::vector<char> &packet);
+
   std::vector<char> getResponse(std::vector<char> &packet);
+
+  /**
+   * Encodes a read request to _requestBuffer and calls exchange(). _socketMutex must be locked.
+   */
+  size_t exchangeReadRequest(uint8_t functionCode, uint16_t startingAddress, uint16_t count);
+
+  void readBits(uint8_t functionCode, uint16_t startingAddress, uint8_t *buffer, size_t bufferSize, uint16_t count);
+
+  void readRegisters(uint8_t functionCode, uint16_t startingAddress, uint16_t *buffer, size_t bufferSize, uint16_t registerCount);
+
+  /**
+   * Queues a transaction for the pipeline worker and starts the worker if necessary.
+   */
+  void queueTransaction(PendingTransaction &&transaction);
+
+  std::future<std::vector<uint16_t>> readRegistersAsync(uint8_t functionCode, uint16_t startingAddress, uint16_t registerCount);
+
+  void pipelineWorker();
+
+  /**
+   * Queues a transaction again with an exponential backoff or calls its error callback when it was retried too often.
+   */
+  void retryTransaction(PendingTransaction &&transaction, const std::exception_ptr &exception);
+
+  /**
+   * Sends and receives queued transactions until the queue is empty and all responses have arrived. Holds _socketMutex the whole time so synchronous
+   * requests can't consume pipelined responses. A transaction fails when it didn't get a response within the timeout. Transactions rejected with
+   * "server busy" and transactions lost on a broken connection are retried with a backoff.
+   */
+  void processPipeline();
 };
 
 }
@@ -0,0 +1,186 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "ModbusReadPlanner.h"
+
+#include <algorithm>
+#include <future>
+
+namespace BaseLib {
+
+ModbusReadPlanner::ModbusReadPlanner(uint16_t maxRegisterGap, uint16_t maxBitGap) : _maxRegisterGap(maxRegisterGap), _maxBitGap(maxBitGap), _registerBuffer(125), _bitBuffer(250) {
+}
+
+size_t ModbusReadPlanner::addRange(RangeType type, uint16_t start, uint16_t count) {
+  if (count == 0) throw ModbusException("count can't be 0.");
+  if ((uint32_t)start + count > 0x10000) throw ModbusException("Range exceeds address 0xFFFF.");
+
+  Range range;
+  range.type = type;
+  range.start = start;
+  range.count = count;
+  if (isBitType(type)) range.bits.resize(count / 8 + (count % 8 != 0 ? 1 : 0), 0);
+  else range.registers.resize(count, 0);
+  _ranges.emplace_back(std::move(range));
+  _planValid = false;
+  return _ranges.size() - 1;
+}
+
+void ModbusReadPlanner::clear() {
+  _ranges.clear();
+  _requests.clear();
+  _planValid = false;
+}
+
+const std::vector<ModbusReadPlanner::Request> &ModbusReadPlanner::getRequests() {
+  if (!_planValid) plan();
+  return _requests;
+}
+
+void ModbusReadPlanner::plan() {
+  _requests.clear();
+
+  for (auto type : {RangeType::coil, RangeType::discreteInput, RangeType::holdingRegister, RangeType::inputRegister}) {
+    const uint32_t limit = isBitType(type) ? 2000 : 125;
+    const uint32_t maxGap = isBitType(type) ? _maxBitGap : _maxRegisterGap;
+
+    //Union of all ranges of this type as sorted, disjoint intervals [start, end).
+    std::vector<std::pair<uint32_t, uint32_t>> intervals;
+    for (auto &range : _ranges) {
+      if (range.type == type) intervals.emplace_back(range.start, (uint32_t)range.start + range.count);
+    }
+    if (intervals.empty()) continue;
+    std::sort(intervals.begin(), intervals.end());
+    size_t mergedCount = 0;
+    for (size_t i = 1; i < intervals.size(); i++) {
+      if (intervals[i].first <= intervals[mergedCount].second) intervals[mergedCount].second = std::max(intervals[mergedCount].second, intervals[i].second);
+      else intervals[++mergedCount] = intervals[i];
+    }
+    intervals.resize(mergedCount + 1);
+
+    //Greedily extend each request as far as the protocol limit and the gap tolerance allow. This yields the minimum number of requests.
+    size_t i = 0;
+    uint32_t nextStart = intervals[0].first;
+    while (i < intervals.size()) {
+      uint32_t start = nextStart;
+      uint32_t end = start;
+      while (i < intervals.size()) {
+        if (end != start && (intervals[i].first > end + maxGap || intervals[i].first >= start + limit)) break;
+        if (intervals[i].second > start + limit) {
+          end = start + limit;
+          break;
+        }
+        end = intervals[i].second;
+        i++;
+      }
+
+      Request request;
+      request.type = type;
+      request.start = (uint16_t)start;
+      request.count = (uint16_t)(end - start);
+      for (size_t j = 0; j < _ranges.size(); j++) {
+        auto &range = _ranges[j];
+        if (range.type == type && range.start < end && (uint32_t)range.start + range.count > start) request.ranges.push_back(j);
+      }
+      _requests.emplace_back(std::move(request));
+
+      if (i < intervals.size()) nextStart = (end > intervals[i].first) ? end : intervals[i].first;
+    }
+  }
+
+  _planValid = true;
+}
+
+void ModbusReadPlanner::scatterRegisters(const Request &request, const std::vector<uint16_t> &registers) {
+  uint32_t requestEnd = (uint32_t)request.start + request.count;
+  for (auto rangeIndex : request.ranges) {
+    auto &range = _ranges[rangeIndex];
+    uint32_t start = std::max((uint32_t)range.start, (uint32_t)request.start);
+    uint32_t end = std::min((uint32_t)range.start + range.count, requestEnd);
+    std::copy(registers.begin() + (start - request.start), registers.begin() + (end - request.start), range.registers.begin() + (start - range.start));
+  }
+}
+
+void ModbusReadPlanner::scatterBits(const Request &request, const std::vector<uint8_t> &bits) {
+  uint32_t requestEnd = (uint32_t)request.start + request.count;
+  for (auto rangeIndex : request.ranges) {
+    auto &range = _ranges[rangeIndex];
+    uint32_t start = std::max((uint32_t)range.start, (uint32_t)request.start);
+    uint32_t end = std::min((uint32_t)range.start + range.count, requestEnd);
+    for (uint32_t address = start; address < end; address++) {
+      uint32_t sourceBit = address - request.start;
+      uint32_t targetBit = address - range.start;
+      uint8_t mask = 0x80 >> (targetBit % 8);
+      if (bits[sourceBit / 8] & (0x80 >> (sourceBit % 8))) range.bits[targetBit / 8] |= mask;
+      else range.bits[targetBit / 8] &= ~mask;
+    }
+  }
+}
+
+void ModbusReadPlanner::execute(Modbus &modbus, bool pipelined) {
+  auto &requests = getRequests();
+
+  std::vector<std::future<std::vector<uint16_t>>> futures;
+  if (pipelined) {
+    futures.resize(requests.size());
+    for (size_t i = 0; i < requests.size(); i++) {
+      auto &request = requests[i];
+      if (request.type == RangeType::holdingRegister) futures[i] = modbus.readHoldingRegistersAsync(request.start, request.count);
+      else if (request.type == RangeType::inputRegister) futures[i] = modbus.readInputRegistersAsync(request.start, request.count);
+    }
+  }
+
+  for (size_t i = 0; i < requests.size(); i++) {
+    auto &request = requests[i];
+    if (isBitType(request.type)) {
+      if (request.type == RangeType::coil) modbus.readCoils(request.start, _bitBuffer.data(), _bitBuffer.size(), request.count);
+      else modbus.readDiscreteInputs(request.start, _bitBuffer.data(), _bitBuffer.size(), request.count);
+      scatterBits(request, _bitBuffer);
+    } else if (pipelined) {
+      scatterRegisters(request, futures[i].get());
+    } else {
+      if (request.type == RangeType::holdingRegister) modbus.readHoldingRegisters(request.start, _registerBuffer.data(), _registerBuffer.size(), request.count);
+      else modbus.readInputRegisters(request.start, _registerBuffer.data(), _registerBuffer.size(), request.count);
+      scatterRegisters(request, _registerBuffer);
+    }
+  }
+}
+
+const std::vector<uint16_t> &ModbusReadPlanner::getRegisters(size_t rangeIndex) const {
+  if (rangeIndex >= _ranges.size() || isBitType(_ranges[rangeIndex].type)) throw ModbusException("Unknown register range.");
+  return _ranges[rangeIndex].registers;
+}
+
+const std::vector<uint8_t> &ModbusReadPlanner::getBits(size_t rangeIndex) const {
+  if (rangeIndex >= _ranges.size() || !isBitType(_ranges[rangeIndex].type)) throw ModbusException("Unknown coil or input range.");
+  return _ranges[rangeIndex].bits;
+}
+
+}
@@ -0,0 +1,164 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef LIBHOMEGEAR_BASE_MODBUSREADPLANNER_H
+#define LIBHOMEGEAR_BASE_MODBUSREADPLANNER_H
+
+#include "Modbus.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace BaseLib {
+
+/**
+ * Merges many small reads into as few Modbus requests as possible. Add all ranges that need to be polled once, then call execute() every polling cycle.
+ * Adjacent and overlapping ranges of the same type are combined into one request as long as the protocol limits (125 registers or 2000 coils/inputs per
+ * request) are not exceeded. Ranges that are larger than a protocol limit are split over several requests. The class is not thread safe.
+ *
+ * Example:
+ *
+ *     BaseLib::ModbusReadPlanner planner(4);
+ *     auto voltage = planner.addRange(BaseLib::ModbusReadPlanner::RangeType::inputRegister, 0x0000, 6);
+ *     auto power = planner.addRange(BaseLib::ModbusReadPlanner::RangeType::inputRegister, 0x000C, 6);
+ *     planner.execute(modbus); //Sends one request for registers 0x0000 to 0x0011.
+ *     auto &powerRegisters = planner.getRegisters(power);
+ *
+ * @see Modbus
+ */
+class ModbusReadPlanner {
+ public:
+  enum class RangeType {
+    coil,
+    discreteInput,
+    holdingRegister,
+    inputRegister
+  };
+
+  struct Request {
+    RangeType type = RangeType::holdingRegister;
+    uint16_t start = 0;
+    uint16_t count = 0;
+    /**
+     * Indexes of all ranges overlapping with this request.
+     */
+    std::vector<size_t> ranges;
+  };
+
+  /**
+   * Constructor.
+   *
+   * @param maxRegisterGap The number of unrequested registers that may be read to merge two register ranges. Make sure, all registers in gaps are readable
+   * or the whole request fails with "Illegal data address".
+   * @param maxBitGap The number of unrequested coils or inputs that may be read to merge two coil or input ranges.
+   */
+  explicit ModbusReadPlanner(uint16_t maxRegisterGap = 0, uint16_t maxBitGap = 0);
+  virtual ~ModbusReadPlanner() = default;
+
+  /**
+   * Adds a range to read. Invalidates the current plan.
+   *
+   * @param type The kind of data to read.
+   * @param start The first address.
+   * @param count The number of registers, coils or inputs to read.
+   * @return Returns the index of the range, which is needed to get the values after execute().
+   * @throws ModbusException When count is 0 or the range exceeds address 0xFFFF.
+   */
+  size_t addRange(RangeType type, uint16_t start, uint16_t count);
+
+  /**
+   * Removes all ranges.
+   */
+  void clear();
+
+  /**
+   * Returns the requests execute() sends. The plan is calculated on first use after ranges were changed.
+   */
+  const std::vector<Request> &getRequests();
+
+  /**
+   * Sends all requests and scatters the results to the ranges.
+   *
+   * @param modbus The Modbus object to use.
+   * @param pipelined Send register reads with readHoldingRegistersAsync() and readInputRegistersAsync() so multiple requests are outstanding at the same time.
+   * @throws ModbusException and all other exceptions thrown by the Modbus read methods. When an exception is thrown, the values of ranges not read yet are
+   * unchanged.
+   */
+  void execute(Modbus &modbus, bool pipelined = false);
+
+  /**
+   * Returns the values of a register range read by the last call to execute().
+   *
+   * @param rangeIndex The index returned by addRange().
+   * @throws ModbusException When the range doesn't exist or is a coil or input range.
+   */
+  const std::vector<uint16_t> &getRegisters(size_t rangeIndex) const;
+
+  /**
+   * Returns the states of a coil or input range read by the last call to execute(). The format equals the one of Modbus::readCoils(): The least significant
+   * bit is to the left, so the bits and bytes can be read from left to right.
+   *
+   * @param rangeIndex The index returned by addRange().
+   * @throws ModbusException When the range doesn't exist or is a register range.
+   */
+  const std::vector<uint8_t> &getBits(size_t rangeIndex) const;
+ private:
+  struct Range {
+    RangeType type = RangeType::holdingRegister;
+    uint16_t start = 0;
+    uint16_t count = 0;
+    std::vector<uint16_t> registers;
+    std::vector<uint8_t> bits;
+  };
+
+  uint16_t _maxRegisterGap = 0;
+  uint16_t _maxBitGap = 0;
+  std::vector<Range> _ranges;
+  std::vector<Request> _requests;
+  bool _planValid = false;
+
+  /**
+   * Receive buffers large enough for the biggest possible request, so execute() doesn't need to allocate.
+   */
+  std::vector<uint16_t> _registerBuffer;
+  std::vector<uint8_t> _bitBuffer;
+
+  static bool isBitType(RangeType type) { return type == RangeType::coil || type == RangeType::discreteInput; }
+
+  void plan();
+
+  void scatterRegisters(const Request &request, const std::vector<uint16_t> &registers);
+
+  void scatterBits(const Request &request, const std::vector<uint8_t> &bits);
+};
+
+}
+
+#endif
@@ -0,0 +1,232 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "SerialFrameDecoder.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace BaseLib {
+
+// {{{ DelimiterFrameDecoder
+DelimiterFrameDecoder::DelimiterFrameDecoder(uint8_t delimiter, bool includeDelimiter, size_t maxFrameSize) : SerialFrameDecoder(maxFrameSize), _delimiter(delimiter), _includeDelimiter(includeDelimiter) {
+}
+
+void DelimiterFrameDecoder::decode(const uint8_t *data, size_t size, const FrameCallback &frameCallback) {
+  while (size > 0) {
+    auto *frameEnd = (const uint8_t *)memchr(data, _delimiter, size);
+    size_t bytes = frameEnd ? (size_t)(frameEnd - data) : size;
+    if (!_dropping) {
+      if (_frame.size() + bytes > _maxFrameSize) {
+        _frame.clear();
+        _dropping = true;
+      } else _frame.insert(_frame.end(), data, data + bytes);
+    }
+    if (!frameEnd) return;
+
+    if (!_dropping && !_frame.empty()) {
+      if (_includeDelimiter) _frame.push_back(_delimiter);
+      frameCallback(_frame);
+    }
+    _frame.clear();
+    _dropping = false;
+    data += bytes + 1;
+    size -= bytes + 1;
+  }
+}
+
+void DelimiterFrameDecoder::reset() {
+  _frame.clear();
+  _dropping = false;
+}
+// }}}
+
+// {{{ LengthPrefixFrameDecoder
+LengthPrefixFrameDecoder::LengthPrefixFrameDecoder(size_t lengthOffset, size_t lengthSize, bool bigEndian, int32_t lengthAdjustment, size_t maxFrameSize)
+    : SerialFrameDecoder(maxFrameSize), _lengthOffset(lengthOffset), _lengthSize(lengthSize), _bigEndian(bigEndian), _lengthAdjustment(lengthAdjustment) {
+  if (_lengthSize != 1 && _lengthSize != 2 && _lengthSize != 4) _lengthSize = 1;
+}
+
+void LengthPrefixFrameDecoder::decode(const uint8_t *data, size_t size, const FrameCallback &frameCallback) {
+  const size_t headerSize = _lengthOffset + _lengthSize;
+  while (true) {
+    if (_frame.size() < headerSize) {
+      size_t bytes = std::min(headerSize - _frame.size(), size);
+      _frame.insert(_frame.end(), data, data + bytes);
+      data += bytes;
+      size -= bytes;
+      if (_frame.size() < headerSize) return;
+    }
+
+    uint32_t length = 0;
+    for (size_t i = 0; i < _lengthSize; i++) {
+      if (_bigEndian) length = (length << 8) | _frame[_lengthOffset + i];
+      else length |= ((uint32_t)_frame[_lengthOffset + i]) << (i * 8);
+    }
+    int64_t frameSize = (int64_t)headerSize + length + _lengthAdjustment;
+    if (frameSize < (int64_t)headerSize || frameSize > (int64_t)_maxFrameSize) {
+      //Invalid length. Skip one byte and try to resynchronize.
+      _frame.erase(_frame.begin());
+      continue;
+    }
+
+    size_t bytes = std::min((size_t)frameSize - _frame.size(), size);
+    _frame.insert(_frame.end(), data, data + bytes);
+    data += bytes;
+    size -= bytes;
+    if (_frame.size() < (size_t)frameSize) return;
+
+    frameCallback(_frame);
+    _frame.clear();
+    if (size == 0) return;
+  }
+}
+// }}}
+
+// {{{ SlipFrameDecoder
+void SlipFrameDecoder::reset() {
+  _frame.clear();
+  _escaped = false;
+  _dropping = false;
+}
+
+void SlipFrameDecoder::decode(const uint8_t *data, size_t size, const FrameCallback &frameCallback) {
+  for (const uint8_t *end = data + size; data < end; data++) {
+    uint8_t byte = *data;
+    if (byte == 0xC0) { //END
+      if (!_dropping && !_frame.empty()) frameCallback(_frame);
+      _frame.clear();
+      _escaped = false;
+      _dropping = false;
+      continue;
+    }
+    if (_dropping) continue;
+    if (_escaped) {
+      _escaped = false;
+      if (byte == 0xDC) byte = 0xC0; //ESC_END
+      else if (byte == 0xDD) byte = 0xDB; //ESC_ESC
+    } else if (byte == 0xDB) { //ESC
+      _escaped = true;
+      continue;
+    }
+    if (_frame.size() >= _maxFrameSize) {
+      _frame.clear();
+      _dropping = true;
+      continue;
+    }
+    _frame.push_back(byte);
+  }
+}
+// }}}
+
+// {{{ CobsFrameDecoder
+void CobsFrameDecoder::reset() {
+  _frame.clear();
+  _remaining = 0;
+  _appendZero = false;
+  _dropping = false;
+}
+
+void CobsFrameDecoder::decode(const uint8_t *data, size_t size, const FrameCallback &frameCallback) {
+  for (const uint8_t *end = data + size; data < end; data++) {
+    uint8_t byte = *data;
+    if (byte == 0) { //End of frame. The frame is invalid, when the last block is incomplete.
+      if (!_dropping && _remaining == 0 && !_frame.empty()) frameCallback(_frame);
+      _frame.clear();
+      _remaining = 0;
+      _appendZero = false;
+      _dropping = false;
+      continue;
+    }
+    if (_dropping) continue;
+    if (_frame.size() + 1 > _maxFrameSize) {
+      _frame.clear();
+      _dropping = true;
+      continue;
+    }
+    if (_remaining == 0) { //Code byte
+      if (_appendZero) _frame.push_back(0);
+      _remaining = byte - 1;
+      _appendZero = (byte != 0xFF);
+      continue;
+    }
+    _frame.push_back(byte);
+    _remaining--;
+  }
+}
+// }}}
+
+// {{{ StxEtxFrameDecoder
+StxEtxFrameDecoder::StxEtxFrameDecoder(uint8_t start, uint8_t end, uint8_t escape, uint8_t escapeXor, size_t maxFrameSize) : SerialFrameDecoder(maxFrameSize), _start(start), _end(end), _escape(escape), _escapeXor(escapeXor) {
+}
+
+void StxEtxFrameDecoder::reset() {
+  _frame.clear();
+  _inFrame = false;
+  _escaped = false;
+}
+
+void StxEtxFrameDecoder::decode(const uint8_t *data, size_t size, const FrameCallback &frameCallback) {
+  for (const uint8_t *end = data + size; data < end; data++) {
+    uint8_t byte = *data;
+    if (!_inFrame) {
+      if (byte == _start) {
+        _inFrame = true;
+        _escaped = false;
+        _frame.clear();
+      }
+      continue;
+    }
+    if (_escaped) {
+      _escaped = false;
+      byte ^= _escapeXor;
+    } else if (byte == _escape) {
+      _escaped = true;
+      continue;
+    } else if (byte == _end) {
+      frameCallback(_frame);
+      _frame.clear();
+      _inFrame = false;
+      continue;
+    } else if (byte == _start) { //Unescaped start byte. The previous frame is incomplete.
+      _frame.clear();
+      continue;
+    }
+    if (_frame.size() >= _maxFrameSize) {
+      _frame.clear();
+      _inFrame = false;
+      continue;
+    }
+    _frame.push_back(byte);
+  }
+}
+// }}}
+
+}
@@ -0,0 +1,175 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef LIBHOMEGEAR_BASE_SERIALFRAMEDECODER_H
+#define LIBHOMEGEAR_BASE_SERIALFRAMEDECODER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace BaseLib {
+
+/**
+ * Base class of decoders splitting a serial byte stream into frames. Decoders are stateful: Data can be passed in chunks of any size and incomplete frames
+ * are kept until the rest is received. Set a decoder with SerialReaderWriter::setFrameDecoder().
+ *
+ * @see SerialReaderWriter
+ */
+class SerialFrameDecoder {
+ public:
+  typedef std::function<void(const std::vector<uint8_t> &frame)> FrameCallback;
+
+  /**
+   * @param maxFrameSize Frames larger than this are dropped.
+   */
+  explicit SerialFrameDecoder(size_t maxFrameSize) : _maxFrameSize(maxFrameSize) {}
+  virtual ~SerialFrameDecoder() = default;
+
+  /**
+   * Processes received data and calls frameCallback once for every completed frame.
+   *
+   * @param data The received data.
+   * @param size The size of data.
+   * @param frameCallback The callback to call for every frame. The frame is only valid during the call.
+   */
+  virtual void decode(const uint8_t *data, size_t size, const FrameCallback &frameCallback) = 0;
+
+  /**
+   * Discards incomplete data. Called when the device is (re)opened.
+   */
+  virtual void reset() { _frame.clear(); }
+ protected:
+  size_t _maxFrameSize = 0;
+  std::vector<uint8_t> _frame;
+};
+
+/**
+ * Splits frames at a delimiter byte.
+ */
+class DelimiterFrameDecoder : public SerialFrameDecoder {
+ public:
+  /**
+   * @param delimiter The byte terminating a frame.
+   * @param includeDelimiter When true, the delimiter is kept at the end of the frame.
+   * @param maxFrameSize Frames larger than this are dropped.
+   */
+  explicit DelimiterFrameDecoder(uint8_t delimiter, bool includeDelimiter = false, size_t maxFrameSize = 4096);
+
+  void decode(const uint8_t *data, size_t size, const FrameCallback &frameCallback) override;
+  void reset() override;
+ private:
+  uint8_t _delimiter = 0;
+  bool _includeDelimiter = false;
+  bool _dropping = false;
+};
+
+/**
+ * Decodes frames containing a length field. The frame size is calculated as "lengthOffset + lengthSize + length + lengthAdjustment". Frames are returned
+ * including the length field and everything before it.
+ */
+class LengthPrefixFrameDecoder : public SerialFrameDecoder {
+ public:
+  /**
+   * @param lengthOffset The position of the length field within the frame.
+   * @param lengthSize The size of the length field in bytes (1, 2 or 4).
+   * @param bigEndian Set to true when the length field is big endian.
+   * @param lengthAdjustment Value added to the length field, e. g. "2" when a checksum follows the counted bytes or "-1" when the length includes itself.
+   * @param maxFrameSize Frames larger than this are dropped and decoding resynchronizes at the next byte.
+   */
+  LengthPrefixFrameDecoder(size_t lengthOffset, size_t lengthSize, bool bigEndian = true, int32_t lengthAdjustment = 0, size_t maxFrameSize = 4096);
+
+  void decode(const uint8_t *data, size_t size, const FrameCallback &frameCallback) override;
+ private:
+  size_t _lengthOffset = 0;
+  size_t _lengthSize = 1;
+  bool _bigEndian = true;
+  int32_t _lengthAdjustment = 0;
+};
+
+/**
+ * Decodes SLIP (RFC 1055) frames. Empty frames are ignored.
+ */
+class SlipFrameDecoder : public SerialFrameDecoder {
+ public:
+  explicit SlipFrameDecoder(size_t maxFrameSize = 4096) : SerialFrameDecoder(maxFrameSize) {}
+
+  void decode(const uint8_t *data, size_t size, const FrameCallback &frameCallback) override;
+  void reset() override;
+ private:
+  bool _escaped = false;
+  bool _dropping = false;
+};
+
+/**
+ * Decodes frames encoded with Consistent Overhead Byte Stuffing and terminated by "0x00". Empty and invalid frames are ignored.
+ */
+class CobsFrameDecoder : public SerialFrameDecoder {
+ public:
+  explicit CobsFrameDecoder(size_t maxFrameSize = 4096) : SerialFrameDecoder(maxFrameSize) {}
+
+  void decode(const uint8_t *data, size_t size, const FrameCallback &frameCallback) override;
+  void reset() override;
+ private:
+  uint8_t _remaining = 0;
+  bool _appendZero = false;
+  bool _dropping = false;
+};
+
+/**
+ * Decodes frames enclosed by start and end bytes (e. g. STX and ETX). Within the frame, start, end and escape bytes are prefixed by an escape byte (e. g.
+ * DLE). Bytes outside of frames are ignored. The returned frames don't contain the start and end bytes.
+ */
+class StxEtxFrameDecoder : public SerialFrameDecoder {
+ public:
+  /**
+   * @param start The byte starting a frame.
+   * @param end The byte ending a frame.
+   * @param escape The escape byte.
+   * @param escapeXor The value the byte following an escape byte is XORed with. Set to "0" when escaped bytes are transmitted as is.
+   * @param maxFrameSize Frames larger than this are dropped.
+   */
+  StxEtxFrameDecoder(uint8_t start = 0x02, uint8_t end = 0x03, uint8_t escape = 0x10, uint8_t escapeXor = 0, size_t maxFrameSize = 4096);
+
+  void decode(const uint8_t *data, size_t size, const FrameCallback &frameCallback) override;
+  void reset() override;
+ private:
+  uint8_t _start = 0x02;
+  uint8_t _end = 0x03;
+  uint8_t _escape = 0x10;
+  uint8_t _escapeXor = 0;
+  bool _inFrame = false;
+  bool _escaped = false;
+};
+
+}
+
+#endif
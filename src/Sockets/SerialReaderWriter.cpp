@@ -51,6 +51,7 @@ SerialReaderWriter::SerialReaderWriter(BaseLib::SharedObjects *baseLib, std::str
   _stopReadThread = false;
   _writeOnly = writeOnly;
   memset(&_termios, 0, sizeof(termios));
+  _readBuffer.resize(4096);
 
   if (writeOnly) {
     _flags &= ~O_RDWR;
@@ -59,7 +60,10 @@ SerialReaderWriter::SerialReaderWriter(BaseLib::SharedObjects *baseLib, std::str
 }
 
 SerialReaderWriter::~SerialReaderWriter() {
-  _handles = 0;
+  {
+    std::lock_guard<std::mutex> reopenGuard(_reopenMutex);
+    _handles = 0;
+  }
   closeDevice();
 }
 
@@ -82,8 +86,17 @@ void SerialReaderWriter::setWriteGpio(int32_t index, const std::string &gpio_pat
 }
 
 void SerialReaderWriter::openDevice(bool parity, bool oddParity, bool events, CharacterSize characterSize, bool twoStopBits) {
-  _handles++;
-  if (_fileDescriptor->descriptor > -1) return;
+  {
+    std::lock_guard<std::mutex> reopenGuard(_reopenMutex);
+    _handles++;
+    _cancelReopen = false;
+    if (_fileDescriptor->descriptor > -1) return;
+    openDescriptor(parity, oddParity, events, characterSize, twoStopBits);
+  }
+  startReading();
+}
+
+void SerialReaderWriter::openDescriptor(bool parity, bool oddParity, bool events, CharacterSize characterSize, bool twoStopBits) {
   _fileDescriptor = _bl->fileDescriptorManager.add(open(_device.c_str(), _flags | O_CLOEXEC));
   if (_fileDescriptor->descriptor == -1) throw SerialReaderWriterException("Couldn't open device \"" + _device + "\": " + strerror(errno));
 
@@ -175,120 +188,286 @@ void SerialReaderWriter::openDevice(bool parity, bool oddParity, bool events, Ch
     if (fcntl(_fileDescriptor->descriptor, F_SETFL, flags | O_NONBLOCK) == -1) throw SerialReaderWriterException("Couldn't set device to non blocking mode: " + _device);
   }
 
+  _readBufferStart = 0;
+  _readBufferEnd = 0;
+  _decodedFrames.clear();
+  if (_frameDecoder) _frameDecoder->reset();
+  _parity = parity;
+  _oddParity = oddParity;
+  _events = events;
+  _characterSize = characterSize;
+  _twoStopBits = twoStopBits;
   _stopReadThread = false;
-  if (events && !_writeOnly) {
-    _readThreadMutex.lock();
-    _bl->threadManager.join(_readThread);
-    if (_readThreadPriority > -1) _bl->threadManager.start(_readThread, true, _readThreadPriority, SCHED_FIFO, &SerialReaderWriter::readThread, this, parity, oddParity, characterSize, twoStopBits);
-    else _bl->threadManager.start(_readThread, true, &SerialReaderWriter::readThread, this, parity, oddParity, characterSize, twoStopBits);
-    _readThreadMutex.unlock();
-  }
 }
 
-void SerialReaderWriter::closeDevice() {
-  _handles--;
-  if (_handles > 0) return;
+void SerialReaderWriter::startReading() {
+  if (!_events || _writeOnly) return;
+  if (_useSharedReadThread && _bl->serialDeviceManager.addToEventLoop(this)) return;
   _readThreadMutex.lock();
-  _stopReadThread = true;
   _bl->threadManager.join(_readThread);
+  if (_readThreadPriority > -1) _bl->threadManager.start(_readThread, true, _readThreadPriority, SCHED_FIFO, &SerialReaderWriter::readThread, this, _parity, _oddParity, _characterSize, _twoStopBits);
+  else _bl->threadManager.start(_readThread, true, &SerialReaderWriter::readThread, this, _parity, _oddParity, _characterSize, _twoStopBits);
   _readThreadMutex.unlock();
+}
+
+void SerialReaderWriter::closeDevice() {
+  {
+    std::lock_guard<std::mutex> reopenGuard(_reopenMutex);
+    if (_handles > 0) _handles--;
+    if (_handles > 0) return;
+    //Make sure a pending reopen doesn't open the device again.
+    _cancelReopen = true;
+    _reopenRequested = false;
+  }
+  _reopenConditionVariable.notify_all();
   _openDeviceThreadMutex.lock();
   _bl->threadManager.join(_openDeviceThread);
   _openDeviceThreadMutex.unlock();
+  if (_useSharedReadThread) _bl->serialDeviceManager.removeFromEventLoop(this);
+  _readThreadMutex.lock();
+  _stopReadThread = true;
+  _bl->threadManager.join(_readThread);
+  _readThreadMutex.unlock();
   _bl->fileDescriptorManager.close(_fileDescriptor);
 }
 
+size_t SerialReaderWriter::compactReadBuffer() {
+  if (_readBufferStart == _readBufferEnd) {
+    _readBufferStart = 0;
+    _readBufferEnd = 0;
+  } else if (_readBufferStart > 0 && _readBufferEnd == _readBuffer.size()) {
+    memmove(_readBuffer.data(), _readBuffer.data() + _readBufferStart, _readBufferEnd - _readBufferStart);
+    _readBufferEnd -= _readBufferStart;
+    _readBufferStart = 0;
+  }
+  return _readBuffer.size() - _readBufferEnd;
+}
+
+int32_t SerialReaderWriter::fillReadBuffer(uint32_t timeout) {
+  if (_fileDescriptor->descriptor == -1) {
+    _bl->out.printError("Error: File descriptor is invalid.");
+    return -1;
+  }
+
+  size_t freeSpace = compactReadBuffer();
+  if (freeSpace == 0) return 0;
+
+  pollfd poll_struct{
+      (int)_fileDescriptor->descriptor,
+      (short)(POLLIN),
+      (short)(0)
+  };
+
+  int32_t poll_result = -1;
+  do {
+    poll_result = poll(&poll_struct, 1, (int)(timeout / 1000));
+  } while (poll_result == -1 && errno == EINTR);
+  if (poll_result == -1 || (poll_struct.revents & (POLLNVAL | POLLERR | POLLHUP)) || _fileDescriptor->descriptor == -1) {
+    //Error
+    _bl->fileDescriptorManager.close(_fileDescriptor);
+    return -1;
+  }
+
+  if (poll_result == 0) {
+    //Timeout
+    return 1;
+  }
+
+  if (read_gpio_index_ != -1) gpio_->set(read_gpio_index_, true);
+  ssize_t bytes_read = read(_fileDescriptor->descriptor, _readBuffer.data() + _readBufferEnd, freeSpace);
+  if (read_gpio_index_ != -1) gpio_->set(read_gpio_index_, false);
+  if (bytes_read == -1 || bytes_read == 0) {
+    if (bytes_read == -1 && (errno == EAGAIN || errno == EINTR)) return 0;
+    _bl->fileDescriptorManager.close(_fileDescriptor);
+    return -1;
+  }
+  _readBufferEnd += bytes_read;
+  return 0;
+}
+
 int32_t SerialReaderWriter::readChar(char &data, uint32_t timeout) {
   if (_writeOnly) return -1;
-  int32_t bytes_read = 0;
   while (!_stopReadThread) {
-    if (_fileDescriptor->descriptor == -1) {
-      _bl->out.printError("Error: File descriptor is invalid.");
-      return -1;
+    if (_readBufferStart < _readBufferEnd) {
+      data = _readBuffer[_readBufferStart++];
+      return 0;
     }
+    int32_t result = fillReadBuffer(timeout);
+    if (result != 0) return result;
+  }
+  return -1;
+}
 
-    pollfd poll_struct{
-        (int)_fileDescriptor->descriptor,
-        (short)(POLLIN),
-        (short)(0)
-    };
-
-    int32_t poll_result = -1;
-    do {
-      poll_result = poll(&poll_struct, 1, (int)(timeout / 1000));
-    } while (poll_result == -1 && errno == EINTR);
-    if (poll_result == -1 || (poll_struct.revents & (POLLNVAL | POLLERR | POLLHUP)) || _fileDescriptor->descriptor == -1) {
-      //Error
+int32_t SerialReaderWriter::readLine(std::string &data, uint32_t timeout, char splitChar) {
+  if (_writeOnly) return -1;
+  data.clear();
+  while (!_stopReadThread) {
+    char *begin = _readBuffer.data() + _readBufferStart;
+    auto *lineEnd = (char *)memchr(begin, splitChar, _readBufferEnd - _readBufferStart);
+    if (lineEnd) {
+      data.assign(begin, lineEnd + 1);
+      _readBufferStart += (lineEnd + 1) - begin;
+      return 0;
+    }
+    if (_readBufferEnd - _readBufferStart > 1024) {
+      //Something is wrong
+      _readBufferStart = 0;
+      _readBufferEnd = 0;
       _bl->fileDescriptorManager.close(_fileDescriptor);
-      return -1;
     }
-
-    if (poll_result == 0) {
-      //Timeout
-      return 1;
+    int32_t result = fillReadBuffer(timeout);
+    if (result != 0) {
+      //Like reading unbuffered, the incomplete line is returned and dropped on timeouts and errors.
+      data.assign(_readBuffer.data() + _readBufferStart, _readBufferEnd - _readBufferStart);
+      _readBufferStart = 0;
+      _readBufferEnd = 0;
+      return result;
     }
+  }
+  return -1;
+}
 
-    if (read_gpio_index_ != -1) gpio_->set(read_gpio_index_, true);
-    bytes_read = read(_fileDescriptor->descriptor, &data, 1);
-    if (read_gpio_index_ != -1) gpio_->set(read_gpio_index_, false);
-    if (bytes_read == -1 || bytes_read == 0) {
-      if (bytes_read == -1 && (errno == EAGAIN || errno == EINTR)) continue;
-      _bl->fileDescriptorManager.close(_fileDescriptor);
-      return -1;
+int32_t SerialReaderWriter::readFrame(std::vector<uint8_t> &frame, uint32_t timeout) {
+  if (_writeOnly || !_frameDecoder) return -1;
+  while (!_stopReadThread) {
+    if (!_decodedFrames.empty()) {
+      frame.swap(_decodedFrames.front());
+      _decodedFrames.pop_front();
+      return 0;
     }
-    return 0;
+    int32_t result = fillReadBuffer(timeout);
+    if (result != 0) return result;
+    decodeReadBuffer([this](const std::vector<uint8_t> &decodedFrame) { _decodedFrames.push_back(decodedFrame); });
   }
   return -1;
 }
 
-int32_t SerialReaderWriter::readLine(std::string &data, uint32_t timeout, char splitChar) {
-  if (_writeOnly) return -1;
-  data.clear();
-  int32_t bytes_read = 0;
-  char localBuffer[1];
-  while (!_stopReadThread) {
-    if (_fileDescriptor->descriptor == -1) {
-      _bl->out.printError("Error: File descriptor is invalid.");
-      return -1;
+void SerialReaderWriter::decodeReadBuffer(const SerialFrameDecoder::FrameCallback &frameCallback) {
+  _frameDecoder->decode((uint8_t *)_readBuffer.data() + _readBufferStart, _readBufferEnd - _readBufferStart, frameCallback);
+  _readBufferStart = 0;
+  _readBufferEnd = 0;
+}
+
+void SerialReaderWriter::handleReadable() {
+  try {
+    if (_fileDescriptor->descriptor == -1) return;
+    while (true) {
+      size_t freeSpace = compactReadBuffer();
+      if (read_gpio_index_ != -1) gpio_->set(read_gpio_index_, true);
+      ssize_t bytes_read = freeSpace > 0 ? read(_fileDescriptor->descriptor, _readBuffer.data() + _readBufferEnd, freeSpace) : 0;
+      if (read_gpio_index_ != -1) gpio_->set(read_gpio_index_, false);
+      if (bytes_read == -1 && errno == EINTR) continue;
+      if (bytes_read == -1 && errno == EAGAIN) break;
+      if (bytes_read <= 0) {
+        //Stop the event loop from reporting the broken descriptor again, the reopen is done by another thread.
+        _bl->serialDeviceManager.removeFromEventLoop(this);
+        reopenDevice();
+        return;
+      }
+      _readBufferEnd += bytes_read;
+
+      if (_frameDecoder) {
+        decodeReadBuffer([this](const std::vector<uint8_t> &frame) { raiseFrameReceived(frame); });
+        if ((size_t)bytes_read < freeSpace) break;
+        continue;
+      }
+
+      char *begin = _readBuffer.data() + _readBufferStart;
+      char *lineEnd = nullptr;
+      while ((lineEnd = (char *)memchr(begin, '\n', _readBufferEnd - _readBufferStart))) {
+        raiseLineReceived(std::string(begin, lineEnd + 1));
+        _readBufferStart += (lineEnd + 1) - begin;
+        begin = lineEnd + 1;
+      }
+      if (_readBufferEnd - _readBufferStart > 1024) {
+        //Something is wrong
+        _bl->serialDeviceManager.removeFromEventLoop(this);
+        reopenDevice();
+        return;
+      }
+      if ((size_t)bytes_read < freeSpace) break;
     }
+  }
+  catch (const std::exception &ex) {
+    _bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
 
-    pollfd poll_struct{
-        (int)_fileDescriptor->descriptor,
-        (short)(POLLIN),
-        (short)(0)
-    };
-
-    int32_t poll_result = -1;
-    do {
-      poll_result = poll(&poll_struct, 1, (int)(timeout / 1000));
-    } while (poll_result == -1 && errno == EINTR);
-    if (poll_result == -1 || (poll_struct.revents & (POLLNVAL | POLLERR | POLLHUP)) || _fileDescriptor->descriptor == -1) {
-      //Error
-      _bl->fileDescriptorManager.close(_fileDescriptor);
-      return -1;
+void SerialReaderWriter::raiseLineReceived(const std::string &data) {
+  EventHandlers eventHandlers = getEventHandlers();
+  for (const auto &eventHandler: eventHandlers) {
+    eventHandler.second->lock();
+    try {
+      if (eventHandler.second->handler()) ((ISerialReaderWriterEventSink *)eventHandler.second->handler())->lineReceived(data);
+    }
+    catch (const std::exception &ex) {
+      _bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    eventHandler.second->unlock();
+  }
+}
+
+void SerialReaderWriter::raiseFrameReceived(const std::vector<uint8_t> &frame) {
+  EventHandlers eventHandlers = getEventHandlers();
+  for (const auto &eventHandler: eventHandlers) {
+    eventHandler.second->lock();
+    try {
+      if (eventHandler.second->handler()) ((ISerialReaderWriterEventSink *)eventHandler.second->handler())->frameReceived(frame);
+    }
+    catch (const std::exception &ex) {
+      _bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
     }
+    eventHandler.second->unlock();
+  }
+}
 
-    if (poll_result == 0) {
-      //Timeout
-      return 1;
+void SerialReaderWriter::reopenDevice() {
+  {
+    std::lock_guard<std::mutex> reopenGuard(_reopenMutex);
+    if (_cancelReopen) return;
+    _bl->out.printError("Error: Reading from serial device \"" + _device + "\" failed. Reopening device in 5 seconds.");
+    if (_reopenPending) {
+      //The running reopen thread starts over when it is done.
+      _reopenRequested = true;
+      return;
     }
+    _reopenPending = true;
+  }
+  //No reopen is pending, so this only joins a thread which already finished.
+  std::lock_guard<std::mutex> openDeviceThreadGuard(_openDeviceThreadMutex);
+  _bl->threadManager.join(_openDeviceThread);
+  if (!_bl->threadManager.start(_openDeviceThread, true, &SerialReaderWriter::openDeviceDelayed, this)) {
+    std::lock_guard<std::mutex> reopenGuard(_reopenMutex);
+    _reopenPending = false;
+  }
+}
 
-    if (read_gpio_index_ != -1) gpio_->set(read_gpio_index_, true);
-    bytes_read = read(_fileDescriptor->descriptor, localBuffer, 1);
-    if (read_gpio_index_ != -1) gpio_->set(read_gpio_index_, false);
-    if (bytes_read == -1 || bytes_read == 0) {
-      if (errno == EAGAIN || errno == EINTR) continue;
+void SerialReaderWriter::openDeviceDelayed() {
+  while (true) {
+    try {
+      //A read thread has returned at this point. Also make sure the shared event loop doesn't service the device anymore before closing it.
+      if (_useSharedReadThread) _bl->serialDeviceManager.removeFromEventLoop(this);
       _bl->fileDescriptorManager.close(_fileDescriptor);
-      continue;
+      std::unique_lock<std::mutex> reopenGuard(_reopenMutex);
+      _reopenConditionVariable.wait_for(reopenGuard, std::chrono::milliseconds(5000), [&] { return _cancelReopen; });
+      if (!_cancelReopen && _handles > 0 && _fileDescriptor->descriptor == -1) {
+        openDescriptor(_parity, _oddParity, _events, _characterSize, _twoStopBits);
+        reopenGuard.unlock();
+        startReading();
+      }
     }
-    data.push_back(localBuffer[0]);
-    if (data.size() > 1024) {
-      //Something is wrong
-      _bl->fileDescriptorManager.close(_fileDescriptor);
+    catch (const std::exception &ex) {
+      _bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+    std::lock_guard<std::mutex> reopenGuard(_reopenMutex);
+    if (_reopenRequested && !_cancelReopen) {
+      _reopenRequested = false;
+      continue;
     }
-    if (localBuffer[0] == splitChar) return 0;
+    _reopenRequested = false;
+    _reopenPending = false;
+    return;
   }
-  return -1;
 }
 
 void SerialReaderWriter::writeLine(std::string &data) {
@@ -400,27 +579,12 @@ void SerialReaderWriter::readThread(bool parity, bool oddParity, CharacterSize c
   while (!_stopReadThread) {
     try {
       if (_fileDescriptor->descriptor == -1) {
-        closeDevice();
-        std::this_thread::sleep_for(std::chrono::milliseconds(5000));
-        _openDeviceThreadMutex.lock();
-        _bl->threadManager.join(_openDeviceThread);
-        _bl->threadManager.start(_openDeviceThread, true, &SerialReaderWriter::openDevice, this, parity, oddParity, true, characterSize, twoStopBits);
-        _openDeviceThreadMutex.unlock();
+        reopenDevice();
         return;
       }
-      if (readLine(data) == 0) {
-        EventHandlers eventHandlers = getEventHandlers();
-        for (const auto &eventHandler: eventHandlers) {
-          eventHandler.second->lock();
-          try {
-            if (eventHandler.second->handler()) ((ISerialReaderWriterEventSink *)eventHandler.second->handler())->lineReceived(data);
-          }
-          catch (const std::exception &ex) {
-            _bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
-          }
-          eventHandler.second->unlock();
-        }
-      }
+      if (_frameDecoder) {
+        if (fillReadBuffer(500000) == 0) decodeReadBuffer([this](const std::vector<uint8_t> &frame) { raiseFrameReceived(frame); });
+      } else if (readLine(data) == 0) raiseLineReceived(data);
       continue;
     }
     catch (const std::exception &ex) {
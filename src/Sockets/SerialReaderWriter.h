@@ -37,9 +37,14 @@
 #include "../Managers/FileDescriptorManager.h"
 #include "../IEvents.h"
 #include "../LowLevel/Gpio.h"
+#include "SerialFrameDecoder.h"
 
 #include <thread>
 #include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <deque>
+#include <vector>
 
 #include <unistd.h>
 #include <fcntl.h>
@@ -65,6 +70,13 @@ class SerialReaderWriter : public IEventsEx {
   class ISerialReaderWriterEventSink : public IEventSinkBase {
    public:
     virtual void lineReceived(const std::string &data) = 0;
+
+    /**
+     * Called for every complete frame when a frame decoder is set.
+     *
+     * @see SerialReaderWriter::setFrameDecoder()
+     */
+    virtual void frameReceived(const std::vector<uint8_t> &frame) {}
   };
   // }}}
 
@@ -87,6 +99,21 @@ class SerialReaderWriter : public IEventsEx {
   virtual ~SerialReaderWriter();
 
   bool isOpen() { return _fileDescriptor && _fileDescriptor->descriptor != -1; }
+
+  /**
+   * When enabled, "openDevice()" doesn't start a read thread for this device. Instead the device is serviced by the event loop of SerialDeviceManager,
+   * which uses one thread for all devices. Must be called before "openDevice()".
+   */
+  void setUseSharedReadThread(bool value) { _useSharedReadThread = value; }
+
+  /**
+   * Sets a decoder to split the received data into frames. When set, events are raised through "frameReceived()" instead of "lineReceived()" and frames can
+   * be polled with "readFrame()". Must be called before "openDevice()".
+   *
+   * @param decoder The decoder to use, e. g. SlipFrameDecoder. Set to nullptr to switch back to line based reading.
+   */
+  void setFrameDecoder(std::shared_ptr<SerialFrameDecoder> decoder) { _frameDecoder = std::move(decoder); }
+
   std::shared_ptr<FileDescriptor> fileDescriptor() { return _fileDescriptor; }
 
   /**
@@ -108,7 +135,7 @@ class SerialReaderWriter : public IEventsEx {
    *
    * @param evenParity Enable parity checking using an even parity bit.
    * @param oddParity Enable parity checking using an odd parity bit. "evenParity" and "oddParity" are mutually exclusive.
-   * @param events Enable events. This starts a thread which calls "lineReceived()" in a derived class for each received packet.
+   * @param events Enable events. This starts a thread (or registers the device with the shared read thread) which calls "lineReceived()" in a derived class for each received packet.
    * @param characterSize Set the character Size.
    * @param twoStopBits Enable two stop bits instead of one.
    */
@@ -124,7 +151,8 @@ class SerialReaderWriter : public IEventsEx {
    * @param data The variable to write the returned line into.
    * @param timeout The maximum amount of time to wait in microseconds before the function returns (default: 500000).
    * @param splitChar The character to split at (default: '\n')
-   * @return Returns "0" on success, "1" on timeout or "-1" on error.
+   * @return Returns "0" on success, "1" on timeout or "-1" on error. On timeouts and errors "data" contains the incomplete line read so far, which is
+   * discarded.
    */
   int32_t readLine(std::string &data, uint32_t timeout = 500000, char splitChar = '\n');
 
@@ -136,6 +164,14 @@ class SerialReaderWriter : public IEventsEx {
    */
   int32_t readChar(char &data, uint32_t timeout = 500000);
 
+  /**
+   * Polls for the next frame. Only available when a frame decoder is set.
+   * @param frame The variable to write the returned frame into.
+   * @param timeout The maximum amount of time to wait in microseconds before the function returns (default: 500000).
+   * @return Returns "0" on success, "1" on timeout or "-1" on error.
+   */
+  int32_t readFrame(std::vector<uint8_t> &frame, uint32_t timeout = 500000);
+
   /**
    * Writes one line of data.
    * @param data The data to write. If data is not terminated by a new line character, it is appended.
@@ -159,6 +195,12 @@ class SerialReaderWriter : public IEventsEx {
    * @param data The (binary) character to write.
    */
   void writeChar(char data);
+
+  /**
+   * Called by the event loop of SerialDeviceManager when the device is readable. Reads all available data and raises "lineReceived()" or "frameReceived()"
+   * for each complete line or frame. Don't call this method directly.
+   */
+  void handleReadable();
  protected:
   BaseLib::SharedObjects *_bl = nullptr;
   std::shared_ptr<FileDescriptor> _fileDescriptor;
@@ -168,6 +210,10 @@ class SerialReaderWriter : public IEventsEx {
   int32_t _baudrate = 0;
   int32_t _flags = 0;
   int32_t _readThreadPriority = 0;
+
+  /**
+   * The number of openDevice() calls not matched by closeDevice() yet. Protected by _reopenMutex.
+   */
   int32_t _handles = 0;
 
   int32_t read_gpio_index_ = -1;
@@ -181,6 +227,80 @@ class SerialReaderWriter : public IEventsEx {
   std::mutex _openDeviceThreadMutex;
   std::thread _openDeviceThread;
 
+  /**
+   * Protects _handles and the reopen state and is held while the device is opened.
+   */
+  std::mutex _reopenMutex;
+  std::condition_variable _reopenConditionVariable;
+  bool _cancelReopen = false;
+  bool _reopenPending = false;
+  bool _reopenRequested = false;
+
+  bool _useSharedReadThread = false;
+  bool _parity = false;
+  bool _oddParity = false;
+  bool _events = true;
+  CharacterSize _characterSize = CharacterSize::Eight;
+  bool _twoStopBits = false;
+
+  /**
+   * Received data not consumed yet. The valid data lies between _readBufferStart and _readBufferEnd. Only accessed by the thread reading from the device.
+   */
+  std::vector<char> _readBuffer;
+  size_t _readBufferStart = 0;
+  size_t _readBufferEnd = 0;
+
+  std::shared_ptr<SerialFrameDecoder> _frameDecoder;
+
+  /**
+   * Frames decoded but not returned by "readFrame()" yet.
+   */
+  std::deque<std::vector<uint8_t>> _decodedFrames;
+
+  /**
+   * Waits for data and reads everything available into _readBuffer with one system call.
+   *
+   * @param timeout The maximum amount of time to wait in microseconds.
+   * @return Returns "0" on success, "1" on timeout or "-1" on error.
+   */
+  int32_t fillReadBuffer(uint32_t timeout);
+
+  /**
+   * Makes room at the end of _readBuffer by moving the unconsumed data to the beginning.
+   *
+   * @return Returns the number of bytes available at the end of the buffer.
+   */
+  size_t compactReadBuffer();
+
+  void raiseLineReceived(const std::string &data);
+
+  void raiseFrameReceived(const std::vector<uint8_t> &frame);
+
+  /**
+   * Passes all data in _readBuffer to the frame decoder and empties the buffer.
+   */
+  void decodeReadBuffer(const SerialFrameDecoder::FrameCallback &frameCallback);
+
+  /**
+   * Opens the device without counting a handle. _reopenMutex must be locked. Call startReading() afterwards.
+   */
+  void openDescriptor(bool parity, bool oddParity, bool events, CharacterSize characterSize, bool twoStopBits);
+
+  /**
+   * Adds the opened device to the shared event loop or starts its read thread. Must be called without holding _reopenMutex, as the event loop
+   * takes _reopenMutex while its own mutex is locked.
+   */
+  void startReading();
+
+  /**
+   * Starts a thread which closes the device and reopens it after 5 seconds, unless closeDevice() is called in the meantime. Used by the read threads
+   * on errors. Doesn't block, so it can be called from the shared event loop. The device must not be serviced by a read thread anymore when the
+   * reopen thread starts.
+   */
+  void reopenDevice();
+
+  void openDeviceDelayed();
+
   void readThread(bool parity, bool oddParity, CharacterSize characterSize, bool twoStopBits);
 };
 
@@ -148,7 +148,16 @@ void Ssdp::sendSearchBroadcast(std::shared_ptr<FileDescriptor> &serverSocketDesc
   }
 }
 
+void Ssdp::clearCache() {
+  std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+  _cache.clear();
+}
+
 void Ssdp::searchDevices(const std::string &stHeader, uint32_t timeout, std::vector<SsdpInfo> &devices) {
+  searchDevices(stHeader, timeout, [&](const SsdpInfo &device) { devices.push_back(device); });
+}
+
+void Ssdp::searchDevices(const std::string &stHeader, uint32_t timeout, const DeviceCallback &callback) {
   std::shared_ptr<FileDescriptor> serverSocketDescriptor;
   try {
     if (stHeader.empty()) {
@@ -173,7 +182,8 @@ void Ssdp::searchDevices(const std::string &stHeader, uint32_t timeout, std::vec
     timeval socketTimeout{};
     int32_t nfds = 0;
     Http http;
-    std::map<std::string, SsdpInfo> info;
+    auto state = std::make_shared<DiscoveryState>();
+    state->callback = callback;
     while (BaseLib::HelperFunctions::getTime() - startTime <= (timeout + 500)) {
       try {
         if (!serverSocketDescriptor || serverSocketDescriptor->descriptor == -1) break;
@@ -215,7 +225,8 @@ void Ssdp::searchDevices(const std::string &stHeader, uint32_t timeout, std::vec
         if (_bl->debugLevel >= 5) _bl->out.printDebug("Debug: SSDP response received:\n" + std::string(buffer.data(), bytesReceived));
         http.process(buffer.data(), bytesReceived, false);
         if (http.headerIsFinished()) {
-          processPacket(http, stHeader, info);
+          SsdpInfo info;
+          if (processPacket(http, stHeader, info)) deviceFound(info, state);
           http.reset();
         }
       }
@@ -223,7 +234,7 @@ void Ssdp::searchDevices(const std::string &stHeader, uint32_t timeout, std::vec
         _bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
       }
     }
-    getDeviceInfo(info, devices);
+    finishDiscovery(state);
   }
   catch (const std::exception &ex) {
     _bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -232,6 +243,10 @@ void Ssdp::searchDevices(const std::string &stHeader, uint32_t timeout, std::vec
 }
 
 void Ssdp::searchDevicesPassive(const std::string &stHeader, uint32_t timeout, std::vector<SsdpInfo> &devices, std::atomic_bool &abort) {
+  searchDevicesPassive(stHeader, timeout, [&](const SsdpInfo &device) { devices.push_back(device); }, abort);
+}
+
+void Ssdp::searchDevicesPassive(const std::string &stHeader, uint32_t timeout, const DeviceCallback &callback, std::atomic_bool &abort) {
   std::shared_ptr<FileDescriptor> serverSocketDescriptor;
   try {
     if (stHeader.empty()) {
@@ -243,59 +258,85 @@ void Ssdp::searchDevicesPassive(const std::string &stHeader, uint32_t timeout, s
     if (!serverSocketDescriptor || serverSocketDescriptor->descriptor == -1) return;
     if (_bl->debugLevel >= 5) _bl->out.printDebug("Debug: Searching for SSDP devices ...");
 
-    uint64_t startTime = _bl->hf.getTime();
-    std::array<char, 1024> buffer;
-    int32_t bytesReceived = 0;
-    struct sockaddr_in si_other{};
-    socklen_t slen = sizeof(si_other);
-    fd_set readFileDescriptor;
-    timeval socketTimeout{};
-    int32_t nfds = 0;
+    //The socket is serviced by the shared UDP reactor. This thread only waits for the timeout.
+    auto state = std::make_shared<DiscoveryState>();
+    state->callback = callback;
     Http http;
-    std::map<std::string, SsdpInfo> info;
-    while (_bl->hf.getTime() - startTime <= timeout && !abort) {
-      try {
-        if (!serverSocketDescriptor || serverSocketDescriptor->descriptor == -1) break;
+    std::array<char, 1024> buffer{};
+    auto processPassiveResponse = [&](int32_t bytesReceived) {
+      if (_bl->debugLevel >= 5) _bl->out.printDebug("Debug: SSDP response received:\n" + std::string(buffer.data(), bytesReceived));
+      http.reset();
+      http.process(buffer.data(), bytesReceived, false);
+      SsdpInfo info;
+      if (http.headerIsFinished() && processPacketPassive(http, stHeader, info)) deviceFound(info, state);
+    };
+    auto socketReadable = [&](const PFileDescriptor &descriptor) {
+      //Read everything queued, as the reactor only calls us again for new data.
+      while (true) {
+        int32_t bytesReceived = recvfrom(descriptor->descriptor, buffer.data(), buffer.size(), MSG_DONTWAIT, nullptr, nullptr);
+        if (bytesReceived <= 0) {
+          if (bytesReceived == -1 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+            _bl->out.printError("Error: Socket closed (3).");
+            _bl->udpReactor.remove(descriptor);
+          }
+          break;
+        }
+        processPassiveResponse(bytesReceived);
+      }
+    };
 
-        socketTimeout.tv_sec = 0;
-        socketTimeout.tv_usec = 100000;
-        FD_ZERO(&readFileDescriptor);
-        auto fileDescriptorGuard = _bl->fileDescriptorManager.getLock();
-        fileDescriptorGuard.lock();
-        nfds = serverSocketDescriptor->descriptor + 1;
-        if (nfds <= 0) {
+    uint64_t startTime = _bl->hf.getTime();
+    if (_bl->udpReactor.add(serverSocketDescriptor, socketReadable)) {
+      while (_bl->hf.getTime() - startTime <= timeout && !abort) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      }
+      _bl->udpReactor.remove(serverSocketDescriptor);
+    } else {
+      //The reactor is not available (e. g. it was stopped). Read on this thread instead.
+      fd_set readFileDescriptor;
+      timeval socketTimeout{};
+      int32_t nfds = 0;
+      while (_bl->hf.getTime() - startTime <= timeout && !abort) {
+        try {
+          if (!serverSocketDescriptor || serverSocketDescriptor->descriptor == -1) break;
+
+          socketTimeout.tv_sec = 0;
+          socketTimeout.tv_usec = 100000;
+          FD_ZERO(&readFileDescriptor);
+          auto fileDescriptorGuard = _bl->fileDescriptorManager.getLock();
+          fileDescriptorGuard.lock();
+          nfds = serverSocketDescriptor->descriptor + 1;
+          if (nfds <= 0) {
+            fileDescriptorGuard.unlock();
+            _bl->out.printError("Error: Socket closed (1).");
+            _bl->fileDescriptorManager.shutdown(serverSocketDescriptor);
+            continue;
+          }
+          FD_SET(serverSocketDescriptor->descriptor, &readFileDescriptor);
           fileDescriptorGuard.unlock();
-          _bl->out.printError("Error: Socket closed (1).");
-          _bl->fileDescriptorManager.shutdown(serverSocketDescriptor);
-          continue;
-        }
-        FD_SET(serverSocketDescriptor->descriptor, &readFileDescriptor);
-        fileDescriptorGuard.unlock();
-        bytesReceived = select(nfds, &readFileDescriptor, nullptr, nullptr, &socketTimeout);
-        if (bytesReceived == 0) continue;
-        if (bytesReceived != 1) {
-          _bl->out.printError("Error: Socket closed (2).");
-          _bl->fileDescriptorManager.shutdown(serverSocketDescriptor);
-          continue;
-        }
+          int32_t result = select(nfds, &readFileDescriptor, nullptr, nullptr, &socketTimeout);
+          if (result == 0) continue;
+          if (result != 1) {
+            _bl->out.printError("Error: Socket closed (2).");
+            _bl->fileDescriptorManager.shutdown(serverSocketDescriptor);
+            continue;
+          }
 
-        bytesReceived = recvfrom(serverSocketDescriptor->descriptor, buffer.data(), buffer.size(), 0, (struct sockaddr *)&si_other, &slen);
-        if (bytesReceived == 0) continue;
-        else if (bytesReceived == -1) {
-          _bl->out.printError("Error: Socket closed (3).");
-          _bl->fileDescriptorManager.shutdown(serverSocketDescriptor);
-          continue;
+          int32_t bytesReceived = recvfrom(serverSocketDescriptor->descriptor, buffer.data(), buffer.size(), 0, nullptr, nullptr);
+          if (bytesReceived == 0) continue;
+          else if (bytesReceived == -1) {
+            _bl->out.printError("Error: Socket closed (3).");
+            _bl->fileDescriptorManager.shutdown(serverSocketDescriptor);
+            continue;
+          }
+          processPassiveResponse(bytesReceived);
+        }
+        catch (const std::exception &ex) {
+          _bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
         }
-        if (_bl->debugLevel >= 5) _bl->out.printDebug("Debug: SSDP response received:\n" + std::string(buffer.data(), bytesReceived));
-        http.reset();
-        http.process(buffer.data(), bytesReceived, false);
-        if (http.headerIsFinished()) processPacketPassive(http, stHeader, info);
-      }
-      catch (const std::exception &ex) {
-        _bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
       }
     }
-    getDeviceInfo(info, devices);
+    finishDiscovery(state);
   }
   catch (const std::exception &ex) {
     _bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -303,107 +344,241 @@ void Ssdp::searchDevicesPassive(const std::string &stHeader, uint32_t timeout, s
   _bl->fileDescriptorManager.shutdown(serverSocketDescriptor);
 }
 
-void Ssdp::processPacket(Http &http, const std::string &stHeader, std::map<std::string, SsdpInfo> &info) {
+bool Ssdp::processPacket(Http &http, const std::string &stHeader, SsdpInfo &info) {
   try {
     const Http::Header &header = http.getHeader();
-    if (header.responseCode != 200 || (header.fields.at("st") != stHeader && stHeader != "ssdp:all")) return;
+    if (header.responseCode != 200 || (header.fields.at("st") != stHeader && stHeader != "ssdp:all")) return false;
 
     std::string location = header.fields.at("location");
-    if (location.size() < 7) return;
-    SsdpInfo currentInfo;
-    currentInfo.setLocation(location);
+    if (location.size() < 7) return false;
+    info.setLocation(location);
 
     for (auto &field : header.fields) {
-      currentInfo.addField(field.first, field.second);
+      info.addField(field.first, field.second);
     }
 
-    info.emplace(location, currentInfo);
+    return true;
   }
   catch (const std::exception &ex) {
     _bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
   }
+  return false;
 }
 
-void Ssdp::processPacketPassive(Http &http, const std::string &stHeader, std::map<std::string, SsdpInfo> &info) {
+bool Ssdp::processPacketPassive(Http &http, const std::string &stHeader, SsdpInfo &info) {
   try {
     const Http::Header &header = http.getHeader();
-    if (header.method != "NOTIFY") return;
+    if (header.method != "NOTIFY") return false;
     auto headerIterator = header.fields.find("nt");
-    if (headerIterator == header.fields.end() || (headerIterator->second != stHeader && stHeader != "ssdp:all")) return;
-
-    std::string location = header.fields.at("location");
-    if (location.size() < 7) return;
-    SsdpInfo currentInfo;
-    currentInfo.setLocation(location);
+    if (headerIterator == header.fields.end() || (headerIterator->second != stHeader && stHeader != "ssdp:all")) return false;
 
     for (auto &field : header.fields) {
-      currentInfo.addField(field.first, field.second);
+      info.addField(field.first, field.second);
+    }
+
+    if (info.getField("nts") == "ssdp:byebye") {
+      //The device is leaving the network. Its cached description must not be reported anymore.
+      std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+      _cache.erase(getCacheKey(info));
+      return false;
+    }
+
+    std::string location = info.getField("location");
+    if (location.size() < 7) return false;
+    info.setLocation(location);
+
+    return true;
+  }
+  catch (const std::exception &ex) {
+    _bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return false;
+}
+
+std::string Ssdp::getCacheKey(SsdpInfo &info) {
+  std::string usn = info.getField("usn");
+  return usn.empty() ? info.location() : usn;
+}
+
+int64_t Ssdp::getMaxAge(SsdpInfo &info) {
+  //E. g. "CACHE-CONTROL: max-age = 1800". UPnP requires the header, so default to the recommended minimum if it is missing.
+  std::string cacheControl = info.getField("cache-control");
+  HelperFunctions::toLower(cacheControl);
+  auto position = cacheControl.find("max-age");
+  if (position != std::string::npos) position = cacheControl.find('=', position);
+  if (position == std::string::npos) return 1800;
+  std::string maxAgeString = cacheControl.substr(position + 1);
+  int64_t maxAge = Math::getNumber64(HelperFunctions::trim(maxAgeString));
+  return maxAge > 0 ? maxAge : 1800;
+}
+
+void Ssdp::deviceFound(SsdpInfo &info, const std::shared_ptr<DiscoveryState> &state) {
+  try {
+    {
+      std::lock_guard<std::mutex> queueGuard(state->queueMutex);
+      if (!state->locations.emplace(info.location()).second) return;
     }
 
-    info.emplace(location, currentInfo);
+    std::string cacheKey = getCacheKey(info);
+    std::unique_lock<std::mutex> cacheGuard(_cacheMutex);
+    auto cacheIterator = _cache.find(cacheKey);
+    if (cacheIterator != _cache.end()) {
+      if (cacheIterator->second.expirationTime >= HelperFunctions::getTime() && cacheIterator->second.info.location() == info.location()) {
+        //Every response renews the announcement, so extend the lifetime.
+        cacheIterator->second.expirationTime = HelperFunctions::getTime() + getMaxAge(info) * 1000;
+        SsdpInfo cachedInfo = cacheIterator->second.info;
+        cacheGuard.unlock();
+        std::lock_guard<std::mutex> callbackGuard(state->callbackMutex);
+        state->callback(cachedInfo);
+        return;
+      }
+      _cache.erase(cacheIterator);
+    }
+    cacheGuard.unlock();
+
+    std::lock_guard<std::mutex> queueGuard(state->queueMutex);
+    state->queue.push_back(info);
+    if (state->idleWorkers == 0 && state->workers.size() < _maxConcurrentFetches) {
+      state->workers.emplace_back();
+      //When no thread is available, the description stays queued and is fetched by finishDiscovery(). Fetching it here would block the reactor thread.
+      if (!_bl->threadManager.start(state->workers.back(), false, &Ssdp::fetchWorker, this, state)) state->workers.pop_back();
+    } else state->queueConditionVariable.notify_one();
   }
   catch (const std::exception &ex) {
     _bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
   }
 }
 
-void Ssdp::getDeviceInfo(std::map<std::string, SsdpInfo> &info, std::vector<SsdpInfo> &devices) {
+void Ssdp::finishDiscovery(const std::shared_ptr<DiscoveryState> &state) {
   try {
-    devices.reserve(info.size());
-    for (auto &currentInfo : info) {
-      try {
-        std::string location = currentInfo.second.location();
-        std::string::size_type posSlash = location.find('/');
-        std::string::size_type posPort = location.find_last_of(':');
-        if (posSlash == std::string::npos || posSlash >= posPort || posPort == std::string::npos) return;
-        std::string::size_type posPath = location.find('/', posPort);
-        if (posPath == std::string::npos) posPath = location.size();
-        std::string ip = location.substr(posSlash + 2, posPort - posSlash - 2);
-        std::string portString = location.substr(posPort + 1, posPath - posPort - 1);
-        int32_t port = Math::getNumber(portString, false);
-        if (port <= 0 || port > 65535) return;
-        std::string path = posPath == location.size() ? "/" : location.substr(posPath);
-
-        currentInfo.second.setIp(ip);
-        currentInfo.second.setPort(port);
-        currentInfo.second.setPath(path);
-
-        HttpClient client(_bl, ip, port, false);
-        client.setTimeout(1000);
-        std::string xml;
-        try {
-          client.get(path, xml);
-        }
-        catch (const std::exception &ex) {
-          _bl->out.printDebug("Debug: Could not get additional SSDP information from " + location);
-        }
+    {
+      std::lock_guard<std::mutex> queueGuard(state->queueMutex);
+      state->finished = true;
+    }
+    state->queueConditionVariable.notify_all();
+    //No new workers are started after "finished" is set, so the vector can't change anymore.
+    for (auto &worker : state->workers) {
+      _bl->threadManager.join(worker);
+    }
+    //Fetch descriptions no worker could be started for.
+    while (true) {
+      SsdpInfo info;
+      {
+        std::lock_guard<std::mutex> queueGuard(state->queueMutex);
+        if (state->queue.empty()) break;
+        info = std::move(state->queue.front());
+        state->queue.pop_front();
+      }
+      getDeviceInfo(info);
+      reportDevice(info, state);
+    }
+    pruneCache();
+  }
+  catch (const std::exception &ex) {
+    _bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
 
-        PVariable infoStruct;
-        if (!xml.empty()) {
-          try {
-            xml_document doc;
-            doc.parse<parse_no_entity_translation | parse_validate_closing_tags>(&xml.at(0));
-            xml_node *node = doc.first_node("root");
-            if (node) {
-              node = node->first_node("device");
-              if (node) {
-                infoStruct.reset(new Variable(node));
-                currentInfo.second.setInfo(infoStruct);
-              }
-            }
-          }
-          catch (const std::exception &ex) {
-            _bl->out.printDebug("Debug: Could not parse additional SSDP information from " + location + ": " + ex.what());
-          }
-        }
+void Ssdp::pruneCache() {
+  try {
+    int64_t time = HelperFunctions::getTime();
+    std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+    for (auto cacheIterator = _cache.begin(); cacheIterator != _cache.end();) {
+      if (cacheIterator->second.expirationTime < time) cacheIterator = _cache.erase(cacheIterator);
+      else ++cacheIterator;
+    }
+  }
+  catch (const std::exception &ex) {
+    _bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
 
-        devices.push_back(currentInfo.second);
+void Ssdp::fetchWorker(std::shared_ptr<DiscoveryState> state) {
+  while (true) {
+    try {
+      SsdpInfo info;
+      {
+        std::unique_lock<std::mutex> queueGuard(state->queueMutex);
+        state->idleWorkers++;
+        state->queueConditionVariable.wait(queueGuard, [&] { return !state->queue.empty() || state->finished; });
+        state->idleWorkers--;
+        if (state->queue.empty()) return;
+        info = std::move(state->queue.front());
+        state->queue.pop_front();
+      }
+
+      getDeviceInfo(info);
+      reportDevice(info, state);
+    }
+    catch (const std::exception &ex) {
+      _bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+  }
+}
+
+void Ssdp::getDeviceInfo(SsdpInfo &info) {
+  try {
+    std::string location = info.location();
+    std::string::size_type posSlash = location.find('/');
+    std::string::size_type posPort = location.find_last_of(':');
+    if (posSlash == std::string::npos || posSlash >= posPort || posPort == std::string::npos) return;
+    std::string::size_type posPath = location.find('/', posPort);
+    if (posPath == std::string::npos) posPath = location.size();
+    std::string ip = location.substr(posSlash + 2, posPort - posSlash - 2);
+    std::string portString = location.substr(posPort + 1, posPath - posPort - 1);
+    int32_t port = Math::getNumber(portString, false);
+    if (port <= 0 || port > 65535) return;
+    std::string path = posPath == location.size() ? "/" : location.substr(posPath);
+
+    info.setIp(ip);
+    info.setPort(port);
+    info.setPath(path);
+
+    HttpClient client(_bl, ip, port, false);
+    client.setTimeout(1000);
+    std::string xml;
+    try {
+      client.get(path, xml);
+    }
+    catch (const std::exception &ex) {
+      _bl->out.printDebug("Debug: Could not get additional SSDP information from " + location);
+    }
+
+    if (!xml.empty()) {
+      try {
+        xml_document doc;
+        doc.parse<parse_no_entity_translation | parse_validate_closing_tags>(&xml.at(0));
+        xml_node *node = doc.first_node("root");
+        if (node) {
+          node = node->first_node("device");
+          if (node) info.setInfo(std::make_shared<Variable>(node));
+        }
       }
       catch (const std::exception &ex) {
-        _bl->out.printInfo("Info: Could not get additional SSDP information from " + currentInfo.second.location() + ": " + ex.what());
+        _bl->out.printDebug("Debug: Could not parse additional SSDP information from " + location + ": " + ex.what());
       }
     }
   }
+  catch (const std::exception &ex) {
+    _bl->out.printInfo("Info: Could not get additional SSDP information from " + info.location() + ": " + ex.what());
+  }
+}
+
+void Ssdp::reportDevice(SsdpInfo &info, const std::shared_ptr<DiscoveryState> &state) {
+  try {
+    if (info.ip().empty()) return; //Invalid location
+
+    if (info.info()) {
+      //Only cache complete descriptions, so a device that failed to respond is fetched again next time.
+      std::lock_guard<std::mutex> cacheGuard(_cacheMutex);
+      auto &entry = _cache[getCacheKey(info)];
+      entry.info = info;
+      entry.expirationTime = HelperFunctions::getTime() + getMaxAge(info) * 1000;
+    }
+
+    std::lock_guard<std::mutex> callbackGuard(state->callbackMutex);
+    state->callback(info);
+  }
   catch (const std::exception &ex) {
     _bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
   }
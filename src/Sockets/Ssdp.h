@@ -42,6 +42,11 @@
 #include <set>
 #include <unordered_map>
 #include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
 
 namespace BaseLib {
 
@@ -57,6 +62,7 @@ class SsdpInfo {
   void setIp(std::string value) { _ip = value; }
   int32_t port() { return _port; }
   void setPort(int32_t value) { _port = value; }
+  std::string path() { return _path; }
   void setPath(std::string value) { _path = value; }
   std::string location() { return _location; }
   void setLocation(std::string value) { _location = value; }
@@ -70,7 +76,7 @@ class SsdpInfo {
   std::unordered_map<std::string, std::string> &getFields() { return _fields; };
  private:
   std::string _ip;
-  int32_t _port;
+  int32_t _port = 0;
   std::string _path;
   std::string _location;
   PVariable _info;
@@ -79,9 +85,24 @@ class SsdpInfo {
 
 class Ssdp {
  public:
+  /**
+   * Called once for every found device. Calls are serialized, but might come from different threads.
+   */
+  typedef std::function<void(const SsdpInfo &device)> DeviceCallback;
+
   Ssdp(BaseLib::SharedObjects *baseLib);
   virtual ~Ssdp();
 
+  /**
+   * Sets the maximum number of device descriptions fetched at the same time. The default is 4.
+   */
+  void setMaxConcurrentFetches(uint32_t value) { _maxConcurrentFetches = value == 0 ? 1 : value; }
+
+  /**
+   * Device descriptions are cached by USN until the max-age announced by the device expires. This method removes all cached descriptions.
+   */
+  void clearCache();
+
   /**
    * Searches for SSDP devices and returns the IPv4 addresses.
    *
@@ -91,6 +112,16 @@ class Ssdp {
    */
   void searchDevices(const std::string &stHeader, uint32_t timeout, std::vector<SsdpInfo> &devices);
 
+  /**
+   * Searches for SSDP devices and reports every device as soon as its description is available. Descriptions are fetched concurrently and taken from the
+   * cache when possible.
+   *
+   * @param[in] stHeader The ST header with the URN to search for (e. g. urn:schemas-upnp-org:device:basic:1)
+   * @param[in] timeout The time to wait for responses
+   * @param[in] callback Called for every found device. All calls are finished when this method returns.
+   */
+  void searchDevices(const std::string &stHeader, uint32_t timeout, const DeviceCallback &callback);
+
   /**
    * Searches for SSDP devices by listening for NOTIFY packets and returns the IPv4 addresses.
    *
@@ -100,15 +131,63 @@ class Ssdp {
    * @param[in] abort When set to true during the search, the search is aborted.
    */
   void searchDevicesPassive(const std::string &stHeader, uint32_t timeout, std::vector<SsdpInfo> &devices, std::atomic_bool &abort);
+
+  /**
+   * Searches for SSDP devices by listening for NOTIFY packets and reports every device as soon as its description is available.
+   *
+   * @param[in] stHeader The ST header with the URN to search for (e. g. urn:schemas-upnp-org:device:basic:1)
+   * @param[in] timeout The time to wait for responses
+   * @param[in] callback Called for every found device. All calls are finished when this method returns.
+   * @param[in] abort When set to true during the search, the search is aborted.
+   */
+  void searchDevicesPassive(const std::string &stHeader, uint32_t timeout, const DeviceCallback &callback, std::atomic_bool &abort);
  private:
+  struct CacheEntry {
+    SsdpInfo info;
+    int64_t expirationTime = 0;
+  };
+
+  /**
+   * The state of one search shared with the threads fetching device descriptions.
+   */
+  struct DiscoveryState {
+    DeviceCallback callback;
+    std::mutex callbackMutex;
+    std::set<std::string> locations;
+    std::mutex queueMutex;
+    std::condition_variable queueConditionVariable;
+    std::deque<SsdpInfo> queue;
+    std::vector<std::thread> workers;
+    uint32_t idleWorkers = 0;
+    bool finished = false;
+  };
+
   BaseLib::SharedObjects *_bl = nullptr;
   std::string _address;
+  std::atomic<uint32_t> _maxConcurrentFetches{4};
+  std::mutex _cacheMutex;
+  std::unordered_map<std::string, CacheEntry> _cache;
 
   void getAddress();
   void sendSearchBroadcast(std::shared_ptr<FileDescriptor> &serverSocketDescriptor, const std::string &stHeader, uint32_t timeout);
-  void processPacket(Http &http, const std::string &stHeader, std::map<std::string, SsdpInfo> &info);
-  void processPacketPassive(Http &http, const std::string &stHeader, std::map<std::string, SsdpInfo> &info);
-  void getDeviceInfo(std::map<std::string, SsdpInfo> &info, std::vector<SsdpInfo> &devices);
+  bool processPacket(Http &http, const std::string &stHeader, SsdpInfo &info);
+  bool processPacketPassive(Http &http, const std::string &stHeader, SsdpInfo &info);
+  std::string getCacheKey(SsdpInfo &info);
+  int64_t getMaxAge(SsdpInfo &info);
+
+  /**
+   * Reports the device from the cache or queues fetching its description. Duplicates within one search are ignored.
+   */
+  void deviceFound(SsdpInfo &info, const std::shared_ptr<DiscoveryState> &state);
+  void finishDiscovery(const std::shared_ptr<DiscoveryState> &state);
+
+  /**
+   * Removes expired entries from the cache. Without this, devices that disappear without sending "ssdp:byebye" would never be removed.
+   */
+  void pruneCache();
+  void fetchWorker(std::shared_ptr<DiscoveryState> state);
+  void getDeviceInfo(SsdpInfo &info);
+  void reportDevice(SsdpInfo &info, const std::shared_ptr<DiscoveryState> &state);
   std::shared_ptr<FileDescriptor> getSocketDescriptor(int32_t port, bool bindToMulticast);
 };
 
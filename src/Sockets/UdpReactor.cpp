@@ -0,0 +1,221 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#include "UdpReactor.h"
+#include "../BaseLib.h"
+
+#include <array>
+
+namespace BaseLib {
+
+UdpReactor::UdpReactor() = default;
+
+UdpReactor::~UdpReactor() {
+  stop();
+}
+
+void UdpReactor::init(SharedObjects *baseLib) {
+  _bl = baseLib;
+}
+
+bool UdpReactor::start() {
+  std::lock_guard<std::mutex> threadsGuard(_threadsMutex);
+  if (_stopEventLoop || !_bl) return false;
+  if (!_threads.empty()) return true;
+  if (_epollDescriptor == -1) {
+    _epollDescriptor = epoll_create1(EPOLL_CLOEXEC);
+    if (_epollDescriptor == -1) {
+      _bl->out.printError("Error: Could not create epoll descriptor for UDP reactor: " + std::string(strerror(errno)));
+      return false;
+    }
+  }
+  //The vector must not reallocate after the threads are started.
+  _threads.resize(_threadCount);
+  uint32_t startedThreads = 0;
+  for (auto &thread : _threads) {
+    if (_bl->threadManager.start(thread, true, &UdpReactor::eventLoop, this)) startedThreads++;
+  }
+  if (startedThreads == 0) {
+    //Let add() fail, so callers fall back to their own read loop.
+    _threads.clear();
+    _bl->out.printError("Error: Could not start any thread for UDP reactor.");
+    return false;
+  }
+  return true;
+}
+
+void UdpReactor::stop() {
+  std::lock_guard<std::mutex> threadsGuard(_threadsMutex);
+  _stopEventLoop = true;
+  if (_bl) {
+    for (auto &thread : _threads) {
+      _bl->threadManager.join(thread);
+    }
+  }
+  _threads.clear();
+  {
+    std::lock_guard<std::mutex> registrationsGuard(_registrationsMutex);
+    for (auto &registration : _registrations) {
+      registration.second->descriptor->epoll_descriptor = -1;
+    }
+    _registrations.clear();
+  }
+  if (_epollDescriptor != -1) {
+    close(_epollDescriptor);
+    _epollDescriptor = -1;
+  }
+}
+
+bool UdpReactor::add(const PFileDescriptor &descriptor, ReadableCallback callback) {
+  try {
+    if (!descriptor || descriptor->descriptor == -1 || !callback || !start()) return false;
+
+    auto registration = std::make_shared<Registration>();
+    registration->descriptor = descriptor;
+    registration->callback = std::move(callback);
+
+    //EPOLLONESHOT makes sure only one thread at a time services the socket. The socket is rearmed after the callback returns.
+    std::lock_guard<std::mutex> registrationsGuard(_registrationsMutex);
+    //Drop sockets which were closed without calling remove().
+    for (auto registrationIterator = _registrations.begin(); registrationIterator != _registrations.end();) {
+      if (registrationIterator->second->descriptor->descriptor != registrationIterator->first) registrationIterator = _registrations.erase(registrationIterator);
+      else ++registrationIterator;
+    }
+    int32_t socketDescriptor = descriptor->descriptor;
+    _registrations[socketDescriptor] = registration;
+    struct epoll_event event{};
+    event.events = EPOLLIN | EPOLLONESHOT;
+    event.data.fd = socketDescriptor;
+    if (epoll_ctl(_epollDescriptor, EPOLL_CTL_ADD, socketDescriptor, &event) == -1) {
+      _registrations.erase(socketDescriptor);
+      _bl->out.printError("Error: Could not add socket to UDP reactor: " + std::string(strerror(errno)));
+      return false;
+    }
+    //Makes FileDescriptor remove the socket from the epoll set when it is closed.
+    descriptor->epoll_descriptor = _epollDescriptor;
+    return true;
+  }
+  catch (const std::exception &ex) {
+    _bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  return false;
+}
+
+void UdpReactor::remove(const PFileDescriptor &descriptor) {
+  try {
+    if (!descriptor) return;
+    std::shared_ptr<Registration> registration;
+    {
+      std::lock_guard<std::mutex> registrationsGuard(_registrationsMutex);
+      auto registrationIterator = _registrations.find(descriptor->descriptor);
+      if (registrationIterator == _registrations.end() || registrationIterator->second->descriptor->id != descriptor->id) return;
+      registration = registrationIterator->second;
+      _registrations.erase(registrationIterator);
+      if (_epollDescriptor != -1) epoll_ctl(_epollDescriptor, EPOLL_CTL_DEL, descriptor->descriptor, nullptr);
+      descriptor->epoll_descriptor = -1;
+    }
+
+    //Wait for a running callback to finish. The mutex is recursive, so this also works from within the callback.
+    std::lock_guard<std::recursive_mutex> callbackGuard(registration->callbackMutex);
+    registration->removed = true;
+  }
+  catch (const std::exception &ex) {
+    _bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void UdpReactor::drop(int32_t socketDescriptor, const std::shared_ptr<Registration> &registration) {
+  {
+    std::lock_guard<std::mutex> registrationsGuard(_registrationsMutex);
+    auto registrationIterator = _registrations.find(socketDescriptor);
+    if (registrationIterator != _registrations.end() && registrationIterator->second == registration) _registrations.erase(registrationIterator);
+  }
+  std::lock_guard<std::recursive_mutex> callbackGuard(registration->callbackMutex);
+  registration->removed = true;
+}
+
+void UdpReactor::eventLoop() {
+  std::array<struct epoll_event, 16> events{};
+  while (!_stopEventLoop) {
+    try {
+      int eventCount = epoll_wait(_epollDescriptor, events.data(), events.size(), 100);
+      if (eventCount == -1) {
+        if (errno == EINTR) continue;
+        _bl->out.printError("Error: epoll_wait failed in UDP reactor: " + std::string(strerror(errno)));
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        continue;
+      }
+
+      for (int i = 0; i < eventCount; i++) {
+        std::shared_ptr<Registration> registration;
+        {
+          std::lock_guard<std::mutex> registrationsGuard(_registrationsMutex);
+          auto registrationIterator = _registrations.find(events[i].data.fd);
+          if (registrationIterator == _registrations.end()) continue;
+          registration = registrationIterator->second;
+        }
+
+        if ((events[i].events & EPOLLHUP) || registration->descriptor->descriptor != events[i].data.fd) {
+          drop(events[i].data.fd, registration);
+          continue;
+        }
+
+        {
+          std::lock_guard<std::recursive_mutex> callbackGuard(registration->callbackMutex);
+          if (registration->removed) continue;
+          try {
+            registration->callback(registration->descriptor);
+          }
+          catch (const std::exception &ex) {
+            _bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+          }
+          if (registration->removed) continue;
+        }
+
+        {
+          std::lock_guard<std::mutex> registrationsGuard(_registrationsMutex);
+          auto registrationIterator = _registrations.find(events[i].data.fd);
+          if (registrationIterator == _registrations.end() || registrationIterator->second != registration) continue;
+          struct epoll_event event{};
+          event.events = EPOLLIN | EPOLLONESHOT;
+          event.data.fd = events[i].data.fd;
+          if (epoll_ctl(_epollDescriptor, EPOLL_CTL_MOD, events[i].data.fd, &event) == 0 || (errno != EBADF && errno != ENOENT)) continue;
+        }
+        //The socket was closed without calling remove().
+        drop(events[i].data.fd, registration);
+      }
+    }
+    catch (const std::exception &ex) {
+      _bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+    }
+  }
+}
+
+}
@@ -0,0 +1,119 @@
+/* Copyright 2013-2019 Homegear GmbH
+ *
+ * libhomegear-base is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * libhomegear-base is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with libhomegear-base.  If not, see
+ * <http://www.gnu.org/licenses/>.
+ *
+ * In addition, as a special exception, the copyright holders give
+ * permission to link the code of portions of this program with the
+ * OpenSSL library under certain conditions as described in each
+ * individual source file, and distribute linked combinations
+ * including the two.
+ * You must obey the GNU Lesser General Public License in all respects
+ * for all of the code used other than OpenSSL.  If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so.  If you
+ * do not wish to do so, delete this exception statement from your
+ * version.  If you delete this exception statement from all source
+ * files in the program, then also delete it here.
+*/
+
+#ifndef LIBHOMEGEAR_BASE_UDPREACTOR_H
+#define LIBHOMEGEAR_BASE_UDPREACTOR_H
+
+#include "../Managers/FileDescriptorManager.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace BaseLib {
+
+class SharedObjects;
+
+/**
+ * Event loop for datagram sockets. Instead of running a blocking read loop on an own thread per socket, sockets are registered with a callback which is
+ * called when data is available. One (or a few) threads service all registered sockets of the process. Use the instance in SharedObjects.
+ *
+ * The callback must read the available data without blocking (e. g. using recvfrom() with MSG_DONTWAIT or UdpSocket::proofreadBatch()). A socket is never
+ * serviced by two threads at the same time.
+ */
+class UdpReactor {
+ public:
+  typedef std::function<void(const PFileDescriptor &descriptor)> ReadableCallback;
+
+  UdpReactor();
+  UdpReactor(const UdpReactor &) = delete;
+  UdpReactor &operator=(const UdpReactor &) = delete;
+  virtual ~UdpReactor();
+
+  void init(SharedObjects *baseLib);
+
+  /**
+   * Sets the number of threads servicing the sockets. Only has an effect before the first socket is added.
+   */
+  void setThreadCount(uint32_t value) { _threadCount = value == 0 ? 1 : value; }
+
+  /**
+   * Registers a socket. The threads are started on first use.
+   *
+   * @param descriptor The socket as returned by FileDescriptorManager. The reactor doesn't take ownership. Call remove() before closing the socket.
+   * @param callback Called when the socket is readable.
+   * @return Returns true when the socket was registered.
+   */
+  bool add(const PFileDescriptor &descriptor, ReadableCallback callback);
+
+  /**
+   * Unregisters a socket. When this method returns, the callback is not running and won't be called again. It is safe to call this method from within the
+   * callback.
+   */
+  void remove(const PFileDescriptor &descriptor);
+
+  /**
+   * Stops all threads. Registered sockets are not serviced anymore.
+   */
+  void stop();
+ private:
+  struct Registration {
+    PFileDescriptor descriptor;
+    ReadableCallback callback;
+    std::recursive_mutex callbackMutex;
+    bool removed = false;
+  };
+
+  SharedObjects *_bl = nullptr;
+  uint32_t _threadCount = 1;
+  int _epollDescriptor = -1;
+  std::atomic_bool _stopEventLoop{false};
+  std::mutex _threadsMutex;
+  std::vector<std::thread> _threads;
+  std::mutex _registrationsMutex;
+  std::unordered_map<int32_t, std::shared_ptr<Registration>> _registrations;
+
+  bool start();
+
+  /**
+   * Unregisters a socket which was closed without calling remove().
+   */
+  void drop(int32_t socketDescriptor, const std::shared_ptr<Registration> &registration);
+
+  void eventLoop();
+};
+
+}
+
+#endif
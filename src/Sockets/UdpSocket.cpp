@@ -73,9 +73,31 @@ void UdpSocket::autoConnect() {
   getSocketDescriptor();
 }
 
+void UdpSocket::setReadableCallback(std::function<void()> callback) {
+  std::lock_guard<std::mutex> reactorGuard(_reactorMutex);
+  _readableCallback = std::move(callback);
+}
+
 void UdpSocket::close() {
-  _readMutex.lock();
-  _writeMutex.lock();
+  while (true) {
+    //Must be called before locking the mutexes, as it waits for a running callback, which might be waiting for _readMutex.
+    PFileDescriptor registeredDescriptor;
+    {
+      std::lock_guard<std::mutex> reactorGuard(_reactorMutex);
+      registeredDescriptor = std::move(_registeredDescriptor);
+      _registeredDescriptor.reset();
+    }
+    if (registeredDescriptor) _bl->udpReactor.remove(registeredDescriptor);
+    _readMutex.lock();
+    _writeMutex.lock();
+    {
+      //getSocketDescriptor() might have registered the socket again while the mutexes were not locked.
+      std::lock_guard<std::mutex> reactorGuard(_reactorMutex);
+      if (!_registeredDescriptor) break;
+    }
+    _writeMutex.unlock();
+    _readMutex.unlock();
+  }
   _bl->fileDescriptorManager.close(_socketDescriptor);
   if (_serverInfo) {
     freeaddrinfo(_serverInfo);
@@ -85,10 +107,7 @@ void UdpSocket::close() {
   _readMutex.unlock();
 }
 
-int32_t UdpSocket::proofread(char *buffer, int32_t bufferSize, std::string &senderIp) {
-  senderIp.clear();
-  if (!_socketDescriptor) throw C1Net::Exception("Socket descriptor is nullptr.");
-  std::unique_lock<std::mutex> readGuard(_readMutex);
+void UdpSocket::waitForData(std::unique_lock<std::mutex> &readGuard) {
   if (_autoConnect && !isOpen()) {
     readGuard.unlock();
     autoConnect();
@@ -96,25 +115,31 @@ int32_t UdpSocket::proofread(char *buffer, int32_t bufferSize, std::string &send
     readGuard.lock();
   }
 
-  { //Check if we can read from socket
-    pollfd poll_struct{
-        (int)_socketDescriptor->descriptor,
-        (short)(POLLIN),
-        (short)(0)
-    };
+  //Check if we can read from socket
+  pollfd poll_struct{
+      (int)_socketDescriptor->descriptor,
+      (short)(POLLIN),
+      (short)(0)
+  };
 
-    int32_t poll_result = -1;
-    do {
-      poll_result = poll(&poll_struct, 1, (int)(_readTimeout / 1000));
-    } while (poll_result == -1 && errno == EINTR);
-    if (poll_result == -1 || (poll_struct.revents & (POLLNVAL | POLLERR | POLLHUP)) || _socketDescriptor->descriptor == -1) {
-      readGuard.unlock();
-      close();
-      throw C1Net::ClosedException("Connection to client number " + std::to_string(_socketDescriptor->id) + " closed (2).");
-    } else if (poll_result == 0) {
-      throw C1Net::TimeoutException("Reading from socket timed out (1).");
-    }
+  int32_t poll_result = -1;
+  do {
+    poll_result = poll(&poll_struct, 1, (int)(_readTimeout / 1000));
+  } while (poll_result == -1 && errno == EINTR);
+  if (poll_result == -1 || (poll_struct.revents & (POLLNVAL | POLLERR | POLLHUP)) || _socketDescriptor->descriptor == -1) {
+    readGuard.unlock();
+    close();
+    throw C1Net::ClosedException("Connection to client number " + std::to_string(_socketDescriptor->id) + " closed (2).");
+  } else if (poll_result == 0) {
+    throw C1Net::TimeoutException("Reading from socket timed out (1).");
   }
+}
+
+int32_t UdpSocket::proofread(char *buffer, int32_t bufferSize, std::string &senderIp) {
+  senderIp.clear();
+  if (!_socketDescriptor) throw C1Net::Exception("Socket descriptor is nullptr.");
+  std::unique_lock<std::mutex> readGuard(_readMutex);
+  waitForData(readGuard);
 
   ssize_t bytesRead = -1;
   struct sockaddr clientInfo{};
@@ -139,6 +164,58 @@ int32_t UdpSocket::proofread(char *buffer, int32_t bufferSize, std::string &send
   return bytesRead;
 }
 
+UdpSocket::DatagramBatch::DatagramBatch(size_t maxDatagrams, size_t maxDatagramSize) : _maxDatagramSize(maxDatagramSize) {
+  if (maxDatagrams == 0) maxDatagrams = 1;
+  _buffer.resize(maxDatagrams * maxDatagramSize);
+  _iovecs.resize(maxDatagrams);
+  _addresses.resize(maxDatagrams);
+  _headers.resize(maxDatagrams);
+  for (size_t i = 0; i < maxDatagrams; i++) {
+    _iovecs[i].iov_base = _buffer.data() + i * maxDatagramSize;
+    _iovecs[i].iov_len = maxDatagramSize;
+    _headers[i].msg_hdr.msg_iov = &_iovecs[i];
+    _headers[i].msg_hdr.msg_iovlen = 1;
+    _headers[i].msg_hdr.msg_name = &_addresses[i];
+    _headers[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_storage);
+  }
+}
+
+std::string UdpSocket::DatagramBatch::senderIp(size_t index) const {
+  auto &address = _addresses.at(index);
+  std::array<char, INET6_ADDRSTRLEN + 1> ipStringBuffer{};
+  if (address.ss_family == AF_INET) {
+    inet_ntop(AF_INET, &((const struct sockaddr_in *)&address)->sin_addr, ipStringBuffer.data(), ipStringBuffer.size());
+  } else if (address.ss_family == AF_INET6) {
+    inet_ntop(AF_INET6, &((const struct sockaddr_in6 *)&address)->sin6_addr, ipStringBuffer.data(), ipStringBuffer.size());
+  }
+  ipStringBuffer.back() = 0;
+  return std::string(ipStringBuffer.data());
+}
+
+int32_t UdpSocket::proofreadBatch(DatagramBatch &batch) {
+  batch._count = 0;
+  if (!_socketDescriptor) throw C1Net::Exception("Socket descriptor is nullptr.");
+  std::unique_lock<std::mutex> readGuard(_readMutex);
+  waitForData(readGuard);
+
+  for (auto &header : batch._headers) {
+    header.msg_hdr.msg_namelen = sizeof(struct sockaddr_storage);
+    header.msg_hdr.msg_flags = 0;
+    header.msg_len = 0;
+  }
+
+  int result = -1;
+  do {
+    result = recvmmsg(_socketDescriptor->descriptor, batch._headers.data(), batch._headers.size(), MSG_DONTWAIT, nullptr);
+  } while (result < 0 && errno == EINTR);
+  if (result < 0 && errno == EAGAIN) throw C1Net::TimeoutException("Reading from socket timed out (2).");
+  if (result <= 0) {
+    throw C1Net::ClosedException("Connection to client number " + std::to_string(_socketDescriptor->id) + " closed (3).");
+  }
+  batch._count = result;
+  return result;
+}
+
 int32_t UdpSocket::proofwrite(const std::shared_ptr<std::vector<char>> &data) {
   if (!data || data->empty()) return 0;
   return proofwrite(*data);
@@ -234,6 +311,45 @@ int32_t UdpSocket::proofwrite(const std::string &data) {
   return totalBytesWritten;
 }
 
+int32_t UdpSocket::proofwriteBatch(const std::vector<std::vector<char>> &datagrams) {
+  if (!_socketDescriptor) throw C1Net::Exception("Socket descriptor is nullptr.");
+  std::unique_lock<std::mutex> writeGuard(_writeMutex);
+  if (!isOpen()) {
+    writeGuard.unlock();
+    autoConnect();
+    if (!isOpen()) throw C1Net::ClosedException("Connection to client number " + std::to_string(_socketDescriptor->id) + " closed (8).");
+    writeGuard.lock();
+  }
+  if (datagrams.empty()) return 0;
+
+  if (_sendHeaders.size() < datagrams.size()) {
+    _sendIovecs.resize(datagrams.size());
+    _sendHeaders.resize(datagrams.size());
+  }
+  for (size_t i = 0; i < datagrams.size(); i++) {
+    _sendIovecs[i].iov_base = (void *)datagrams[i].data();
+    _sendIovecs[i].iov_len = datagrams[i].size();
+    _sendHeaders[i] = {};
+    _sendHeaders[i].msg_hdr.msg_iov = &_sendIovecs[i];
+    _sendHeaders[i].msg_hdr.msg_iovlen = 1;
+    _sendHeaders[i].msg_hdr.msg_name = _serverInfo->ai_addr;
+    _sendHeaders[i].msg_hdr.msg_namelen = _serverInfo->ai_addrlen;
+  }
+
+  size_t datagramsSent = 0;
+  while (datagramsSent < datagrams.size()) {
+    int result = sendmmsg(_socketDescriptor->descriptor, _sendHeaders.data() + datagramsSent, datagrams.size() - datagramsSent, 0);
+    if (result <= 0) {
+      if (result == -1 && (errno == EINTR || errno == EAGAIN)) continue;
+      writeGuard.unlock();
+      close();
+      throw C1Net::Exception(strerror(errno));
+    }
+    datagramsSent += result;
+  }
+  return datagramsSent;
+}
+
 bool UdpSocket::isOpen() {
   if (!_serverInfo || !_socketDescriptor || _socketDescriptor->descriptor == -1) return false;
   return true;
@@ -252,6 +368,14 @@ void UdpSocket::getSocketDescriptor() {
       _writeMutex.unlock();
       throw C1Net::Exception("Could not connect to server.");
     }
+    {
+      //Registered while the mutexes are locked, so close() can't close the socket in between.
+      std::lock_guard<std::mutex> reactorGuard(_reactorMutex);
+      if (_readableCallback) {
+        if (_bl->udpReactor.add(_socketDescriptor, std::bind(&UdpSocket::socketReadable, this, std::placeholders::_1))) _registeredDescriptor = _socketDescriptor;
+        else _bl->out.printError("Error: Could not register UDP socket with reactor.");
+      }
+    }
     _writeMutex.unlock();
     _readMutex.unlock();
   }
@@ -260,7 +384,15 @@ void UdpSocket::getSocketDescriptor() {
     _readMutex.unlock();
     throw (ex);
   }
+}
 
+void UdpSocket::socketReadable(const PFileDescriptor &descriptor) {
+  std::function<void()> readableCallback;
+  {
+    std::lock_guard<std::mutex> reactorGuard(_reactorMutex);
+    readableCallback = _readableCallback;
+  }
+  if (readableCallback) readableCallback();
 }
 
 void UdpSocket::getConnection() {
@@ -303,6 +435,16 @@ void UdpSocket::getConnection() {
     throw C1Net::Exception("Could not create UDP socket for server " + _clientIp + " on port " + _port + ": " + strerror(errno));
   }
 
+  if (_reusePort) {
+    int32_t optionValue = 1;
+    if (setsockopt(_socketDescriptor->descriptor, SOL_SOCKET, SO_REUSEPORT, &optionValue, sizeof(optionValue)) == -1) {
+      freeaddrinfo(_serverInfo);
+      _serverInfo = nullptr;
+      _bl->fileDescriptorManager.shutdown(_socketDescriptor);
+      throw C1Net::Exception("Could not set SO_REUSEPORT: " + std::string(strerror(errno)));
+    }
+  }
+
   if (_serverInfo->ai_family == AF_INET) {
     struct sockaddr_in clientInfo{};
     clientInfo.sin_family = _serverInfo->ai_family;
@@ -34,7 +34,11 @@
 #include "../Managers/FileDescriptorManager.h"
 
 #include <netdb.h>
+#include <sys/socket.h>
 #include <cstdint>
+#include <string>
+#include <functional>
+#include <vector>
 
 namespace BaseLib {
 
@@ -42,6 +46,39 @@ class SharedObjects;
 
 class UdpSocket {
  public:
+  /**
+   * Preallocated buffers for proofreadBatch(). Create the object once and reuse it for all calls. The received data is valid until the next call.
+   */
+  class DatagramBatch {
+   public:
+    /**
+     * @param maxDatagrams The maximum number of datagrams received with one system call.
+     * @param maxDatagramSize The size of the buffer of each datagram. Longer datagrams are truncated.
+     */
+    explicit DatagramBatch(size_t maxDatagrams = 32, size_t maxDatagramSize = 2048);
+    DatagramBatch(const DatagramBatch &) = delete;
+    DatagramBatch &operator=(const DatagramBatch &) = delete;
+
+    /**
+     * The number of datagrams received by the last call to proofreadBatch().
+     */
+    size_t count() const { return _count; }
+    size_t capacity() const { return _headers.size(); }
+    const char *data(size_t index) const { return _buffer.data() + index * _maxDatagramSize; }
+    size_t size(size_t index) const { return _headers.at(index).msg_len; }
+    const struct sockaddr_storage &senderAddress(size_t index) const { return _addresses.at(index); }
+    std::string senderIp(size_t index) const;
+   private:
+    friend class UdpSocket;
+
+    size_t _count = 0;
+    size_t _maxDatagramSize = 0;
+    std::vector<char> _buffer;
+    std::vector<struct iovec> _iovecs;
+    std::vector<struct sockaddr_storage> _addresses;
+    std::vector<struct mmsghdr> _headers;
+  };
+
   UdpSocket(BaseLib::SharedObjects *baseLib);
   UdpSocket(BaseLib::SharedObjects *baseLib, std::string listenPort);
   UdpSocket(BaseLib::SharedObjects *baseLib, std::string hostname, std::string port);
@@ -50,6 +87,18 @@ class UdpSocket {
 
   void setReadTimeout(int64_t timeout) { _readTimeout = timeout; }
   void setAutoConnect(bool autoConnect) { _autoConnect = autoConnect; }
+
+  /**
+   * Sets SO_REUSEPORT before binding. This allows multiple sockets, each read by its own thread, to listen on the same port. For unicast traffic the kernel
+   * distributes datagrams between the sockets. Multicast datagrams are delivered to every socket. Must be called before the socket is opened.
+   */
+  void setReusePort(bool reusePort) { _reusePort = reusePort; }
+
+  /**
+   * Lets the shared UdpReactor service the socket instead of a blocking read loop on an own thread. "callback" is called when data is available and should
+   * call proofread() or proofreadBatch() which then return without waiting. Must be called before the socket is opened. Pass nullptr to disable.
+   */
+  void setReadableCallback(std::function<void()> callback);
   void setHostname(std::string hostname) {
     close();
     _hostname = hostname;
@@ -77,6 +126,25 @@ class UdpSocket {
    */
   int32_t proofread(char *buffer, int32_t bufferSize, std::string &senderIp);
 
+  /**
+   * Waits for data like proofread() and then receives all queued datagrams up to the capacity of "batch" with one system call (recvmmsg).
+   *
+   * @param[in,out] batch The preallocated buffers to receive into.
+   * @return Returns the number of datagrams received. Never returns 0 or a negative number.
+   * @throws SocketTimeOutException Thrown on timeout.
+   * @throws SocketClosedException Thrown when socket was closed.
+   * @throws SocketOperationException Thrown when socket is nullptr.
+   */
+  int32_t proofreadBatch(DatagramBatch &batch);
+
+  /**
+   * Sends multiple datagrams to the remote host with as few system calls as possible (sendmmsg).
+   *
+   * @param datagrams The datagrams to send.
+   * @return Returns the number of datagrams sent.
+   */
+  int32_t proofwriteBatch(const std::vector<std::vector<char>> &datagrams);
+
   int32_t proofwrite(const std::shared_ptr<std::vector<char>>& data);
   int32_t proofwrite(const std::vector<char> &data);
   int32_t proofwrite(const std::string &data);
@@ -87,6 +155,17 @@ class UdpSocket {
   BaseLib::SharedObjects *_bl = nullptr;
   int64_t _readTimeout = 15000000;
   bool _autoConnect = true;
+  bool _reusePort = false;
+  /**
+   * Protects _readableCallback and _registeredDescriptor.
+   */
+  std::mutex _reactorMutex;
+  std::function<void()> _readableCallback;
+
+  /**
+   * The descriptor currently registered with the UdpReactor.
+   */
+  std::shared_ptr<FileDescriptor> _registeredDescriptor;
   std::string _hostname;
   std::string _clientIp;
   std::string _port;
@@ -96,9 +175,24 @@ class UdpSocket {
   std::mutex _readMutex;
   std::mutex _writeMutex;
 
+  /**
+   * Reused by proofwriteBatch(). Protected by _writeMutex.
+   */
+  std::vector<struct iovec> _sendIovecs;
+  std::vector<struct mmsghdr> _sendHeaders;
+
   std::shared_ptr<FileDescriptor> _socketDescriptor;
 
   void getSocketDescriptor();
+  void socketReadable(const PFileDescriptor &descriptor);
+
+  /**
+   * Waits until data is available for reading. _readMutex must be locked by readGuard.
+   *
+   * @throws SocketTimeOutException Thrown on timeout.
+   * @throws SocketClosedException Thrown when socket was closed.
+   */
+  void waitForData(std::unique_lock<std::mutex> &readGuard);
   void getConnection();
   void autoConnect();
 };
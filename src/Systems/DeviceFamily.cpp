@@ -101,6 +101,8 @@ void DeviceFamily::dispose() {
 
     _bl->out.printDebug("Debug: Disposing central...");
     if (_central) _central->dispose(false);
+    //Families are disposed before the database is closed. Write the values of this family's peers still waiting in the write-behind queue.
+    _bl->dbWriteBehind.flush();
 
     _physicalInterfaces.reset();
     _settings->dispose();
@@ -343,7 +343,120 @@ void ICentral::homegearShuttingDown() {
 void ICentral::load() {
   try {
     loadVariables();
-    loadPeers();
+    if (_bl->settings.peerLoadThreadCount() != 1 && supportsParallelPeerLoad()) loadPeersParallel();
+    else loadPeers();
+  }
+  catch (const std::exception &ex) {
+    _bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void ICentral::addLoadedPeer(const std::shared_ptr<Peer> &peer) {
+  try {
+    std::lock_guard<std::mutex> peersGuard(_peersMutex);
+    if (peer->getAddress() != 0) _peers[peer->getAddress()] = peer;
+    if (!peer->getSerialNumber().empty()) _peersBySerial[peer->getSerialNumber()] = peer;
+    _peersById[peer->getID()] = peer;
+  }
+  catch (const std::exception &ex) {
+    _bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+}
+
+void ICentral::loadPeer(ParallelPeerLoadInfo *loadInfo, size_t index, const std::shared_ptr<Peer> &peer) {
+  bool loaded = false;
+  try {
+    loaded = peer->load(this);
+  }
+  catch (const std::exception &ex) {
+    _bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+  //Don't keep the rows of peers that didn't use them.
+  peer->clearPreloadedData();
+  std::lock_guard<std::mutex> loadInfoGuard(loadInfo->mutex);
+  loadInfo->loaded[index] = loaded;
+}
+
+void ICentral::loadPeersWorker(ParallelPeerLoadInfo *loadInfo) {
+  while (true) {
+    size_t index = 0;
+    std::shared_ptr<Peer> peer;
+    {
+      std::unique_lock<std::mutex> loadInfoGuard(loadInfo->mutex);
+      loadInfo->conditionVariable.wait(loadInfoGuard, [&] { return loadInfo->nextIndex < loadInfo->peers.size() || loadInfo->finished; });
+      if (loadInfo->nextIndex >= loadInfo->peers.size()) return;
+      index = loadInfo->nextIndex++;
+      peer = loadInfo->peers[index];
+    }
+    //Wakes up the reading thread waiting for a free slot.
+    loadInfo->conditionVariable.notify_all();
+    loadPeer(loadInfo, index, peer);
+  }
+}
+
+void ICentral::loadPeersParallel() {
+  ParallelPeerLoadInfo loadInfo;
+  size_t threadCount = _bl->settings.peerLoadThreadCount();
+  if (threadCount == 0) threadCount = std::thread::hardware_concurrency();
+  if (threadCount == 0) threadCount = 1;
+  std::vector<std::thread> threads(threadCount);
+  size_t startedThreads = 0;
+  try {
+    for (auto &thread : threads) {
+      if (_bl->threadManager.start(thread, true, &ICentral::loadPeersWorker, this, &loadInfo)) startedThreads++;
+    }
+    loadInfo.maxQueued = startedThreads * 4;
+    _bl->out.printInfo("Info: Loading peers using " + std::to_string(startedThreads) + " threads.");
+
+    auto addPeer = [&](const std::map<uint32_t, std::shared_ptr<Database::DataColumn>> &row, std::shared_ptr<Database::DataTable> variables, std::shared_ptr<Database::DataTable> parameters) {
+      auto peer = createPeer(row);
+      if (!peer) return;
+      if (variables || parameters) peer->setPreloadedData(std::move(variables), std::move(parameters));
+      size_t index = 0;
+      {
+        std::unique_lock<std::mutex> loadInfoGuard(loadInfo.mutex);
+        //Limits the number of peers with preloaded data waiting to be loaded.
+        if (startedThreads > 0) loadInfo.conditionVariable.wait(loadInfoGuard, [&] { return loadInfo.peers.size() - loadInfo.nextIndex < loadInfo.maxQueued; });
+        index = loadInfo.peers.size();
+        loadInfo.peers.push_back(peer);
+        loadInfo.loaded.push_back(0);
+        if (startedThreads == 0) loadInfo.nextIndex++;
+      }
+      if (startedThreads > 0) loadInfo.conditionVariable.notify_all();
+      else loadPeer(&loadInfo, index, peer); //No thread could be started. Load the peer on this thread.
+    };
+
+    if (usesPreloadedPeerData()) {
+      _bl->db->getPeerDataBulk(_deviceId, [&](const std::map<uint32_t, std::shared_ptr<Database::DataColumn>> &row, std::shared_ptr<Database::DataTable> &variables, std::shared_ptr<Database::DataTable> &parameters) {
+        addPeer(row, std::move(variables), std::move(parameters));
+      });
+    } else {
+      //The peers query their data themselves.
+      auto rows = _bl->db->getPeers(_deviceId);
+      if (rows) {
+        for (auto &row : *rows) {
+          addPeer(row.second, std::shared_ptr<Database::DataTable>(), std::shared_ptr<Database::DataTable>());
+        }
+      }
+    }
+  }
+  catch (const std::exception &ex) {
+    _bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
+  }
+
+  {
+    std::lock_guard<std::mutex> loadInfoGuard(loadInfo.mutex);
+    loadInfo.finished = true;
+  }
+  loadInfo.conditionVariable.notify_all();
+  for (auto &thread : threads) {
+    _bl->threadManager.join(thread);
+  }
+
+  try {
+    for (size_t i = 0; i < loadInfo.peers.size(); i++) {
+      if (loadInfo.loaded[i]) addLoadedPeer(loadInfo.peers[i]);
+    }
   }
   catch (const std::exception &ex) {
     _bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
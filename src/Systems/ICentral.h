@@ -40,6 +40,8 @@
 #include "IPhysicalInterface.h"
 #include "Peer.h"
 
+#include <condition_variable>
+#include <mutex>
 #include <set>
 
 using namespace BaseLib::DeviceDescription;
@@ -304,6 +306,39 @@ class ICentral : public Peer::IPeerEventSink, public IPhysicalInterface::IPhysic
   virtual void deletePeersFromDatabase();
   virtual void loadVariables() = 0;
   virtual void loadPeers() {}
+
+  /**
+   * Centrals returning "true" here are loaded by "loadPeersParallel()" instead of "loadPeers()" when "peerLoadThreadCount" in main.conf is not 1.
+   * They need to implement "createPeer()" and their "Peer::load()" needs to be safe to call for different peers at the same time.
+   */
+  virtual bool supportsParallelPeerLoad() { return false; }
+
+  /**
+   * Centrals returning "true" here get the variables and parameters of their peers from "IDatabaseController::getPeerDataBulk()" in
+   * "loadPeersParallel()". Their "Peer::load()" needs to read them with "Peer::getVariableRows()" and "Peer::getParameterRows()". Otherwise each peer
+   * queries its data itself like in "loadPeers()".
+   */
+  virtual bool usesPreloadedPeerData() { return false; }
+
+  /**
+   * Creates a peer object from a row of the peers table as returned by "IDatabaseController::getPeers()" without loading it. Used by
+   * "loadPeersParallel()".
+   *
+   * @param row The row of the peers table.
+   * @return Returns the new peer or nullptr to skip the row.
+   */
+  virtual std::shared_ptr<Peer> createPeer(const std::map<uint32_t, std::shared_ptr<Database::DataColumn>> &row) { return std::shared_ptr<Peer>(); }
+
+  /**
+   * Adds a peer loaded by "loadPeersParallel()" to the peer maps. Called in database order from the thread calling "load()".
+   */
+  virtual void addLoadedPeer(const std::shared_ptr<Peer> &peer);
+
+  /**
+   * Reads all peers of this central and calls "Peer::load()" on multiple threads while the rows are still being read. At most a few peers per thread
+   * wait to be loaded, so the preloaded data of all peers is never held in memory at once.
+   */
+  virtual void loadPeersParallel();
   virtual void savePeers(bool full) {}
   virtual void saveVariables() = 0;
   virtual void saveVariable(uint32_t index, int64_t intValue);
@@ -314,6 +349,19 @@ class ICentral : public Peer::IPeerEventSink, public IPhysicalInterface::IPhysic
    * Used for default implementation of getPairingState.
    */
   std::map<int64_t, std::list<PPairingState>> _newPeersDefault;
+
+  struct ParallelPeerLoadInfo {
+    std::mutex mutex;
+    std::condition_variable conditionVariable;
+    std::vector<std::shared_ptr<Peer>> peers;
+    std::vector<uint8_t> loaded;
+    size_t nextIndex = 0;
+    size_t maxQueued = 0;
+    bool finished = false;
+  };
+
+  void loadPeersWorker(ParallelPeerLoadInfo *loadInfo);
+  void loadPeer(ParallelPeerLoadInfo *loadInfo, size_t index, const std::shared_ptr<Peer> &peer);
 };
 
 }
@@ -52,6 +52,7 @@ RpcConfigurationParameter::RpcConfigurationParameter(RpcConfigurationParameter c
   _invert = rhs._invert;
   _scale = rhs._scale;
   _mainRole = rhs._mainRole;
+  clearCachedValues();
 }
 
 RpcConfigurationParameter &RpcConfigurationParameter::operator=(const RpcConfigurationParameter &rhs) {
@@ -69,6 +70,8 @@ RpcConfigurationParameter &RpcConfigurationParameter::operator=(const RpcConfigu
   _invert = rhs._invert;
   _scale = rhs._scale;
   _mainRole = rhs._mainRole;
+  //Values cached for the previous binary data must not be returned anymore.
+  clearCachedValues();
   return *this;
 }
 
@@ -99,6 +102,8 @@ void RpcConfigurationParameter::lock() noexcept {
 }
 
 void RpcConfigurationParameter::unlock() noexcept {
+  //The data might have been modified through the reference
+  _binaryDataVersion++;
   _binaryDataMutex.unlock();
 }
 
@@ -116,9 +121,16 @@ std::vector<uint8_t> &RpcConfigurationParameter::getBinaryDataReference() noexce
   return _binaryData;
 }
 
+std::vector<uint8_t> RpcConfigurationParameter::getBinaryData(uint64_t &version) noexcept {
+  std::lock_guard<std::mutex> dataGuard(_binaryDataMutex);
+  version = _binaryDataVersion;
+  return _binaryData;
+}
+
 void RpcConfigurationParameter::setBinaryData(std::vector<uint8_t> &value) noexcept {
   std::lock_guard<std::mutex> dataGuard(_binaryDataMutex);
   _binaryData = value;
+  _binaryDataVersion++;
 }
 
 std::vector<uint8_t> RpcConfigurationParameter::getPartialBinaryData() noexcept {
@@ -148,8 +160,44 @@ bool RpcConfigurationParameter::equals(std::vector<uint8_t> &value) noexcept {
   return value == _binaryData;
 }
 
+PVariable RpcConfigurationParameter::getCachedValue(uint64_t roleId) noexcept {
+  try {
+    std::lock_guard<std::mutex> valueCacheGuard(_valueCacheMutex);
+    if (_valueCacheVersion != _binaryDataVersion) return PVariable();
+    auto valueIterator = _valueCache.find(roleId);
+    if (valueIterator == _valueCache.end()) return PVariable();
+    //Return a copy as callers are allowed to modify the returned value.
+    return std::make_shared<Variable>(*valueIterator->second);
+  }
+  catch (...) {
+  }
+  return PVariable();
+}
+
+void RpcConfigurationParameter::setCachedValue(uint64_t roleId, uint64_t version, const PVariable &value) noexcept {
+  try {
+    if (!value || value->errorStruct) return;
+    std::lock_guard<std::mutex> valueCacheGuard(_valueCacheMutex);
+    if (version != _binaryDataVersion) return;
+    if (_valueCacheVersion != version) {
+      _valueCache.clear();
+      _valueCacheVersion = version;
+    }
+    _valueCache[roleId] = std::make_shared<Variable>(*value);
+  }
+  catch (...) {
+  }
+}
+
+void RpcConfigurationParameter::clearCachedValues() noexcept {
+  std::lock_guard<std::mutex> valueCacheGuard(_valueCacheMutex);
+  _valueCache.clear();
+  _binaryDataVersion++;
+}
+
 void RpcConfigurationParameter::addRole(const Role &role) {
   std::lock_guard<std::mutex> rolesGuard(_rolesMutex);
+  _binaryDataVersion++; //Invalidate cached values as they depend on the role
   _roles.emplace(role.id, role);
   if (role.invert) _invert = true;
   if (role.scale) _scale = true;
@@ -158,6 +206,7 @@ void RpcConfigurationParameter::addRole(const Role &role) {
 
 void RpcConfigurationParameter::addRole(uint64_t id, RoleDirection direction, bool invert, bool scale, RoleScaleInfo scaleInfo) {
   std::lock_guard<std::mutex> rolesGuard(_rolesMutex);
+  _binaryDataVersion++; //Invalidate cached values as they depend on the role
   auto role = Role(id, direction, invert, scale, scaleInfo);
   _roles.emplace(id, role);
   if (role.level == RoleLevel::role && !_mainRole.scale && !_mainRole.invert) {
@@ -169,6 +218,7 @@ void RpcConfigurationParameter::addRole(uint64_t id, RoleDirection direction, bo
 
 void RpcConfigurationParameter::removeRole(uint64_t id) {
   std::lock_guard<std::mutex> rolesGuard(_rolesMutex);
+  _binaryDataVersion++; //Invalidate cached values as they depend on the role
   _roles.erase(id);
   if (id == _mainRole.id) {
     _mainRole = Role();
@@ -495,6 +545,7 @@ bool Peer::setRoom(int32_t channel, uint64_t roomId) {
 
   std::lock_guard<std::mutex> roomGuard(_roomMutex);
   _rooms[channel] = roomId;
+  _aclDataVersion++;
 
   std::ostringstream rooms;
   for (auto &roomPair : _rooms) {
@@ -546,6 +597,7 @@ bool Peer::setBuildingPart(int32_t channel, uint64_t buildingPartId) {
 
   std::lock_guard<std::mutex> buildingPartGuard(_buildingPartMutex);
   _buildingParts[channel] = buildingPartId;
+  _aclDataVersion++;
 
   std::ostringstream buildingParts;
   for (auto &buildingPartPair : _buildingParts) {
@@ -618,6 +670,7 @@ bool Peer::addCategory(int32_t channel, uint64_t categoryId) {
 
   std::lock_guard<std::mutex> categoriesGuard(_categoriesMutex);
   _categories[channel].emplace(categoryId);
+  _aclDataVersion++;
 
   std::ostringstream categories;
   for (auto &categoryPair : _categories) {
@@ -642,6 +695,7 @@ bool Peer::removeCategory(int32_t channel, uint64_t categoryId) {
 
   channelIterator->second.erase(categoryId);
   if (channelIterator->second.empty()) _categories.erase(channel);
+  _aclDataVersion++;
 
   std::ostringstream categories;
   for (auto &categoryPair : _categories) {
@@ -987,7 +1041,7 @@ void Peer::saveParameter(uint32_t parameterID, std::vector<uint8_t> &value) {
     Database::DataRow data;
     data.push_back(std::make_shared<Database::DataColumn>(value));
     data.push_back(std::make_shared<Database::DataColumn>(parameterID));
-    _bl->db->savePeerParameterAsynchronous(data);
+    _bl->dbWriteBehind.savePeerParameterAsynchronous(parameterID, data);
   }
   catch (const std::exception &ex) {
     _bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -1107,8 +1161,33 @@ void Peer::saveSpecialTypeParameter(uint32_t parameterID,
   }
 }
 
+void Peer::setPreloadedData(std::shared_ptr<Database::DataTable> variables, std::shared_ptr<Database::DataTable> parameters) {
+  _preloadedVariables = std::move(variables);
+  _preloadedParameters = std::move(parameters);
+}
+
+void Peer::clearPreloadedData() {
+  _preloadedVariables.reset();
+  _preloadedParameters.reset();
+}
+
+std::shared_ptr<Database::DataTable> Peer::getVariableRows() {
+  std::shared_ptr<Database::DataTable> rows = std::move(_preloadedVariables);
+  _preloadedVariables.reset();
+  if (!rows) rows = _bl->db->getPeerVariables(_peerID);
+  return rows;
+}
+
+std::shared_ptr<Database::DataTable> Peer::getParameterRows() {
+  std::shared_ptr<Database::DataTable> rows = std::move(_preloadedParameters);
+  _preloadedParameters.reset();
+  if (!rows) rows = _bl->db->getPeerParameters(_peerID);
+  return rows;
+}
+
 void Peer::loadVariables(ICentral *central, std::shared_ptr<Database::DataTable> &rows) {
   try {
+    if (!rows) rows = getVariableRows();
     if (!rows) return;
     for (auto &row : *rows) {
       _variableDatabaseIDs[row.second.at(2)->intValue] = row.second.at(0)->intValue;
@@ -1212,7 +1291,7 @@ void Peer::saveVariable(uint32_t index, int32_t intValue) {
     if (idIsKnown) {
       data.push_back(std::make_shared<Database::DataColumn>(intValue));
       data.push_back(std::make_shared<Database::DataColumn>(_variableDatabaseIDs[index]));
-      _bl->db->savePeerVariableAsynchronous(data);
+      _bl->dbWriteBehind.savePeerVariableAsynchronous(_variableDatabaseIDs[index], data);
     } else {
       if (_peerID == 0) return;
       data.push_back(std::make_shared<Database::DataColumn>(_peerID));
@@ -1236,7 +1315,7 @@ void Peer::saveVariable(uint32_t index, int64_t intValue) {
     if (idIsKnown) {
       data.push_back(std::make_shared<Database::DataColumn>(intValue));
       data.push_back(std::make_shared<Database::DataColumn>(_variableDatabaseIDs[index]));
-      _bl->db->savePeerVariableAsynchronous(data);
+      _bl->dbWriteBehind.savePeerVariableAsynchronous(_variableDatabaseIDs[index], data);
     } else {
       if (_peerID == 0) return;
       data.push_back(std::make_shared<Database::DataColumn>(_peerID));
@@ -1260,7 +1339,7 @@ void Peer::saveVariable(uint32_t index, std::string &stringValue) {
     if (idIsKnown) {
       data.push_back(std::make_shared<Database::DataColumn>(stringValue));
       data.push_back(std::make_shared<Database::DataColumn>(_variableDatabaseIDs[index]));
-      _bl->db->savePeerVariableAsynchronous(data);
+      _bl->dbWriteBehind.savePeerVariableAsynchronous(_variableDatabaseIDs[index], data);
     } else {
       if (_peerID == 0) return;
       data.push_back(std::make_shared<Database::DataColumn>(_peerID));
@@ -1284,7 +1363,7 @@ void Peer::saveVariable(uint32_t index, std::vector<char> &binaryValue) {
     if (idIsKnown) {
       data.push_back(std::make_shared<Database::DataColumn>(binaryValue));
       data.push_back(std::make_shared<Database::DataColumn>(_variableDatabaseIDs[index]));
-      _bl->db->savePeerVariableAsynchronous(data);
+      _bl->dbWriteBehind.savePeerVariableAsynchronous(_variableDatabaseIDs[index], data);
     } else {
       if (_peerID == 0) return;
       data.push_back(std::make_shared<Database::DataColumn>(_peerID));
@@ -1308,7 +1387,7 @@ void Peer::saveVariable(uint32_t index, std::vector<uint8_t> &binaryValue) {
     if (idIsKnown) {
       data.push_back(std::make_shared<Database::DataColumn>(binaryValue));
       data.push_back(std::make_shared<Database::DataColumn>(_variableDatabaseIDs[index]));
-      _bl->db->savePeerVariableAsynchronous(data);
+      _bl->dbWriteBehind.savePeerVariableAsynchronous(_variableDatabaseIDs[index], data);
     } else {
       if (_peerID == 0) return;
       data.push_back(std::make_shared<Database::DataColumn>(_peerID));
@@ -1494,7 +1573,7 @@ void Peer::loadConfig() {
 
     Rpc::RpcDecoder rpcDecoder(_bl, false, false);
     Database::DataRow data;
-    std::shared_ptr<Database::DataTable> rows = _bl->db->getPeerParameters(_peerID);
+    std::shared_ptr<Database::DataTable> rows = getParameterRows();
     std::shared_ptr<ParameterInfo> parameterGroupSelector;
     std::vector<std::shared_ptr<ParameterInfo>> parameters;
     parameters.reserve(rows->size());
@@ -1771,6 +1850,8 @@ void Peer::loadConfig() {
         }
       }
     }
+
+    _aclDataVersion++;
   }
   catch (const std::exception &ex) {
     _bl->out.printEx(__FILE__, __LINE__, __PRETTY_FUNCTION__, ex.what());
@@ -1818,6 +1899,7 @@ bool Peer::setVariableRoom(int32_t channel, std::string &variableName, uint64_t
       return false;
     }
     variableIterator->second.setRoom(roomId);
+    _aclDataVersion++;
 
     Database::DataRow data;
     data.push_back(std::make_shared<Database::DataColumn>(roomId));
@@ -1839,6 +1921,7 @@ void Peer::removeRoomFromVariables(uint64_t roomId) {
         if (!variableIterator.second.rpcParameter || variableIterator.second.databaseId == 0) continue;
         if (variableIterator.second.getRoom() == roomId) {
           variableIterator.second.setRoom(0);
+          _aclDataVersion++;
 
           Database::DataRow data;
           data.push_back(std::make_shared<Database::DataColumn>(roomId));
@@ -1892,6 +1975,7 @@ bool Peer::setVariableBuildingPart(int32_t channel, std::string &variableName, u
       return false;
     }
     variableIterator->second.setBuildingPart(buildingPartId);
+    _aclDataVersion++;
 
     Database::DataRow data;
     data.push_back(std::make_shared<Database::DataColumn>(buildingPartId));
@@ -1913,6 +1997,7 @@ void Peer::removeBuildingPartFromVariables(uint64_t buildingPartId) {
         if (!variableIterator.second.rpcParameter || variableIterator.second.databaseId == 0) continue;
         if (variableIterator.second.getBuildingPart() == buildingPartId) {
           variableIterator.second.setBuildingPart(0);
+          _aclDataVersion++;
 
           Database::DataRow data;
           data.push_back(std::make_shared<Database::DataColumn>(buildingPartId));
@@ -1950,6 +2035,7 @@ bool Peer::addCategoryToVariable(int32_t channel, std::string &variableName, uin
     if (variableIterator == channelIterator->second.end() || !variableIterator->second.rpcParameter || variableIterator->second.databaseId == 0) return false;
 
     variableIterator->second.addCategory(categoryId);
+    _aclDataVersion++;
 
     Database::DataRow data;
     data.push_back(std::make_shared<Database::DataColumn>(variableIterator->second.getCategoryString()));
@@ -1972,6 +2058,7 @@ bool Peer::removeCategoryFromVariable(int32_t channel, std::string &variableName
     if (variableIterator == channelIterator->second.end() || !variableIterator->second.rpcParameter || variableIterator->second.databaseId == 0) return false;
 
     variableIterator->second.removeCategory(categoryId);
+    _aclDataVersion++;
 
     Database::DataRow data;
     data.push_back(std::make_shared<Database::DataColumn>(variableIterator->second.getCategoryString()));
@@ -1992,6 +2079,7 @@ void Peer::removeCategoryFromVariables(uint64_t categoryId) {
       for (auto &variableIterator : channelIterator.second) {
         if (!variableIterator.second.rpcParameter || variableIterator.second.databaseId == 0) continue;
         variableIterator.second.removeCategory(categoryId);
+        _aclDataVersion++;
 
         Database::DataRow data;
         data.push_back(std::make_shared<Database::DataColumn>(variableIterator.second.getCategoryString()));
@@ -2069,6 +2157,7 @@ bool Peer::addRoleToVariable(int32_t channel, std::string &variableName, uint64_
     }
 
     variableIterator->second.addRole(roleId, direction, invert, scale, scaleInfo);
+    _aclDataVersion++;
 
     {
       Database::DataRow data;
@@ -2143,6 +2232,7 @@ bool Peer::removeRoleFromVariable(int32_t channel, std::string &variableName, ui
     //}}}
 
     variableIterator->second.removeRole(roleId);
+    _aclDataVersion++;
 
     Database::DataRow data;
     data.push_back(std::make_shared<Database::DataColumn>(variableIterator->second.getRoleString()));
@@ -2163,6 +2253,7 @@ void Peer::removeRoleFromVariables(uint64_t roleId) {
       for (auto &variableIterator : channelIterator.second) {
         if (!variableIterator.second.rpcParameter || variableIterator.second.databaseId == 0) continue;
         variableIterator.second.removeRole(roleId);
+        _aclDataVersion++;
 
         Database::DataRow data;
         data.push_back(std::make_shared<Database::DataColumn>(variableIterator.second.getRoleString()));
@@ -2371,6 +2462,15 @@ PVariable Peer::getAllConfig(PRpcClientInfo clientInfo) {
   return Variable::createError(-32500, "Unknown application error.");
 }
 
+std::vector<bool> Peer::getVariablesReadAccess(const PRpcClientInfo &clientInfo, const std::shared_ptr<Peer> &me, int32_t channel, const std::unordered_map<std::string, RpcConfigurationParameter> &variables) {
+  std::vector<std::pair<int32_t, const std::string *>> variableNames;
+  variableNames.reserve(variables.size());
+  for (auto &variable : variables) {
+    variableNames.emplace_back(channel, &variable.first);
+  }
+  return clientInfo->acls->checkVariablesReadAccess(me, variableNames);
+}
+
 PVariable Peer::getAllValues(PRpcClientInfo clientInfo, bool returnWriteOnly, bool checkAcls) {
   try {
     if (_disposing) return Variable::createError(-32500, "Peer is disposing.");
@@ -2379,6 +2479,7 @@ PVariable Peer::getAllValues(PRpcClientInfo clientInfo, bool returnWriteOnly, bo
 
     auto central = getCentral();
     if (!central) return Variable::createError(-32500, "Could not get central.");
+    auto me = checkAcls ? central->getPeer(_peerID) : std::shared_ptr<Peer>();
 
     values->structValue->insert(StructElement("FAMILY", std::make_shared<Variable>((uint32_t) getCentral()->deviceFamily())));
     values->structValue->insert(StructElement("ID", std::make_shared<Variable>((uint32_t) _peerID)));
@@ -2431,9 +2532,12 @@ PVariable Peer::getAllValues(PRpcClientInfo clientInfo, bool returnWriteOnly, bo
       auto valuesIterator = valuesCentral.find(i->first);
       if (valuesIterator == valuesCentral.end()) continue;
 
+      std::vector<bool> variablesAccess;
+      if (checkAcls) variablesAccess = getVariablesReadAccess(clientInfo, me, i->first, valuesIterator->second);
+      size_t variableIndex = 0;
       for (auto &parameterIterator : valuesIterator->second) {
         RpcConfigurationParameter &parameter = parameterIterator.second;
-        if (checkAcls && !clientInfo->acls->checkVariableReadAccess(central->getPeer(_peerID), i->first, parameter.rpcParameter->id)) continue;
+        if (checkAcls && !variablesAccess.at(variableIndex++)) continue;
 
         if (!parameter.rpcParameter || parameter.rpcParameter->id.empty() || !parameter.rpcParameter->visible) continue;
         if (parameter.specialType == 0) {
@@ -3216,8 +3320,11 @@ PVariable Peer::getRolesInDevice(PRpcClientInfo clientInfo, bool checkAcls) {
 
     for (auto &channelIterator : valuesCentral) {
       auto variables = std::make_shared<Variable>(VariableType::tStruct);
+      std::vector<bool> variablesAccess;
+      if (checkAcls) variablesAccess = getVariablesReadAccess(clientInfo, me, channelIterator.first, channelIterator.second);
+      size_t variableIndex = 0;
       for (auto &variableIterator : channelIterator.second) {
-        if (checkAcls && !clientInfo->acls->checkVariableReadAccess(me, channelIterator.first, variableIterator.first)) continue;
+        if (checkAcls && !variablesAccess.at(variableIndex++)) continue;
 
         auto roles = variableIterator.second.getRoles();
         if (!roles.empty()) {
@@ -3260,8 +3367,11 @@ PVariable Peer::getRolesInRoom(PRpcClientInfo clientInfo, uint64_t roomId, bool
 
     for (auto &channelIterator : valuesCentral) {
       auto variables = std::make_shared<Variable>(VariableType::tStruct);
+      std::vector<bool> variablesAccess;
+      if (checkAcls) variablesAccess = getVariablesReadAccess(clientInfo, me, channelIterator.first, channelIterator.second);
+      size_t variableIndex = 0;
       for (auto &variableIterator : channelIterator.second) {
-        if (checkAcls && !clientInfo->acls->checkVariableReadAccess(me, channelIterator.first, variableIterator.first)) continue;
+        if (checkAcls && !variablesAccess.at(variableIndex++)) continue;
 
         auto peerRoomId = variableIterator.second.getRoom();
         if (peerRoomId == 0) peerRoomId = getRoom(channelIterator.first);
@@ -3313,10 +3423,13 @@ PVariable Peer::getParamset(PRpcClientInfo clientInfo, int32_t channel, Paramete
     if (type == ParameterGroup::Type::Enum::variables) {
       auto valuesIterator = valuesCentral.find(channel);
       if (valuesIterator == valuesCentral.end()) return variables;
+      std::vector<bool> variablesAccess;
+      if (checkAcls) variablesAccess = getVariablesReadAccess(clientInfo, central->getPeer(_peerID), channel, valuesIterator->second);
+      size_t variableIndex = 0;
       for (auto &parameterIterator : valuesIterator->second) {
         RpcConfigurationParameter &parameter = parameterIterator.second;
+        if (checkAcls && !variablesAccess.at(variableIndex++)) continue;
         if (parameter.rpcParameter->id.empty() || !parameter.rpcParameter->visible) continue;
-        if (checkAcls && !clientInfo->acls->checkVariableReadAccess(central->getPeer(_peerID), channel, parameter.rpcParameter->id)) continue;
         if (parameter.specialType == 0) {
           //Parameter also needs to be in ParamsetDescription, this is not necessarily the case (e. g. for switchable parameter sets)
           auto parameter2 = parameterGroup->getParameter(parameter.rpcParameter->id);
@@ -3435,10 +3548,13 @@ PVariable Peer::getParamsetDescription(PRpcClientInfo clientInfo, int32_t channe
     if (parameterGroup->type() == ParameterGroup::Type::Enum::variables) {
       auto valuesIterator = valuesCentral.find(channel);
       if (valuesIterator == valuesCentral.end()) return descriptions; //Parameter set exists but is empty
+      std::vector<bool> variablesAccess;
+      if (checkAcls) variablesAccess = getVariablesReadAccess(clientInfo, central->getPeer(_peerID), channel, valuesIterator->second);
+      size_t variableIndex = 0;
       for (auto &parameterIterator : valuesIterator->second) {
         RpcConfigurationParameter &parameter = parameterIterator.second;
+        if (checkAcls && !variablesAccess.at(variableIndex++)) continue;
         if (parameter.rpcParameter->id.empty() || !parameter.rpcParameter->visible) continue;
-        if (checkAcls && !clientInfo->acls->checkVariableReadAccess(central->getPeer(_peerID), channel, parameter.rpcParameter->id)) continue;
         if (parameter.specialType == 0) {
           //Parameter also needs to be in ParamsetDescription, this is not necessarily the case (e. g. for switchable parameter sets)
           auto parameter2 = parameterGroup->getParameter(parameter.rpcParameter->id);
@@ -3583,11 +3699,17 @@ PVariable Peer::getValue(PRpcClientInfo clientInfo, uint32_t channel, std::strin
       if (parameter.rpcParameter->password && (!clientInfo || !clientInfo->scriptEngineServer)) variable.reset(new Variable(variable->type));
       if ((!asynchronous && variable->type != VariableType::tVoid) || variable->errorStruct) return variable;
     }
-    std::vector<uint8_t> parameterData = parameterIterator->second.getBinaryData();
-    if (!convertFromPacketHook(parameter, parameterData, variable))
-      variable = parameter.rpcParameter->convertFromPacket(parameterData,
-                                                           clientInfo->addon && clientInfo->peerId == _peerID ? Role() : parameter.mainRole(),
-                                                           false);
+    Role role = clientInfo->addon && clientInfo->peerId == _peerID ? Role() : parameter.mainRole();
+    variable = parameter.getCachedValue(role.id);
+    if (!variable) {
+      uint64_t version = 0;
+      std::vector<uint8_t> parameterData = parameter.getBinaryData(version);
+      //Values converted by the hook are not cached, as they might depend on more than the binary data.
+      if (!convertFromPacketHook(parameter, parameterData, variable)) {
+        variable = parameter.rpcParameter->convertFromPacket(parameterData, role, false);
+        parameter.setCachedValue(role.id, version, variable);
+      }
+    }
     if (parameter.rpcParameter->password && (!clientInfo || !clientInfo->scriptEngineServer)) variable.reset(new Variable(variable->type));
     return variable;
   }
@@ -3928,8 +4050,11 @@ PVariable Peer::getVariablesInCategory(PRpcClientInfo clientInfo, uint64_t categ
     for (auto &channelIterator : valuesCentral) {
       auto variables = std::make_shared<Variable>(VariableType::tArray);
       variables->arrayValue->reserve(channelIterator.second.size());
+      std::vector<bool> variablesAccess;
+      if (checkAcls) variablesAccess = getVariablesReadAccess(clientInfo, me, channelIterator.first, channelIterator.second);
+      size_t variableIndex = 0;
       for (auto &variableIterator : channelIterator.second) {
-        if (checkAcls && !clientInfo->acls->checkVariableReadAccess(me, channelIterator.first, variableIterator.first)) continue;
+        if (checkAcls && !variablesAccess.at(variableIndex++)) continue;
         if (variableIterator.second.hasCategory(categoryId)) variables->arrayValue->push_back(std::make_shared<Variable>(variableIterator.first));
       }
       if (!variables->arrayValue->empty()) channels->structValue->emplace(std::to_string(channelIterator.first), variables);
@@ -3957,8 +4082,11 @@ PVariable Peer::getVariablesInRole(PRpcClientInfo clientInfo, uint64_t roleId, b
 
     for (auto &channelIterator : valuesCentral) {
       auto variables = std::make_shared<Variable>(VariableType::tStruct);
+      std::vector<bool> variablesAccess;
+      if (checkAcls) variablesAccess = getVariablesReadAccess(clientInfo, me, channelIterator.first, channelIterator.second);
+      size_t variableIndex = 0;
       for (auto &variableIterator : channelIterator.second) {
-        if (checkAcls && !clientInfo->acls->checkVariableReadAccess(me, channelIterator.first, variableIterator.first)) continue;
+        if (checkAcls && !variablesAccess.at(variableIndex++)) continue;
         if (variableIterator.second.hasRole(roleId)) {
           auto entry = std::make_shared<BaseLib::Variable>(BaseLib::VariableType::tStruct);
           auto role = variableIterator.second.getRole(roleId);
@@ -3994,8 +4122,11 @@ PVariable Peer::getVariablesInRoom(PRpcClientInfo clientInfo, uint64_t roomId, b
     for (auto &channelIterator : valuesCentral) {
       auto variables = std::make_shared<Variable>(VariableType::tArray);
       variables->arrayValue->reserve(channelIterator.second.size());
+      std::vector<bool> variablesAccess;
+      if (checkAcls) variablesAccess = getVariablesReadAccess(clientInfo, me, channelIterator.first, channelIterator.second);
+      size_t variableIndex = 0;
       for (auto &variableIterator : channelIterator.second) {
-        if (checkAcls && !clientInfo->acls->checkVariableReadAccess(me, channelIterator.first, variableIterator.first)) continue;
+        if (checkAcls && !variablesAccess.at(variableIndex++)) continue;
         if (variableIterator.second.getRoom() == 0) {
           if (returnDeviceAssigned) {
             auto channelRoomId = getRoom(channelIterator.first);
@@ -4030,8 +4161,11 @@ PVariable Peer::getVariablesInBuildingPart(PRpcClientInfo clientInfo, uint64_t b
     for (auto &channelIterator : valuesCentral) {
       auto variables = std::make_shared<Variable>(VariableType::tArray);
       variables->arrayValue->reserve(channelIterator.second.size());
+      std::vector<bool> variablesAccess;
+      if (checkAcls) variablesAccess = getVariablesReadAccess(clientInfo, me, channelIterator.first, channelIterator.second);
+      size_t variableIndex = 0;
       for (auto &variableIterator : channelIterator.second) {
-        if (checkAcls && !clientInfo->acls->checkVariableReadAccess(me, channelIterator.first, variableIterator.first)) continue;
+        if (checkAcls && !variablesAccess.at(variableIndex++)) continue;
         if (variableIterator.second.getBuildingPart() == 0) {
           if (returnDeviceAssigned) {
             auto channelBuildingPartId = getBuildingPart(channelIterator.first);
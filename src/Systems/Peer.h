@@ -104,6 +104,8 @@ class RpcConfigurationParameter {
 
   /**
    * Returns a reference to the data vector. Call "lock()" before executing this method and "unlock()" when you're done working with the reference.
+   * "unlock()" invalidates the cached decoded values. Modifying the vector through the reference without calling "lock()" and "unlock()" leaves a stale
+   * value in the cache until the data changes the next time.
    * @return Returns a reference to the internal binary data vector.
    */
   std::vector<uint8_t> &getBinaryDataReference() noexcept;
@@ -150,6 +152,34 @@ class RpcConfigurationParameter {
    */
   bool equals(std::vector<uint8_t> &value) noexcept;
 
+  /**
+   * Returns a copy of the data vector and the version of the data. The version is incremented every time the binary data or the roles change. This method is thread safe.
+   * @param[out] version The version of the returned data. Pass it to "setCachedValue()" after conversion.
+   * @return Returns a copy of the internal binary data vector.
+   */
+  std::vector<uint8_t> getBinaryData(uint64_t &version) noexcept;
+
+  /**
+   * Returns a copy of the cached decoded value for the passed role. This method is thread safe.
+   * @param roleId The ID of the role the value was converted with or "0" when no role was used.
+   * @return Returns the cached value or nullptr when no value is cached for the current binary data.
+   */
+  PVariable getCachedValue(uint64_t roleId) noexcept;
+
+  /**
+   * Caches the decoded value for the passed role. The value is only stored when "version" still matches the current binary data version, so a value
+   * converted from outdated data is never cached. This method is thread safe.
+   * @param roleId The ID of the role the value was converted with or "0" when no role was used.
+   * @param version The version returned by "getBinaryData(version)" when the data was retrieved.
+   * @param value The decoded value. A copy is stored.
+   */
+  void setCachedValue(uint64_t roleId, uint64_t version, const PVariable &value) noexcept;
+
+  /**
+   * Clears the decoded value cache. This method is thread safe.
+   */
+  void clearCachedValues() noexcept;
+
   bool hasCategory(uint64_t id) {
     std::lock_guard<std::mutex> categoriesGuard(_categoriesMutex);
     return _categories.find(id) != _categories.end();
@@ -224,6 +254,10 @@ class RpcConfigurationParameter {
   std::mutex _binaryDataMutex;
   std::vector<uint8_t> _binaryData;
   std::vector<uint8_t> _partialBinaryData;
+  std::atomic<uint64_t> _binaryDataVersion{0};
+  std::mutex _valueCacheMutex;
+  uint64_t _valueCacheVersion = 0;
+  std::unordered_map<uint64_t, PVariable> _valueCache;
   std::mutex _categoriesMutex;
   std::set<uint64_t> _categories;
   std::mutex _rolesMutex;
@@ -468,6 +502,13 @@ class Peer : public ServiceMessages::IServiceEventSink, public IEvents {
   virtual bool variableHasRole(int32_t channel, const std::string &variableName, uint64_t roleId);
   virtual bool variableHasRoles(int32_t channel, const std::string &variableName);
 
+  /**
+   * Returns a number which changes whenever rooms, building parts, categories or roles of the peer or its variables change. Used to invalidate cached
+   * ACL decisions. Call "aclDataChanged()" after modifying these properties without using the methods of this class.
+   */
+  uint64_t getAclDataVersion() { return _aclDataVersion; }
+  void aclDataChanged() { _aclDataVersion++; }
+
   virtual bool load(ICentral *central) { return false; }
   virtual void save(bool savePeer, bool saveVariables, bool saveCentralConfig);
   virtual void loadConfig();
@@ -497,6 +538,20 @@ class Peer : public ServiceMessages::IServiceEventSink, public IEvents {
   virtual void saveParameter(uint32_t parameterID, uint32_t address, std::vector<uint8_t> &value);
   virtual void saveParameter(uint32_t parameterID, std::vector<uint8_t> &value);
   virtual void loadVariables(ICentral *central, std::shared_ptr<BaseLib::Database::DataTable> &rows);
+
+  /**
+   * Sets variables and parameters read by "IDatabaseController::getPeerDataBulk()". They are returned by the next call of "getVariableRows()" and
+   * "getParameterRows()" instead of querying the database.
+   *
+   * @param variables The peer's variables in the format returned by "IDatabaseController::getPeerVariables()".
+   * @param parameters The peer's parameters in the format returned by "IDatabaseController::getPeerParameters()".
+   */
+  void setPreloadedData(std::shared_ptr<BaseLib::Database::DataTable> variables, std::shared_ptr<BaseLib::Database::DataTable> parameters);
+
+  /**
+   * Releases the data set by "setPreloadedData()" that wasn't used by "load()".
+   */
+  void clearPreloadedData();
   virtual void saveVariables();
   virtual void saveVariable(uint32_t index, int32_t intValue);
   virtual void saveVariable(uint32_t index, int64_t intValue);
@@ -580,6 +635,20 @@ class Peer : public ServiceMessages::IServiceEventSink, public IEvents {
   std::shared_ptr<HomegearDevice> _rpcDevice;
   std::map<uint32_t, uint32_t> _variableDatabaseIDs;
   std::shared_ptr<ICentral> _central;
+  std::shared_ptr<BaseLib::Database::DataTable> _preloadedVariables;
+  std::shared_ptr<BaseLib::Database::DataTable> _preloadedParameters;
+
+  /**
+   * Returns the variables set by "setPreloadedData()" and releases them. Queries the database when there are none. Overrides of "loadVariables()"
+   * should use this instead of "IDatabaseController::getPeerVariables()", so preloaded rows are not read a second time.
+   */
+  std::shared_ptr<BaseLib::Database::DataTable> getVariableRows();
+
+  /**
+   * Returns the parameters set by "setPreloadedData()" and releases them. Queries the database when there are none.
+   */
+  std::shared_ptr<BaseLib::Database::DataTable> getParameterRows();
+  std::atomic<uint64_t> _aclDataVersion{0};
 
   //In table peers:
   uint64_t _peerID = 0;
@@ -704,6 +773,14 @@ class Peer : public ServiceMessages::IServiceEventSink, public IEvents {
    */
   virtual void initializeValueSet(int32_t channel, std::shared_ptr<Variables> valueSet);
 
+  /**
+   * Checks read access of "clientInfo" to all variables of one channel in "valuesCentral" with a single call of
+   * "Acls::checkVariablesReadAccess()".
+   *
+   * @return Returns one element per variable in iteration order of "variables".
+   */
+  std::vector<bool> getVariablesReadAccess(const PRpcClientInfo &clientInfo, const std::shared_ptr<Peer> &me, int32_t channel, const std::unordered_map<std::string, RpcConfigurationParameter> &variables);
+
   /**
    * Initializes _typeString.
    *
@@ -743,7 +820,8 @@ class Peer : public ServiceMessages::IServiceEventSink, public IEvents {
   virtual bool getParamsetHook2(PRpcClientInfo clientInfo, PParameter parameter, uint32_t channel, PVariable parameters) { return false; }
 
   /*
-   * This hook is executed every time "convertFromPacket" is called in case custom conversions are used.
+   * This hook is executed every time "convertFromPacket" is called in case custom conversions are used. getValue() doesn't cache values converted by
+   * this hook, so the result may depend on other state of the peer.
    *
    * @param parameter The current parameter.
    * @param data The data to convert.
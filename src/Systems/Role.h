@@ -40,7 +40,7 @@ struct Role {
     else level = RoleLevel::role;
   }
 
-  uint64_t id;
+  uint64_t id = 0;
   RoleLevel level = RoleLevel::undefined;
   RoleDirection direction = RoleDirection::both;
   bool invert = false;